@@ -5,8 +5,16 @@
  *	Desc		: main function
  */
 
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
 #include "Application.h"
+#include "BatchRenderer.h"
+#include "Benchmark.h"
 #include "Camera.h"
+#include "FramePacer.h"
 #include "Input.h"
 #include "ResourceManager.h"
 #include "GUI.h"
@@ -57,13 +65,103 @@ Object* CreateObject(ResourceManager* r, const std::string& vertex_shader, const
 	return r->CreateObject(modelTag, shaderTag, albedoTag,metallicTag,roughnessTag);
 }
 
-int main(void)
+// Renders a fixed number of frames without a window and prints the frame times
+int RunHeadless(int frame_count)
+{
+	Application application(1200, 900, "Grapigs Engine", true);
+	Application::SetBackgroundColor(255, 255, 255);
+	ResourceManager* resource = new ResourceManager();
+	Lights* lights = CreateLights();
+	resource->SetLights(lights);
+	CreateObject(resource, "shader/test.vert", "shader/test.frag", "model/headphone.fbx", "texture/headphone/GREEN/HEADPHONES_GREEN_DefaultMaterial_BaseColor.png", "texture/headphone/GREEN/HEADPHONES_GREEN_DefaultMaterial_Metallic.png", "texture/headphone/GREEN/HEADPHONES_GREEN_DefaultMaterial_Roughness.png");
+
+	for (int frame = 0; frame < frame_count; ++frame)
+	{
+		application.BeginUpdate();
+		lights->Update();
+		resource->DrawTriangles();
+		application.EndUpdate();
+	}
+
+	const FrameHistogram& frames = FramePacer::GetFrameTimes();
+	std::cout << "Headless: " << frame_count << " frames, average " << frames.Average() << " ms, p50 "
+		<< frames.Percentile(0.5) << " ms, p99 " << frames.Percentile(0.99) << " ms" << std::endl;
+	application.CleanUp();
+	delete lights;
+	delete resource;
+	return 0;
+}
+
+// Renders every view of every job in the manifest and prints the throughput
+int RunBatch(const char* manifest, const char* output)
+{
+	const std::vector<BatchJob> jobs = BatchRenderer::LoadManifest(manifest);
+	if (jobs.empty())
+		return 1;
+	Application application(1024, 1024, "Grapigs Engine", true);
+	Application::SetBackgroundColor(255, 255, 255);
+	ResourceManager* resource = new ResourceManager();
+	Lights* lights = CreateLights();
+	resource->SetLights(lights);
+
+	BatchRenderer renderer(resource, lights);
+	const BatchStats stats = renderer.Run(application, jobs, output);
+	std::cout << "Batch: " << stats.images << " images in " << stats.seconds << " s, " << stats.ImagesPerSecond() << " images/s" << std::endl;
+	application.CleanUp();
+	delete lights;
+	delete resource;
+	return 0;
+}
+
+// Draws the scene along its camera path and writes the frame times of each segment
+int RunBenchmark(const char* scene_path, const char* output, bool is_headless)
 {
+	BenchmarkScene scene;
+	if (Benchmark::LoadScene(scene_path, scene) == false)
+		return 1;
+	Application application(scene.width, scene.height, "Grapigs Engine", is_headless);
+	Application::SetBackgroundColor(255, 255, 255);
+	ResourceManager* resource = new ResourceManager();
+	Lights* lights = scene.lights.empty() ? CreateLights() : new Lights();
+	resource->SetLights(lights);
+
+	Benchmark benchmark(resource, lights);
+	const BenchmarkResult result = benchmark.Run(application, scene);
+	for (const SegmentResult& segment : result.segments)
+		std::cout << "Benchmark: " << segment.name << ", " << segment.frameCount << " frames, CPU p50 " << segment.cpu.p50 << " ms, p99 "
+			<< segment.cpu.p99 << " ms, GPU p50 " << segment.gpu.p50 << " ms, p99 " << segment.gpu.p99 << " ms" << std::endl;
+	std::cout << "Benchmark: total CPU " << result.total.cpu.average << " ms, GPU " << result.total.gpu.average << " ms" << std::endl;
+	const bool is_written = Benchmark::WriteJson(output, std::filesystem::path(scene_path).stem().string(), scene, result);
+	application.CleanUp();
+	delete lights;
+	delete resource;
+	return is_written ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+	// --headless [frames]
+	if (argc > 1 && std::string(argv[1]) == "--headless")
+		return RunHeadless(argc > 2 ? std::max(std::atoi(argv[2]), 1) : 300);
+	// --batch manifest [output folder]
+	if (argc > 2 && std::string(argv[1]) == "--batch")
+		return RunBatch(argv[2], argc > 3 ? argv[3] : "renders");
+	// --benchmark scene [output json] [--headless]
+	if (argc > 2 && std::string(argv[1]) == "--benchmark")
+	{
+		const bool is_headless = std::string(argv[argc - 1]) == "--headless";
+		const char* output = argc > 3 && std::string(argv[3]) != "--headless" ? argv[3] : "benchmark.json";
+		return RunBenchmark(argv[2], output, is_headless);
+	}
+
 	Application application(1200, 900);
 	Application::SetBackgroundColor(255, 255, 255);
+	// The object's textures decode while the resource manager compiles its programs
+	ResourceManager::PrefetchTextures({ "texture/headphone/GREEN/HEADPHONES_GREEN_DefaultMaterial_BaseColor.png", "texture/headphone/GREEN/HEADPHONES_GREEN_DefaultMaterial_Metallic.png", "texture/headphone/GREEN/HEADPHONES_GREEN_DefaultMaterial_Roughness.png" });
 	ResourceManager* resource = new ResourceManager();
 	GUI gui(resource);
 	Lights* lights = CreateLights();
+	resource->SetLights(lights);
 
 	Object* obj = CreateObject(resource, "shader/test.vert", "shader/test.frag", "model/headphone.fbx", "texture/headphone/GREEN/HEADPHONES_GREEN_DefaultMaterial_BaseColor.png", "texture/headphone/GREEN/HEADPHONES_GREEN_DefaultMaterial_Metallic.png", "texture/headphone/GREEN/HEADPHONES_GREEN_DefaultMaterial_Roughness.png");
 
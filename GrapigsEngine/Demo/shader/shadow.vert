@@ -0,0 +1,58 @@
+#version 460 core
+
+layout (location=0) in vec4 vPosition;
+
+layout (std140, binding=0) uniform Transform
+{
+    mat4 worldToCamera;
+    mat4 cameraToNDC;
+    mat4 worldToNDC;
+	vec3 camPosition;
+    float camNear;
+    float camFar;
+} u_trans;
+
+struct Instance
+{
+    mat4 modelToWorld;
+    vec4 color;
+};
+
+layout (std430, binding=2) readonly buffer InstanceBuffer
+{
+    Instance instances[];
+};
+
+layout (std430, binding=3) readonly buffer VisibleBuffer
+{
+    uvec2 visibleIndices[];
+};
+
+struct MeshDraw
+{
+    mat4 localToModel;
+    vec4 albedo;
+    vec4 sphere;
+    float roughness;
+    uint group;
+    uint groupFirst;
+    uint lodCount;
+    vec4 lodErrors;
+    uvec4 meshlets;
+};
+
+layout (std430, binding=4) readonly buffer MeshDrawBuffer
+{
+    MeshDraw meshDraws[];
+};
+
+// Must match the position written by test.vert, the depth prepass is followed by an equal depth test
+invariant gl_Position;
+
+// Depth of the view in the transform block, a light's view or the camera for the depth prepass
+void main()
+{
+    uvec2 visible = visibleIndices[gl_BaseInstance + gl_InstanceID];
+    vec4 pos = instances[visible.x].modelToWorld * meshDraws[visible.y].localToModel * vPosition;
+    gl_Position = u_trans.worldToNDC * pos;
+}
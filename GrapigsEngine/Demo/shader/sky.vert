@@ -0,0 +1,24 @@
+#version 460 core
+
+layout (location=0) out vec3 pos;
+
+layout (std140, binding=0) uniform Transform
+{
+    mat4 worldToCamera;
+    mat4 cameraToNDC;
+    mat4 worldToNDC;
+	vec3 camPosition;
+    float camNear;
+    float camFar;
+} u_trans;
+
+// One triangle covering the screen at the far plane, no vertex buffer is read
+void main()
+{
+    vec2 ndc = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    gl_Position = vec4(ndc, 1.0, 1.0);
+
+    // World direction of the pixel, skybox.frag samples the environment with it
+    vec4 view = inverse(u_trans.cameraToNDC) * vec4(ndc, 1.0, 1.0);
+    pos = transpose(mat3(u_trans.worldToCamera)) * (view.xyz / view.w);
+}
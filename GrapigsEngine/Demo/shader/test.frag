@@ -4,6 +4,9 @@ layout (location=0) in vec3 normal;
 layout (location=1) in vec3 position;
 layout (location=2) in vec2 texcoord;
 layout (location=3) in vec3 localpos;
+layout (location=4) flat in vec4 color;
+layout (location=5) flat in vec4 albedoMetallic;
+layout (location=6) flat in float meshRoughness;
 layout (location=0) out vec4 output_color;
 
 uniform sampler2D t_irradiance;
@@ -12,21 +15,19 @@ uniform sampler2D t_ibl;
 uniform samplerCube t_prefiltermap;
 
 
-uniform vec3 u_albedo;
-uniform float u_metallic;
-uniform float u_roughness;
-
-uniform bool u_has_albedo;
+// Material maps, ShaderProgram::GetVariant defines the macros of the maps a material has
+#ifdef HAS_ALBEDO_MAP
 uniform sampler2D t_albedo;
-
-uniform bool u_has_metallic;
+#endif
+#ifdef HAS_METALLIC_MAP
 uniform sampler2D t_metallic;
-
-uniform bool u_has_roughness;
+#endif
+#ifdef HAS_ROUGHNESS_MAP
 uniform sampler2D t_roughness;
-
-uniform bool u_has_ao;
+#endif
+#ifdef HAS_AO_MAP
 uniform sampler2D t_ao;
+#endif
 
 const float PI = 3.141592654;
 
@@ -43,8 +44,9 @@ layout (std140, binding=0) uniform Transform
 struct Light
 {
 	uint type;    	   
+	int shadow;    // cascades or atlas tile, -1 casts none
 	vec3 direction;    
-	vec3 position;    
+	vec4 position;    // w: range
 	vec3 ambient;      
 	vec3 diffuse;      
 	vec3 specular;     
@@ -57,9 +59,37 @@ struct Light
 layout(std140, binding = 1) uniform LightInformation
 {	
 	uint lightNum;
-	Light lights[16];
 }lightInfo;
 
+layout(std430, binding = 11) readonly buffer LightBuffer
+{
+	Light lights[];
+};
+
+// Lights of each froxel, written by lightcluster.comp
+layout(std430, binding = 12) readonly buffer LightGridBuffer
+{
+	uint lightCounts[];
+};
+
+layout(std430, binding = 13) readonly buffer LightIndexBuffer
+{
+	uint lightIndices[];
+};
+
+const uvec3 GRID = uvec3(16u, 9u, 24u);
+const uint MAX_LIGHTS_PER_CLUSTER = 256u;
+
+uint ClusterIndex()
+{
+	vec4 clip = u_trans.worldToNDC * vec4(position, 1);
+	float depth = -(u_trans.worldToCamera * vec4(position, 1)).z;
+	uvec2 tile = uvec2(clamp((clip.xy / clip.w * 0.5 + 0.5) * vec2(GRID.xy), vec2(0), vec2(GRID.xy) - 1.0));
+	float slice = log(max(depth, u_trans.camNear) / u_trans.camNear) / log(u_trans.camFar / u_trans.camNear) * float(GRID.z);
+	uint z = uint(clamp(slice, 0.0, float(GRID.z) - 1.0));
+	return (z * GRID.y + tile.y) * GRID.x + tile.x;
+}
+
 
 //----------------------------------PBR----------------------------------------//
 const vec2 invAtan = vec2(0.1591, 0.3183);
@@ -100,37 +130,107 @@ vec3 fresnelSchlickRoughness(float NdotV, vec3 F0, float roughness)
 
 
 
+//----------------------------------Shadow----------------------------------------//
+layout(std140, binding = 2) uniform ShadowInformation
+{
+	mat4 cascadeWorldToShadow[4];
+	mat4 spotWorldToShadow[16];
+	vec4 cascadeSplits;
+	vec4 cascadeTexels;
+	vec4 spotTexels[4];
+	ivec4 params;    // x: cascade count, y: filter radius, z: spot shadows
+	vec4 bias;       // x: normal bias in texels
+} shadowInfo;
+
+uniform sampler2DArrayShadow t_cascades;
+uniform sampler2DShadow t_spotShadows;
+
+const int ATLAS_TILES = 4;    // ShadowMaps::s_atlasTiles
+
+float DirectionalShadow(vec3 n)
+{
+	float depth = -(u_trans.worldToCamera * vec4(position, 1)).z;
+	int cascade = 0;
+	while (cascade < shadowInfo.params.x && depth > shadowInfo.cascadeSplits[cascade])
+		++cascade;
+	if (cascade >= shadowInfo.params.x)
+		return 1.0;
+
+	vec3 offset = n * shadowInfo.bias.x * shadowInfo.cascadeTexels[cascade];
+	vec4 coord = shadowInfo.cascadeWorldToShadow[cascade] * vec4(position + offset, 1);
+	vec2 texel = 1.0 / vec2(textureSize(t_cascades, 0).xy);
+	int r = shadowInfo.params.y;
+	float lit = 0.0;
+	for (int y = -r; y <= r; ++y)
+		for (int x = -r; x <= r; ++x)
+			lit += texture(t_cascades, vec4(coord.xy + vec2(x, y) * texel, float(cascade), coord.z));
+	return lit / float((2 * r + 1) * (2 * r + 1));
+}
+
+float SpotShadow(int slot, vec3 n, float distance)
+{
+	vec3 offset = n * shadowInfo.bias.x * shadowInfo.spotTexels[slot / 4][slot % 4] * distance;
+	vec4 coord = shadowInfo.spotWorldToShadow[slot] * vec4(position + offset, 1);
+	if (coord.w <= 0.0)
+		return 1.0;
+	coord.xyz /= coord.w;
+	if (coord.z >= 1.0)
+		return 1.0;
+
+	// Taps stay inside the light's own tile
+	vec2 texel = 1.0 / vec2(textureSize(t_spotShadows, 0));
+	float tile = 1.0 / float(ATLAS_TILES);
+	vec2 tileMin = vec2(slot % ATLAS_TILES, slot / ATLAS_TILES) * tile + texel * 0.5;
+	vec2 tileMax = tileMin + vec2(tile) - texel;
+	int r = shadowInfo.params.y;
+	float lit = 0.0;
+	for (int y = -r; y <= r; ++y)
+		for (int x = -r; x <= r; ++x)
+			lit += texture(t_spotShadows, vec3(clamp(coord.xy + vec2(x, y) * texel, tileMin, tileMax), coord.z));
+	return lit / float((2 * r + 1) * (2 * r + 1));
+}
+
 vec3 CalculateFinalColor()
 {
-	vec3 albedo = u_albedo;
-	if(u_has_albedo)
-		albedo =pow(texture2D(t_albedo, texcoord).xyz, vec3(2.2));
-	float metallic = u_metallic;
-	if(u_has_metallic)
-		metallic = texture2D(t_metallic, texcoord).x;
-	float roughness = u_roughness;
-	if(u_has_roughness)
-		roughness = texture2D(t_roughness, texcoord).x;
+#ifdef HAS_ALBEDO_MAP
+	vec3 albedo = pow(texture(t_albedo, texcoord).xyz, vec3(2.2));
+#else
+	vec3 albedo = albedoMetallic.rgb;
+#endif
+#ifdef HAS_METALLIC_MAP
+	float metallic = texture(t_metallic, texcoord).x;
+#else
+	float metallic = albedoMetallic.a;
+#endif
+#ifdef HAS_ROUGHNESS_MAP
+	float roughness = texture(t_roughness, texcoord).x;
+#else
+	float roughness = meshRoughness;
+#endif
+#ifdef HAS_AO_MAP
+	float ao = texture(t_ao, texcoord).x;
+#else
 	float ao = 1.0f;
-	if(u_has_ao)
-		ao = texture2D(t_ao, texcoord).x;
+#endif
+	albedo *= color.rgb;
 
 	vec3 finalColor = vec3(0);
 	vec3 viewDirection = normalize(u_trans.camPosition - position);
 	vec3 F0 = vec3(0.04);
 	F0 = mix(F0, albedo, metallic);
-	/*
-	for(uint i=0; i < lightInfo.lightNum; i++) 
+	uint cluster = ClusterIndex();
+	uint lightCount = lightCounts[cluster];
+	float NdotV = max(dot(normal, viewDirection), 0.0000001);
+	for(uint i = 0u; i < lightCount; i++) 
 	{	
-		Light light = lightInfo.lights[i];
-		vec3 lightVector = normalize(light.position - position);
+		Light light = lights[lightIndices[cluster * MAX_LIGHTS_PER_CLUSTER + i]];
+		vec3 lightVector = light.type == 1u ? normalize(-light.direction) : normalize(light.position.xyz - position);
 		vec3 halfwayVector = normalize(viewDirection+lightVector);
-		float distance = length(light.position - position);
+		float distance = length(light.position.xyz - position);
 		float attenuation = min(1 / (light.c.x + light.c.y * distance + light.c.z * distance * distance), 1);
-		vec3 radiance = vec3(0);// = light.ambient * attenuation;
+		vec3 radiance = vec3(0);
 
-		float NdotV = max(dot(normal, viewDirection),0.0000001);
-		float NdotL = max(dot(normal, lightVector),0.0000001);
+		float NdotL = max(dot(normal, lightVector), 0.0000001);
 	    float HdotV = max(dot(halfwayVector, viewDirection),0.0);
 		float NdotH = max(dot(normal, halfwayVector),0.0);
 
@@ -138,20 +238,20 @@ vec3 CalculateFinalColor()
 		float G = geometrySmith(NdotV, NdotL, roughness);
 		vec3 F = fresnelSchlick(HdotV, F0);
 		vec3 specular = D * G * F;
-		specular /= 4.0 * max(NdotV, 0.0) * max(NdotL, 0.0) + 0.0001; 
+		specular /= 4.0 * NdotV * NdotL + 0.0001; 
 
 		vec3 kD = vec3(1.0) - F;
 		kD *= 1.0 - metallic;
 
 		switch(light.type)
 		{
-			case 0:
-				radiance = light.ambient * attenuation;
+			case 0u:
+				radiance = light.diffuse * attenuation;
 				break;
-			case 1:
-				radiance = light.ambient;
+			case 1u:
+				radiance = light.diffuse;
 				break;
-			case 2:
+			case 2u:
 			    float spotlighteffect = 0;
 			    float alpha = dot(-lightVector, normalize(light.direction)); 
    				if(alpha < cos(light.outer_angle))
@@ -166,13 +266,20 @@ vec3 CalculateFinalColor()
     			{
     				spotlighteffect = pow((alpha - cos(light.outer_angle)) / (cos(light.inner_angle) - cos(light.outer_angle)), light.falloff);
     			}
-				radiance = light.ambient * attenuation * spotlighteffect;
+				radiance = light.diffuse * attenuation * spotlighteffect;
 				break;
 			default:
+				break;
 		}
 
-	    finalColor += (kD * albedo / PI + specular) * radiance * NdotL;
-	}*/
+		float shadow = 1.0;
+		if (light.shadow >= 0 && light.type == 1u && shadowInfo.params.x > 0)
+			shadow = DirectionalShadow(normal);
+		else if (light.shadow >= 0 && light.type == 2u && shadowInfo.params.z > 0)
+			shadow = SpotShadow(light.shadow, normal, distance);
+
+	    finalColor += (kD * albedo / PI + specular) * radiance * NdotL * shadow;
+	}
  	vec3 kS = fresnelSchlickRoughness(max(dot(normal, viewDirection), 0.0), F0, roughness);
     vec3 kD = 1.0 - kS;
     kD*=1.0-metallic;
@@ -2,13 +2,15 @@
 
 layout (location=0) in vec4 vPosition;
 layout (location=1) in vec4 vNormal;
-layout (location=2) in vec4 fNormal;
 layout (location=3) in vec2 vTexCoord;
 
 layout (location=0) out vec3 normal;
 layout (location=1) out vec3 position;
 layout (location=2) out vec2 texcoord;
 layout (location=3) out vec3 localpos;
+layout (location=4) flat out vec4 color;
+layout (location=5) flat out vec4 albedoMetallic;
+layout (location=6) flat out float meshRoughness;
 
 layout (std140, binding=0) uniform Transform
 {
@@ -20,25 +22,58 @@ layout (std140, binding=0) uniform Transform
     float camFar;
 } u_trans;
 
-uniform mat4 u_modelToWorld;
-uniform mat4 u_localToModel;
+struct Instance
+{
+    mat4 modelToWorld;
+    vec4 color;
+};
+
+layout (std430, binding=2) readonly buffer InstanceBuffer
+{
+    Instance instances[];
+};
+
+// (instance, mesh draw) pairs that passed culling, grouped per mesh
+layout (std430, binding=3) readonly buffer VisibleBuffer
+{
+    uvec2 visibleIndices[];
+};
+
+struct MeshDraw
+{
+    mat4 localToModel;
+    vec4 albedo;
+    vec4 sphere;
+    float roughness;
+    uint group;
+    uint groupFirst;
+    uint lodCount;
+    vec4 lodErrors;
+    uvec4 meshlets;
+};
+
+layout (std430, binding=4) readonly buffer MeshDrawBuffer
+{
+    MeshDraw meshDraws[];
+};
 
-uniform bool u_has_normalmap;
-uniform sampler2D t_normal;
+// Must match the position written by shadow.vert, the depth prepass is followed by an equal depth test
+invariant gl_Position;
 
 void main()
 {
-    if(false)//u_has_normalmap)
-    {   //TODO: normalmapping
-        //normal = normalize(  u_modelToWorld * u_localToModel * ((texture2D(t_normal, vTexCoord))*vec4(2.0)-vec4(1.0)) ).xyz;
-    }
-    else
-    {
-        normal = vec4(normalize(u_modelToWorld * u_localToModel * vNormal)).xyz;
-    }
-    vec4 pos = u_modelToWorld * u_localToModel * vPosition;
+    uvec2 visible = visibleIndices[gl_BaseInstance + gl_InstanceID];
+    Instance instance = instances[visible.x];
+    MeshDraw meshDraw = meshDraws[visible.y];
+    mat4 modelToWorld = instance.modelToWorld;
+    mat4 localToModel = meshDraw.localToModel;
+    color = instance.color;
+    albedoMetallic = meshDraw.albedo;
+    meshRoughness = meshDraw.roughness;
+    normal = vec4(normalize(modelToWorld * localToModel * vNormal)).xyz;
+    vec4 pos = modelToWorld * localToModel * vPosition;
 	position = pos.xyz;
     texcoord = vTexCoord;
-    localpos = vec4(u_localToModel * vPosition).xyz;
+    localpos = vec4(localToModel * vPosition).xyz;
     gl_Position = u_trans.worldToNDC * pos;
 }
\ No newline at end of file
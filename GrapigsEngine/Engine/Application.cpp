@@ -18,7 +18,14 @@
 #include <imgui_impl_opengl3.h>
 
 #include "Camera.h"	// CameraBuffer
+#include "CPUProfiler.h"	// PROFILE_ZONE
+#include "FramePacer.h"	// FramePacer
+#include "GLState.h"	// GLState
+#include "GPUProfiler.h"	// GPUProfiler
 #include "Input.h"	// Input
+#include "Shader.h"	// ShaderProgram
+#include "ShaderWatcher.h"	// ShaderWatcher
+#include "UniformRing.h"	// UniformRing
 
 namespace Callback
 {
@@ -29,7 +36,8 @@ namespace Callback
 	void OpenGLDebug(unsigned source, unsigned type, unsigned id, unsigned severity, int length, const char* message, const void* user_param);
 }
 
-Application::Application(int width, int height, const char* title)
+Application::Application(int width, int height, const char* title, bool is_headless)
+	: m_isHeadless(is_headless)
 {
 	if (width <= 0 || height <= 0)
 		throw std::runtime_error("[Application] Error: Window size should be greater than 0");
@@ -48,29 +56,51 @@ Application::Application(int width, int height, const char* title)
 	glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
 
 	// Create windows
-	GLFWwindow* window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+	GLFWwindow* window = nullptr;
+	if (is_headless)
+	{
+		// The window is never shown, everything is drawn into the scene FBO
+		// EGL and OSMesa contexts work without a display when GLFW is built with its OSMesa backend
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_FOCUSED, GLFW_FALSE);
+		for (const int api : { GLFW_EGL_CONTEXT_API, GLFW_OSMESA_CONTEXT_API, GLFW_NATIVE_CONTEXT_API })
+		{
+			glfwWindowHint(GLFW_CONTEXT_CREATION_API, api);
+			window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+			if (window)
+				break;
+		}
+	}
+	else
+		window = glfwCreateWindow(width, height, title, nullptr, nullptr);
 	if (window == nullptr)
 		throw std::runtime_error("GLFW Error: Unable to create the window");
 	glfwMakeContextCurrent(window);
-	glfwSwapInterval(1); // Enable v-sync
+	// Nothing is presented without a window, frames are only paced by the GPU
+	FramePacer::SetPresentMode(is_headless ? PresentMode::Uncapped : PresentMode::VSync);
 	Input::s_m_windowSize = glm::ivec2(width, height);
 
-	// Init GLEW
-	if (glewInit() == GLEW_OK)
+	// Init GLEW, without GLX the GLX extensions fail to load but the GL functions are there
+	const GLenum glew_result = glewInit();
+	if (glew_result == GLEW_OK || (is_headless && glew_result == GLEW_ERROR_NO_GLX_DISPLAY))
 	{
 		if (GLEW_VERSION_4_6)
 		{
 			std::cout << "Using GLEW version: " << glewGetString(GLEW_VERSION) << std::endl;
-			std::cout << "Driver supports OpenGL 4.6\n\n";
+			std::cout << "Driver supports OpenGL 4.6\n";
+			std::cout << "Renderer: " << glGetString(GL_RENDERER) << "\n\n";
 		}
 		else
 			throw std::runtime_error("[GLEW] Error: Driver does not support OpenGL 4.6");
 
 		glViewport(0, 0, width, height);
-		glEnable(GL_DEPTH_TEST);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLState::SetCapability(GL_DEPTH_TEST, true);
+		GLState::SetCapability(GL_BLEND, true);
+		GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+		// Programs created from here on compile on the driver's threads
+		ShaderProgram::EnableParallelCompile();
+		ShaderWatcher::s_m_isEnabled = is_headless == false;
 		//glEnable(GL_CULL_FACE);
 		//glCullFace(GL_BACK);
 	}
@@ -94,6 +124,13 @@ Application::Application(int width, int height, const char* title)
 	glfwSetMouseButtonCallback(window, [](GLFWwindow* p_win, int b, int a, int m) {Input::MouseButtonCallback(p_win, b, a, m); });
 	glfwSetScrollCallback(window, [](GLFWwindow* p_win, double x, double y) {Input::ScrollCallback(p_win, x, y); });
 
+	CPUProfiler::SetThreadName("Main");
+	CameraBuffer::s_m_aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+	CameraBuffer::SetMainCamera(new Camera());
+	CameraBuffer::GetMainCamera()->Reset();
+	if (is_headless)
+		return;
+
 	// ImGui Init
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
@@ -110,11 +147,6 @@ Application::Application(int width, int height, const char* title)
 	}
 	ImGui_ImplGlfw_InitForOpenGL(glfwGetCurrentContext(), true);
 	ImGui_ImplOpenGL3_Init("#version 460");
-
-	CameraBuffer::s_m_aspectRatio = static_cast<float>(width) / static_cast<float>(height);
-	CameraBuffer::SetMainCamera(new Camera());
-	CameraBuffer::GetMainCamera()->Reset();
-	
 }
 
 
@@ -123,16 +155,29 @@ bool Application::ShouldQuit() const noexcept
 	return glfwWindowShouldClose(static_cast<GLFWwindow*>(m_p_window));
 }
 
+bool Application::IsHeadless() const noexcept
+{
+	return m_isHeadless;
+}
+
 void Application::BeginUpdate() const noexcept
 {
-	// Window
+	PROFILE_FUNCTION();
+	// Window, the pacer may wait so input is polled as late as possible
+	FramePacer::BeginFrame();
 	glfwPollEvents();
+	Input::Update();
+	ShaderWatcher::Update();
+	GPUProfiler::BeginFrame();
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// ImGui
-	ImGui_ImplOpenGL3_NewFrame();
-	ImGui_ImplGlfw_NewFrame();
-	ImGui::NewFrame();
+	if (m_isHeadless == false)
+	{
+		ImGui_ImplOpenGL3_NewFrame();
+		ImGui_ImplGlfw_NewFrame();
+		ImGui::NewFrame();
+	}
 
 	CameraBuffer::UpdateMainCamera();
 	CameraBuffer::Bind();
@@ -140,31 +185,58 @@ void Application::BeginUpdate() const noexcept
 
 void Application::EndUpdate() const noexcept
 {
-	// ImGui
-	ImGui::Render();
-	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-	ImGuiIO& io = ImGui::GetIO();
-	if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
 	{
-		GLFWwindow* backup_current_context = glfwGetCurrentContext();
-		ImGui::UpdatePlatformWindows();
-		ImGui::RenderPlatformWindowsDefault();
-		glfwMakeContextCurrent(backup_current_context);
-	}
+		PROFILE_FUNCTION();
+		// ImGui
+		if (m_isHeadless == false)
+		{
+			GPUProfiler::Begin("ImGui");
+			ImGui::Render();
+			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+			GPUProfiler::End();
+			// The ImGui backend binds behind the state tracker
+			GLState::Invalidate();
+			ImGuiIO& io = ImGui::GetIO();
+			if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+			{
+				GLFWwindow* backup_current_context = glfwGetCurrentContext();
+				ImGui::UpdatePlatformWindows();
+				ImGui::RenderPlatformWindowsDefault();
+				glfwMakeContextCurrent(backup_current_context);
+			}
+		}
 
-	// Window
-	glfwSwapBuffers(static_cast<GLFWwindow*>(m_p_window));
+		// Window, a headless frame has nothing to present and only submits its commands
+		GPUProfiler::EndFrame();
+		if (m_isHeadless)
+			glFlush();
+		else
+		{
+			PROFILE_ZONE("SwapBuffers");
+			glfwSwapBuffers(static_cast<GLFWwindow*>(m_p_window));
+		}
+		FramePacer::EndFrame();
+		UniformRing::EndFrame();
+		GLState::EndFrame();
+	}
+	// Zones still open would be split between two frames
+	CPUProfiler::EndFrame();
 }
 
 void Application::CleanUp() const noexcept
 {
 	// Destroy
+	ShaderWatcher::Clear();
 	CameraBuffer::Clear();
+	GPUProfiler::Clear();
 
 	// ImGui
-	ImGui_ImplOpenGL3_Shutdown();
-	ImGui_ImplGlfw_Shutdown();
-	ImGui::DestroyContext();
+	if (m_isHeadless == false)
+	{
+		ImGui_ImplOpenGL3_Shutdown();
+		ImGui_ImplGlfw_Shutdown();
+		ImGui::DestroyContext();
+	}
 
 	// GLFW
 	glfwDestroyWindow(static_cast<GLFWwindow*>(m_p_window));
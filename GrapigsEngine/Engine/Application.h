@@ -10,8 +10,10 @@ using byte = unsigned char;
 class Application
 {
 public:
-	Application(int width = 1000, int height = 800, const char* title = "Grapigs Engine");
+	// A headless application never shows its window and runs without ImGui
+	Application(int width = 1000, int height = 800, const char* title = "Grapigs Engine", bool is_headless = false);
 	[[nodiscard]] bool ShouldQuit() const noexcept;
+	[[nodiscard]] bool IsHeadless() const noexcept;
 
 	void BeginUpdate() const noexcept;
 	void EndUpdate() const noexcept;
@@ -22,5 +24,6 @@ public:
 	static void SetBackgroundColor(byte red, byte green, byte blue);
 private:
 	void* m_p_window = nullptr;
+	bool m_isHeadless = false;
 };
 
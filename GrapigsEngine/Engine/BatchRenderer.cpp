@@ -0,0 +1,206 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: BatchRenderer.cpp
+ *	Desc		: Turntable renders of models and material sets listed in a manifest
+ */
+#include "BatchRenderer.h"
+
+#include <array>		// std::array
+#include <chrono>		// std::chrono
+#include <cstdio>		// std::snprintf
+#include <fstream>		// std::ifstream
+#include <future>		// std::async
+#include <iostream>		// std::cout
+#include <sstream>		// std::istringstream
+#include <glm/gtc/constants.hpp>	// glm::pi
+
+#include "Application.h"	// Application
+#include "Camera.h"			// CameraBuffer
+#include "CPUProfiler.h"	// PROFILE_ZONE
+#include "FrameReadback.h"	// FrameReadback
+#include "ImageWriter.h"	// ImageWriter
+#include "ResourceManager.h"	// ResourceManager
+
+namespace
+{
+	enum MapType { Albedo, Metallic, Roughness, MapCount };
+
+	// Decoded on worker threads while the previous job renders
+	using DecodedMaterial = std::array<std::future<ImageData>, MapCount>;
+
+	DecodedMaterial DecodeAsync(const MaterialFiles& files, const ResourceManager& resource) noexcept
+	{
+		DecodedMaterial decoded;
+		for (int type = 0; type < MapCount; ++type)
+		{
+			// Textures loaded by an earlier job are reused as they are
+			if (files[type].empty() || resource.GetTexture(files[type]))
+				continue;
+			decoded[type] = std::async(std::launch::async, [path = files[type]] { return Texture::Decode(path); });
+		}
+		return decoded;
+	}
+}
+
+double BatchStats::ImagesPerSecond() const noexcept
+{
+	return seconds > 0.0 ? static_cast<double>(images) / seconds : 0.0;
+}
+
+MaterialFiles BatchRenderer::FindMaterialFiles(const std::filesystem::path& folder) noexcept
+{
+	constexpr const char* keys[MapCount][2] = { { "BaseColor", "Albedo" }, { "Metallic", "Metallic" }, { "Roughness", "Roughness" } };
+	MaterialFiles files;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(folder, error))
+	{
+		const std::string name = entry.path().filename().string();
+		for (int type = 0; type < MapCount; ++type)
+		{
+			if (files[type].empty() && (name.find(keys[type][0]) != std::string::npos || name.find(keys[type][1]) != std::string::npos))
+				files[type] = entry.path();
+		}
+	}
+	if (error)
+		std::cout << "[BatchRenderer]: Cannot read " << folder.string() << std::endl;
+	return files;
+}
+
+std::vector<BatchJob> BatchRenderer::LoadManifest(const std::filesystem::path& path) noexcept
+{
+	std::vector<BatchJob> jobs;
+	std::ifstream file(path);
+	if (file.is_open() == false)
+	{
+		std::cout << "[BatchRenderer]: Cannot open " << path.string() << std::endl;
+		return jobs;
+	}
+	std::string line;
+	for (int number = 1; std::getline(file, line); ++number)
+	{
+		line = line.substr(0, line.find('#'));
+		std::istringstream stream(line);
+		BatchJob job;
+		std::string model, material_set;
+		if (!(stream >> model))
+			continue;
+		if (!(stream >> material_set))
+		{
+			std::cout << "[BatchRenderer]: Line " << number << " has no material set" << std::endl;
+			continue;
+		}
+		job.model = model;
+		job.materialSet = material_set;
+		stream >> job.views >> job.elevation >> job.distance;
+		job.views = std::max(job.views, 1);
+		jobs.push_back(job);
+	}
+	return jobs;
+}
+
+BatchRenderer::BatchRenderer(ResourceManager* p_resource, Lights* p_lights) noexcept
+	: m_p_resource(p_resource), m_p_lights(p_lights)
+{
+	const std::vector<std::pair<ShaderType, std::filesystem::path>> shader_files = {
+		std::make_pair(ShaderType::Vertex, "shader/test.vert"),
+		std::make_pair(ShaderType::Fragment, "shader/test.frag")
+	};
+	m_shader = m_p_resource->LoadShaders(shader_files);
+}
+
+BatchStats BatchRenderer::Run(const Application& application, const std::vector<BatchJob>& jobs, const std::filesystem::path& output) noexcept
+{
+	BatchStats stats;
+	Camera* camera = CameraBuffer::GetMainCamera();
+	if (jobs.empty() || camera == nullptr)
+		return stats;
+
+	const auto start = std::chrono::steady_clock::now();
+	const FrameBufferObject* fbo = ResourceManager::m_fbo;
+	FrameReadback readback;
+	ImageWriter writer;
+	const bool was_grid_visible = m_p_resource->m_isGridVisible;
+	m_p_resource->m_isGridVisible = false;
+
+	// One object is reused by every job, only its model and textures change
+	Object* object = nullptr;
+	MaterialFiles files = FindMaterialFiles(jobs.front().materialSet);
+	DecodedMaterial decoded = DecodeAsync(files, *m_p_resource);
+	for (std::size_t j = 0; j < jobs.size(); ++j)
+	{
+		const BatchJob& job = jobs[j];
+		unsigned tags[MapCount] = { ERROR_INDEX, ERROR_INDEX, ERROR_INDEX };
+		{
+			PROFILE_ZONE("BatchRenderer::Upload");
+			for (int type = 0; type < MapCount; ++type)
+			{
+				if (files[type].empty())
+					continue;
+				if (const Texture* texture = m_p_resource->GetTexture(files[type]))
+					tags[type] = texture->m_tag;
+				else if (decoded[type].valid())
+					tags[type] = m_p_resource->LoadTexture(files[type], decoded[type].get());
+			}
+		}
+		// The next set decodes while this one renders
+		MaterialFiles next_files;
+		DecodedMaterial next_decoded;
+		if (j + 1 < jobs.size())
+		{
+			next_files = FindMaterialFiles(jobs[j + 1].materialSet);
+			next_decoded = DecodeAsync(next_files, *m_p_resource);
+		}
+
+		// Models are loaded once and kept for later jobs
+		const unsigned model_tag = m_p_resource->LoadFbx(job.model.string().c_str());
+		Model* model = m_p_resource->GetModel(model_tag);
+		if (model == nullptr)
+			std::cout << "[BatchRenderer]: Cannot load " << job.model.string() << std::endl;
+		else
+		{
+			if (object == nullptr)
+				object = m_p_resource->CreateObject(model_tag, m_shader);
+			object->m_p_model = model;
+			for (std::size_t i = 1; i < model->m_meshes.size(); ++i)
+			{
+				Material& material = model->m_meshes[i].material;
+				material.t_albedo = material.t_metallic = material.t_roughness = nullptr;
+			}
+			m_p_resource->ApplyTextures(model, tags[Albedo], tags[Metallic], tags[Roughness]);
+
+			const glm::vec4 sphere = model->m_bounds.GetSphere(object->m_transform.GetTransformMatrix());
+			const float radius = std::max(sphere.w, 1e-3f);
+			const float distance = job.distance > 0.f ? job.distance : radius / std::sin(glm::radians(camera->FOV()) * 0.5f) * 1.1f;
+			const float elevation = glm::radians(job.elevation);
+			const std::string prefix = job.model.stem().string() + "_" + job.materialSet.filename().string();
+			for (int view = 0; view < job.views; ++view)
+			{
+				const float yaw = glm::two_pi<float>() * static_cast<float>(view) / static_cast<float>(job.views);
+				const glm::vec3 direction{ std::cos(elevation) * std::sin(yaw), std::sin(elevation), std::cos(elevation) * std::cos(yaw) };
+				const glm::vec3 center{ sphere };
+				// Set faces the camera against its look vector, as Set(eye) does to face the origin
+				camera->Set(center + direction * distance, direction, glm::vec3{ 0, 1, 0 });
+
+				application.BeginUpdate();
+				m_p_lights->Update();
+				m_p_resource->DrawTriangles();
+				char name[32];
+				std::snprintf(name, sizeof(name), "_%03d.png", view);
+				readback.Request(fbo->GetTexture(), fbo->Width(), fbo->Height(), PixelFormat::RGBA8,
+					[&writer, path = output / (prefix + name)](CapturedImage&& image) mutable { writer.Write(std::move(path), std::move(image)); });
+				application.EndUpdate();
+				readback.Poll();
+				++stats.images;
+			}
+		}
+		files = std::move(next_files);
+		decoded = std::move(next_decoded);
+	}
+	readback.Flush();
+	writer.Finish();
+	m_p_resource->m_isGridVisible = was_grid_visible;
+
+	stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return stats;
+}
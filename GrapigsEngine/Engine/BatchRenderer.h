@@ -0,0 +1,54 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: BatchRenderer.h
+ *	Desc		: Turntable renders of models and material sets listed in a manifest
+ */
+#pragma once
+#include <array>		// std::array
+#include <filesystem>	// std::filesystem::path
+#include <vector>		// std::vector
+
+class Application;
+class Lights;
+class ResourceManager;
+
+// One model with one material set, rendered from evenly spaced angles around it
+struct BatchJob
+{
+	std::filesystem::path model;
+	// Folder of images named *BaseColor*, *Metallic* and *Roughness*, like texture/headphone/WOOD
+	std::filesystem::path materialSet;
+	int views = 8;
+	float elevation = 20.f;	// degrees above the horizon
+	float distance = 0.f;	// 0 frames the bounding sphere of the model
+};
+
+// Image paths of a material set in albedo, metallic, roughness order, empty where the set has no such map
+using MaterialFiles = std::array<std::filesystem::path, 3>;
+
+struct BatchStats
+{
+	[[nodiscard]] double ImagesPerSecond() const noexcept;
+
+	std::size_t images = 0;
+	double seconds = 0.0;
+};
+
+class BatchRenderer
+{
+public:
+	// One job per line: model material_set [views] [elevation] [distance], '#' starts a comment
+	[[nodiscard]] static std::vector<BatchJob> LoadManifest(const std::filesystem::path& path) noexcept;
+
+	// Images whose names contain BaseColor or Albedo, Metallic and Roughness
+	[[nodiscard]] static MaterialFiles FindMaterialFiles(const std::filesystem::path& folder) noexcept;
+
+	BatchRenderer(ResourceManager* p_resource, Lights* p_lights) noexcept;
+	// Images are written to output as <model>_<material set>_<view>.png
+	BatchStats Run(const Application& application, const std::vector<BatchJob>& jobs, const std::filesystem::path& output) noexcept;
+private:
+	ResourceManager* m_p_resource;
+	Lights* m_p_lights;
+	unsigned m_shader = 0;
+};
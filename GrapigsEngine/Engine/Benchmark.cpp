@@ -0,0 +1,422 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: Benchmark.cpp
+ *	Desc		: Reproducible frame time measurements of a scene along a camera path
+ */
+#include "Benchmark.h"
+
+#include <algorithm>	// std::sort, std::stable_sort
+#include <chrono>		// std::chrono
+#include <fstream>		// std::ifstream, std::ofstream
+#include <future>		// std::async
+#include <gl/glew.h>	// gl functions
+#include <iostream>		// std::cout
+#include <map>			// std::map
+#include <sstream>		// std::istringstream
+
+#include "Application.h"	// Application
+#include "BatchRenderer.h"	// BatchRenderer::FindMaterialFiles
+#include "CPUProfiler.h"	// PROFILE_ZONE
+#include "FramePacer.h"		// FramePacer
+#include "World.h"			// World, CullingStats
+
+namespace
+{
+	FrameTimeStats Summarize(std::vector<double> samples) noexcept
+	{
+		FrameTimeStats stats;
+		if (samples.empty())
+			return stats;
+		std::sort(samples.begin(), samples.end());
+		const auto percentile = [&samples](double p)
+		{
+			return samples[static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1) + 0.5)];
+		};
+		double sum = 0.0;
+		for (const double sample : samples)
+			sum += sample;
+		stats.average = sum / static_cast<double>(samples.size());
+		stats.p50 = percentile(0.5);
+		stats.p95 = percentile(0.95);
+		stats.p99 = percentile(0.99);
+		stats.min = samples.front();
+		stats.max = samples.back();
+		return stats;
+	}
+
+	SegmentResult Measure(std::string name, std::size_t first, std::size_t last, const std::vector<double>& cpu, const std::vector<double>& gpu, const std::vector<CullingStats>& culling) noexcept
+	{
+		SegmentResult result;
+		result.name = std::move(name);
+		result.firstFrame = static_cast<int>(first);
+		result.frameCount = static_cast<int>(last - first);
+		result.cpu = Summarize({ cpu.begin() + static_cast<std::ptrdiff_t>(first), cpu.begin() + static_cast<std::ptrdiff_t>(last) });
+		result.gpu = Summarize({ gpu.begin() + static_cast<std::ptrdiff_t>(first), gpu.begin() + static_cast<std::ptrdiff_t>(last) });
+		for (std::size_t i = first; i < last; ++i)
+		{
+			result.objectsVisible += static_cast<double>(culling[i].objectsVisible);
+			result.drawCalls += static_cast<double>(culling[i].drawCalls);
+			result.triangles += static_cast<double>(culling[i].triangles);
+		}
+		if (last > first)
+		{
+			const auto count = static_cast<double>(last - first);
+			result.objectsVisible /= count;
+			result.drawCalls /= count;
+			result.triangles /= count;
+		}
+		return result;
+	}
+
+	std::string Escape(const std::string& text) noexcept
+	{
+		std::string escaped;
+		for (const char c : text)
+		{
+			if (c == '"' || c == '\\')
+				escaped += '\\';
+			if (static_cast<unsigned char>(c) >= 0x20)
+				escaped += c;
+		}
+		return escaped;
+	}
+
+	void WriteStats(std::ofstream& file, const char* name, const FrameTimeStats& stats) noexcept
+	{
+		file << "\"" << name << "\": { \"average\": " << stats.average << ", \"p50\": " << stats.p50 << ", \"p95\": " << stats.p95
+			<< ", \"p99\": " << stats.p99 << ", \"min\": " << stats.min << ", \"max\": " << stats.max << " }";
+	}
+
+	void WriteSegment(std::ofstream& file, const SegmentResult& result, const char* indent) noexcept
+	{
+		file << indent << "{\n";
+		file << indent << "\t\"name\": \"" << Escape(result.name) << "\",\n";
+		file << indent << "\t\"first_frame\": " << result.firstFrame << ",\n";
+		file << indent << "\t\"frames\": " << result.frameCount << ",\n";
+		file << indent << "\t";
+		WriteStats(file, "cpu_ms", result.cpu);
+		file << ",\n" << indent << "\t";
+		WriteStats(file, "gpu_ms", result.gpu);
+		file << ",\n";
+		file << indent << "\t\"objects_visible\": " << result.objectsVisible << ",\n";
+		file << indent << "\t\"draw_calls\": " << result.drawCalls << ",\n";
+		file << indent << "\t\"triangles\": " << result.triangles << "\n";
+		file << indent << "}";
+	}
+
+	const char* GetString(GLenum name) noexcept
+	{
+		const auto* string = reinterpret_cast<const char*>(glGetString(name));
+		return string ? string : "";
+	}
+}
+
+bool Benchmark::LoadScene(const std::filesystem::path& path, BenchmarkScene& scene) noexcept
+{
+	std::ifstream file(path);
+	if (file.is_open() == false)
+	{
+		std::cout << "[Benchmark]: Cannot open " << path.string() << std::endl;
+		return false;
+	}
+	scene = BenchmarkScene{};
+	std::string line;
+	for (int number = 1; std::getline(file, line); ++number)
+	{
+		std::istringstream stream(line.substr(0, line.find('#')));
+		std::string entry;
+		if (!(stream >> entry))
+			continue;
+
+		bool is_valid = true;
+		if (entry == "size")
+			is_valid = static_cast<bool>(stream >> scene.width >> scene.height);
+		else if (entry == "frames")
+			is_valid = static_cast<bool>(stream >> scene.frames);
+		else if (entry == "warmup")
+			is_valid = static_cast<bool>(stream >> scene.warmup);
+		else if (entry == "object" || entry == "grid")
+		{
+			BenchmarkObject object;
+			std::string model, material_set;
+			is_valid = static_cast<bool>(stream >> model >> material_set);
+			if (entry == "object")
+				stream >> object.position.x >> object.position.y >> object.position.z >> object.scale;
+			else
+			{
+				is_valid = is_valid && static_cast<bool>(stream >> object.count >> object.spacing);
+				stream >> object.scale;
+			}
+			object.model = model;
+			// '-' keeps the textures of the model
+			if (material_set != "-")
+				object.materialSet = material_set;
+			object.count = std::max(object.count, 1);
+			if (is_valid)
+				scene.objects.push_back(object);
+		}
+		else if (entry == "light")
+		{
+			std::string type;
+			glm::vec3 position{ 0 };
+			is_valid = static_cast<bool>(stream >> type >> position.x >> position.y >> position.z);
+			Light light;
+			if (type == "directional")
+				light.m_type = LightType::DIRECTIONAL;
+			else if (type == "spot")
+				light.m_type = LightType::SPOT;
+			else if (type != "point")
+				is_valid = false;
+			light.m_transform.Translate(position);
+			// Directional and spot lights face the origin
+			if (light.m_type != LightType::POINT && glm::dot(position, position) > 0.f)
+				light.m_direction = -glm::normalize(position);
+			if (is_valid)
+				scene.lights.push_back(light);
+		}
+		else if (entry == "key")
+		{
+			CameraKey key;
+			is_valid = static_cast<bool>(stream >> key.eye.x >> key.eye.y >> key.eye.z >> key.target.x >> key.target.y >> key.target.z);
+			if (is_valid)
+			{
+				scene.path.keys.push_back(key);
+				scene.path.isSpline = true;
+			}
+		}
+		else if (entry == "path")
+		{
+			// Recorded paths are relative to the scene file
+			std::string recorded;
+			is_valid = static_cast<bool>(stream >> recorded) && scene.path.Load(path.parent_path() / recorded);
+			scene.path.isSpline = false;
+		}
+		else if (entry == "segment")
+		{
+			BenchmarkSegment segment;
+			is_valid = static_cast<bool>(stream >> segment.name >> segment.firstFrame);
+			if (is_valid)
+				scene.segments.push_back(segment);
+		}
+		else if (entry == "set")
+		{
+			std::string option;
+			int value = 0;
+			is_valid = static_cast<bool>(stream >> option >> value);
+			if (is_valid)
+				scene.options.emplace_back(option, value != 0);
+		}
+		else
+			is_valid = false;
+
+		if (is_valid == false)
+			std::cout << "[Benchmark]: Line " << number << " of " << path.string() << " is not valid" << std::endl;
+	}
+
+	scene.frames = std::max(scene.frames, 1);
+	scene.warmup = std::max(scene.warmup, 0);
+	std::stable_sort(scene.segments.begin(), scene.segments.end(), [](const BenchmarkSegment& a, const BenchmarkSegment& b) { return a.firstFrame < b.firstFrame; });
+	if (scene.path.keys.empty())
+	{
+		std::cout << "[Benchmark]: " << path.string() << " has no camera path" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool Benchmark::WriteJson(const std::filesystem::path& path, const std::string& scene_name, const BenchmarkScene& scene, const BenchmarkResult& result) noexcept
+{
+	std::ofstream file(path);
+	if (file.is_open() == false)
+	{
+		std::cout << "[Benchmark]: Cannot write " << path.string() << std::endl;
+		return false;
+	}
+	file << "{\n";
+	file << "\t\"scene\": \"" << Escape(scene_name) << "\",\n";
+	file << "\t\"renderer\": \"" << Escape(GetString(GL_RENDERER)) << "\",\n";
+	file << "\t\"version\": \"" << Escape(GetString(GL_VERSION)) << "\",\n";
+	file << "\t\"width\": " << scene.width << ",\n";
+	file << "\t\"height\": " << scene.height << ",\n";
+	file << "\t\"warmup\": " << scene.warmup << ",\n";
+	file << "\t\"frames\": " << scene.frames << ",\n";
+	file << "\t\"options\": {";
+	for (std::size_t i = 0; i < scene.options.size(); ++i)
+		file << (i ? ", " : " ") << "\"" << Escape(scene.options[i].first) << "\": " << (scene.options[i].second ? "true" : "false");
+	file << (scene.options.empty() ? "},\n" : " },\n");
+	file << "\t\"segments\": [\n";
+	for (std::size_t i = 0; i < result.segments.size(); ++i)
+	{
+		WriteSegment(file, result.segments[i], "\t\t");
+		file << (i + 1 < result.segments.size() ? ",\n" : "\n");
+	}
+	file << "\t],\n";
+	file << "\t\"total\":\n";
+	WriteSegment(file, result.total, "\t");
+	file << "\n}\n";
+	return file.good();
+}
+
+Benchmark::Benchmark(ResourceManager* p_resource, Lights* p_lights) noexcept
+	: m_p_resource(p_resource), m_p_lights(p_lights)
+{
+	const std::vector<std::pair<ShaderType, std::filesystem::path>> shader_files = {
+		std::make_pair(ShaderType::Vertex, "shader/test.vert"),
+		std::make_pair(ShaderType::Fragment, "shader/test.frag")
+	};
+	m_shader = m_p_resource->LoadShaders(shader_files);
+}
+
+BenchmarkResult Benchmark::Run(const Application& application, const BenchmarkScene& scene) noexcept
+{
+	BenchmarkResult result;
+	if (CameraBuffer::GetMainCamera() == nullptr || scene.path.keys.empty())
+		return result;
+
+	Build(scene);
+	ApplyOptions(scene);
+	// Input would move the camera off the path, the pacer would hide the frame time behind its waits
+	const bool was_input_enabled = CameraBuffer::s_m_isInputEnabled;
+	const PresentMode present_mode = FramePacer::GetPresentMode();
+	CameraBuffer::s_m_isInputEnabled = false;
+	FramePacer::SetPresentMode(PresentMode::Uncapped);
+
+	// Queries of every frame are read after the run, so measuring never waits for the GPU
+	const auto frame_count = static_cast<std::size_t>(scene.frames);
+	std::vector<GLuint> queries(frame_count * 2);
+	glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(queries.size()), queries.data());
+	std::vector<double> cpu(frame_count, 0.0), gpu(frame_count, 0.0);
+	std::vector<CullingStats> culling(frame_count);
+	const World* world = m_p_resource->GetWorld();
+
+	for (int frame = -scene.warmup; frame < scene.frames; ++frame)
+	{
+		const bool is_measured = frame >= 0;
+		const auto index = static_cast<std::size_t>(std::max(frame, 0));
+		// The warm-up stays at the start of the path
+		const float t = is_measured && scene.frames > 1 ? static_cast<float>(frame) / static_cast<float>(scene.frames - 1) : 0.f;
+		CameraBuffer::SetMainCamera(scene.path.Sample(t));
+
+		const auto begin = std::chrono::steady_clock::now();
+		application.BeginUpdate();
+		if (is_measured)
+			glQueryCounter(queries[index * 2], GL_TIMESTAMP);
+		m_p_lights->Update();
+		m_p_resource->DrawTriangles();
+		if (is_measured)
+			glQueryCounter(queries[index * 2 + 1], GL_TIMESTAMP);
+		application.EndUpdate();
+		if (is_measured)
+		{
+			cpu[index] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+			culling[index] = world->GetCullingStats();
+		}
+	}
+
+	{
+		PROFILE_ZONE("Benchmark::ReadQueries");
+		glFinish();
+		for (std::size_t i = 0; i < frame_count; ++i)
+		{
+			GLuint64 begin = 0, end = 0;
+			glGetQueryObjectui64v(queries[i * 2], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+			gpu[i] = end > begin ? static_cast<double>(end - begin) * 1e-6 : 0.0;
+		}
+		glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+	}
+	CameraBuffer::s_m_isInputEnabled = was_input_enabled;
+	FramePacer::SetPresentMode(present_mode);
+
+	// Frames before the first segment belong to none of them
+	for (std::size_t i = 0; i < scene.segments.size(); ++i)
+	{
+		const auto first = static_cast<std::size_t>(std::clamp(scene.segments[i].firstFrame, 0, scene.frames));
+		const auto last = i + 1 < scene.segments.size() ? static_cast<std::size_t>(std::clamp(scene.segments[i + 1].firstFrame, 0, scene.frames)) : frame_count;
+		if (last > first)
+			result.segments.push_back(Measure(scene.segments[i].name, first, last, cpu, gpu, culling));
+	}
+	result.total = Measure("total", 0, frame_count, cpu, gpu, culling);
+	return result;
+}
+
+void Benchmark::Build(const BenchmarkScene& scene) noexcept
+{
+	PROFILE_FUNCTION();
+	// Every texture of the scene decodes on worker threads while the models load
+	std::vector<MaterialFiles> materials;
+	std::map<std::filesystem::path, std::future<ImageData>> decoding;
+	for (const BenchmarkObject& object : scene.objects)
+	{
+		materials.push_back(object.materialSet.empty() ? MaterialFiles{} : BatchRenderer::FindMaterialFiles(object.materialSet));
+		for (const std::filesystem::path& file : materials.back())
+		{
+			if (file.empty() || m_p_resource->GetTexture(file) || decoding.contains(file))
+				continue;
+			decoding.emplace(file, std::async(std::launch::async, [file] { return Texture::Decode(file); }));
+		}
+	}
+
+	for (std::size_t i = 0; i < scene.objects.size(); ++i)
+	{
+		const BenchmarkObject& object = scene.objects[i];
+		const unsigned model_tag = m_p_resource->LoadFbx(object.model.string().c_str());
+		if (m_p_resource->GetModel(model_tag) == nullptr)
+		{
+			std::cout << "[Benchmark]: Cannot load " << object.model.string() << std::endl;
+			continue;
+		}
+		unsigned tags[3] = { ERROR_INDEX, ERROR_INDEX, ERROR_INDEX };
+		for (std::size_t type = 0; type < materials[i].size(); ++type)
+		{
+			const std::filesystem::path& file = materials[i][type];
+			if (file.empty())
+				continue;
+			if (const Texture* texture = m_p_resource->GetTexture(file))
+				tags[type] = texture->m_tag;
+			else if (auto it = decoding.find(file); it != decoding.end())
+				tags[type] = m_p_resource->LoadTexture(file, it->second.get());
+		}
+
+		// Materials belong to the model, copies of one model share the last material set given to it
+		const float offset = static_cast<float>(object.count - 1) * object.spacing * 0.5f;
+		for (int z = 0; z < object.count; ++z)
+		{
+			for (int x = 0; x < object.count; ++x)
+			{
+				Object* p_object = m_p_resource->CreateObject(model_tag, m_shader, tags[0], tags[1], tags[2]);
+				p_object->m_transform.Translate(object.position + glm::vec3{ static_cast<float>(x) * object.spacing - offset, 0, static_cast<float>(z) * object.spacing - offset });
+				p_object->m_transform.Scale(object.scale);
+			}
+		}
+	}
+	for (const Light& light : scene.lights)
+		m_p_lights->AddLight(light);
+}
+
+void Benchmark::ApplyOptions(const BenchmarkScene& scene) const noexcept
+{
+	World* world = m_p_resource->GetWorld();
+	for (const auto& [option, value] : scene.options)
+	{
+		if (option == "prepass")
+			m_p_resource->m_isDepthPrepass = value;
+		else if (option == "fullscreen_sky")
+			m_p_resource->m_isFullscreenSky = value;
+		else if (option == "grid")
+			m_p_resource->m_isGridVisible = value;
+		else if (option == "culling")
+			world->m_isCulling = value;
+		else if (option == "gpu_culling")
+			world->m_isGPUCulling = value;
+		else if (option == "occlusion_culling")
+			world->m_isOcclusionCulling = value;
+		else if (option == "cluster_culling")
+			world->m_isClusterCulling = value;
+		else if (option == "lod")
+			world->m_isLod = value;
+		else
+			std::cout << "[Benchmark]: Unknown option " << option << std::endl;
+	}
+}
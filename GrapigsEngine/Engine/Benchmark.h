@@ -0,0 +1,100 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: Benchmark.h
+ *	Desc		: Reproducible frame time measurements of a scene along a camera path
+ */
+#pragma once
+#include <filesystem>	// std::filesystem::path
+#include <string>		// std::string
+#include <utility>		// std::pair
+#include <vector>		// std::vector
+
+#include "Camera.h"				// CameraPath
+#include "ResourceManager.h"	// Light
+
+class Application;
+
+// Copies of a model placed on a count x count grid around the position
+struct BenchmarkObject
+{
+	std::filesystem::path model;
+	// Folder of a material set, like texture/headphone/WOOD, empty (- in a scene file) keeps the textures of the model
+	std::filesystem::path materialSet;
+	glm::vec3 position{ 0 };
+	float scale = 1.f;
+	int count = 1;
+	float spacing = 1.f;
+};
+
+// Frames from firstFrame to the first frame of the next segment
+struct BenchmarkSegment
+{
+	std::string name;
+	int firstFrame = 0;
+};
+
+struct BenchmarkScene
+{
+	std::vector<BenchmarkObject> objects;
+	std::vector<Light> lights;
+	CameraPath path;
+	std::vector<BenchmarkSegment> segments;
+	// Renderer switches set before the run, such as prepass or gpu_culling
+	std::vector<std::pair<std::string, bool>> options;
+	int width = 1280, height = 720;
+	// Frames drawn at the start of the path before measuring
+	int warmup = 60;
+	int frames = 600;
+};
+
+// Frame times in milliseconds
+struct FrameTimeStats
+{
+	double average = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, min = 0.0, max = 0.0;
+};
+
+struct SegmentResult
+{
+	std::string name;
+	int firstFrame = 0, frameCount = 0;
+	// From the start of BeginUpdate to the end of EndUpdate
+	FrameTimeStats cpu;
+	// Between timestamps written before and after the frame's draws
+	FrameTimeStats gpu;
+	// Averages of the CPU culling counters
+	double objectsVisible = 0.0, drawCalls = 0.0, triangles = 0.0;
+};
+
+struct BenchmarkResult
+{
+	std::vector<SegmentResult> segments;
+	// Every measured frame
+	SegmentResult total;
+};
+
+// Every frame sees the camera at the same point of the path whatever the frame rate,
+// so two runs of one scene draw the same images and their timings can be compared
+class Benchmark
+{
+public:
+	// One entry per line, '#' starts a comment:
+	//   size width height | frames count | warmup count
+	//   object model material_set [x y z] [scale] | grid model material_set count spacing [scale]
+	//   light point|directional|spot x y z
+	//   key eye.x eye.y eye.z target.x target.y target.z | path recorded_file
+	//   segment name first_frame | set option 0|1
+	[[nodiscard]] static bool LoadScene(const std::filesystem::path& path, BenchmarkScene& scene) noexcept;
+	static bool WriteJson(const std::filesystem::path& path, const std::string& scene_name, const BenchmarkScene& scene, const BenchmarkResult& result) noexcept;
+
+	Benchmark(ResourceManager* p_resource, Lights* p_lights) noexcept;
+	// Loads the scene into the resource manager and draws it along the path
+	BenchmarkResult Run(const Application& application, const BenchmarkScene& scene) noexcept;
+private:
+	void Build(const BenchmarkScene& scene) noexcept;
+	void ApplyOptions(const BenchmarkScene& scene) const noexcept;
+
+	ResourceManager* m_p_resource;
+	Lights* m_p_lights;
+	unsigned m_shader = 0;
+};
@@ -0,0 +1,210 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: CPUProfiler.cpp
+ *	Desc		: Scoped CPU zones recorded per thread without locks
+ */
+#include "CPUProfiler.h"
+
+#include <chrono>		// std::chrono
+#include <fstream>		// std::ofstream
+#include <iostream>		// std::cout
+#include <memory>		// std::unique_ptr
+#include <mutex>		// std::mutex
+
+// Single producer ring, only its thread writes head and only EndFrame writes tail
+struct CPUProfiler::ThreadBuffer
+{
+	CPUZoneEvent events[s_bufferSize];
+	std::atomic<std::uint64_t> head{ 0 }, tail{ 0 };
+	std::atomic<std::size_t> dropped{ 0 };
+	std::atomic<const char*> name{ nullptr };
+	unsigned index = 0;
+};
+
+std::atomic<bool> CPUProfiler::s_m_isEnabled{ true };
+bool CPUProfiler::s_m_isPaused = false;
+CPUFrame CPUProfiler::s_m_lastFrame;
+std::deque<CPUFrame> CPUProfiler::s_m_history;
+std::uint64_t CPUProfiler::s_m_frameBegin = 0;
+
+namespace
+{
+	const auto s_epoch = std::chrono::steady_clock::now();
+	// The lock is only taken when a thread records its first zone and when the rings are drained
+	std::mutex s_mutex;
+	std::vector<std::unique_ptr<CPUProfiler::ThreadBuffer>> s_buffers;
+	thread_local CPUProfiler::ThreadBuffer* t_p_buffer = nullptr;
+	thread_local unsigned t_depth = 0;
+
+	void WriteName(std::ofstream& file, const char* name)
+	{
+		for (const char* p_c = name ? name : "?"; *p_c; ++p_c)
+		{
+			if (*p_c == '"' || *p_c == '\\')
+				file << '\\';
+			file << *p_c;
+		}
+	}
+}
+
+std::uint64_t CPUProfiler::Now() noexcept
+{
+	return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_epoch).count());
+}
+
+CPUProfiler::ThreadBuffer& CPUProfiler::GetThreadBuffer() noexcept
+{
+	if (t_p_buffer)
+		return *t_p_buffer;
+	auto buffer = std::make_unique<ThreadBuffer>();
+	const std::lock_guard lock(s_mutex);
+	buffer->index = static_cast<unsigned>(s_buffers.size());
+	t_p_buffer = buffer.get();
+	s_buffers.push_back(std::move(buffer));
+	return *t_p_buffer;
+}
+
+void CPUProfiler::Record(const char* name, std::uint64_t begin, std::uint64_t end, unsigned depth) noexcept
+{
+	ThreadBuffer& buffer = GetThreadBuffer();
+	const std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+	if (head - buffer.tail.load(std::memory_order_acquire) >= s_bufferSize)
+	{
+		buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	CPUZoneEvent& event = buffer.events[head % s_bufferSize];
+	event.name = name;
+	event.begin = begin;
+	event.end = end;
+	event.depth = depth;
+	event.thread = buffer.index;
+	buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void CPUProfiler::SetThreadName(const char* name) noexcept
+{
+	GetThreadBuffer().name.store(name, std::memory_order_relaxed);
+}
+
+void CPUProfiler::EndFrame() noexcept
+{
+	CPUFrame frame;
+	frame.begin = s_m_frameBegin;
+	frame.end = s_m_frameBegin = Now();
+	{
+		const std::lock_guard lock(s_mutex);
+		for (const auto& buffer : s_buffers)
+		{
+			const std::uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+			const std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+			for (std::uint64_t i = tail; i < head; ++i)
+				frame.zones.push_back(buffer->events[i % s_bufferSize]);
+			buffer->tail.store(head, std::memory_order_release);
+		}
+	}
+	if (s_m_isPaused || frame.begin == 0)
+		return;
+	s_m_lastFrame = frame;
+	s_m_history.push_back(std::move(frame));
+	if (s_m_history.size() > s_historySize)
+		s_m_history.pop_front();
+}
+
+void CPUProfiler::Clear() noexcept
+{
+	// Buffers stay registered, threads keep a pointer to theirs
+	const std::lock_guard lock(s_mutex);
+	for (const auto& buffer : s_buffers)
+	{
+		buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+		buffer->dropped.store(0, std::memory_order_relaxed);
+	}
+	s_m_lastFrame = CPUFrame{};
+	s_m_history.clear();
+}
+
+const CPUFrame& CPUProfiler::GetLastFrame() noexcept
+{
+	return s_m_lastFrame;
+}
+
+const std::deque<CPUFrame>& CPUProfiler::GetHistory() noexcept
+{
+	return s_m_history;
+}
+
+std::vector<const char*> CPUProfiler::GetThreadNames() noexcept
+{
+	const std::lock_guard lock(s_mutex);
+	std::vector<const char*> names;
+	names.reserve(s_buffers.size());
+	for (const auto& buffer : s_buffers)
+		names.push_back(buffer->name.load(std::memory_order_relaxed));
+	return names;
+}
+
+std::size_t CPUProfiler::GetDropped() noexcept
+{
+	const std::lock_guard lock(s_mutex);
+	std::size_t dropped = 0;
+	for (const auto& buffer : s_buffers)
+		dropped += buffer->dropped.load(std::memory_order_relaxed);
+	return dropped;
+}
+
+bool CPUProfiler::ExportChromeTrace(const std::filesystem::path& path) noexcept
+{
+	std::ofstream file(path);
+	if (file.is_open() == false)
+	{
+		std::cout << "[CPUProfiler]: Cannot open " << path.string() << std::endl;
+		return false;
+	}
+	file << std::fixed;
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool is_first = true;
+	const std::vector<const char*> names = GetThreadNames();
+	for (std::size_t i = 0; i < names.size(); ++i)
+	{
+		file << (is_first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":\"";
+		if (names[i])
+			WriteName(file, names[i]);
+		else
+			file << "Thread " << i;
+		file << "\"}}";
+		is_first = false;
+	}
+	for (const CPUFrame& frame : s_m_history)
+	{
+		for (const CPUZoneEvent& zone : frame.zones)
+		{
+			file << (is_first ? "\n" : ",\n") << "{\"name\":\"";
+			WriteName(file, zone.name);
+			file << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.thread
+				<< ",\"ts\":" << static_cast<double>(zone.begin) * 1e-3 << ",\"dur\":" << static_cast<double>(zone.end - zone.begin) * 1e-3 << "}";
+			is_first = false;
+		}
+	}
+	file << "\n]}\n";
+	return file.good();
+}
+
+CPUZone::CPUZone(const char* name) noexcept
+{
+	if (CPUProfiler::s_m_isEnabled.load(std::memory_order_relaxed) == false)
+		return;
+	m_name = name;
+	m_depth = t_depth++;
+	m_begin = CPUProfiler::Now();
+}
+
+CPUZone::~CPUZone() noexcept
+{
+	if (m_name == nullptr)
+		return;
+	const std::uint64_t end = CPUProfiler::Now();
+	--t_depth;
+	CPUProfiler::Record(m_name, m_begin, end, m_depth);
+}
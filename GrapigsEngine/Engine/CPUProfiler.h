@@ -0,0 +1,85 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: CPUProfiler.h
+ *	Desc		: Scoped CPU zones recorded per thread without locks
+ */
+#pragma once
+#include <atomic>		// std::atomic
+#include <cstdint>		// std::uint64_t
+#include <deque>		// std::deque
+#include <filesystem>	// std::filesystem::path
+#include <vector>		// std::vector
+
+// Nanoseconds on a steady clock, depth counts the zones open on the same thread
+struct CPUZoneEvent
+{
+	const char* name = nullptr;
+	std::uint64_t begin = 0, end = 0;
+	unsigned depth = 0;
+	unsigned thread = 0;
+};
+
+struct CPUFrame
+{
+	std::uint64_t begin = 0, end = 0;
+	std::vector<CPUZoneEvent> zones;
+};
+
+// Every thread writes its zones to its own ring, the main thread drains the rings once a frame
+class CPUProfiler
+{
+public:
+	static constexpr std::size_t s_bufferSize = 1 << 14;
+	static constexpr std::size_t s_historySize = 300;
+
+	[[nodiscard]] static std::uint64_t Now() noexcept;
+	static void Record(const char* name, std::uint64_t begin, std::uint64_t end, unsigned depth) noexcept;
+	// The name is shown on the thread's lane, it has to outlive the profiler
+	static void SetThreadName(const char* name) noexcept;
+	static void EndFrame() noexcept;
+	static void Clear() noexcept;
+
+	[[nodiscard]] static const CPUFrame& GetLastFrame() noexcept;
+	[[nodiscard]] static const std::deque<CPUFrame>& GetHistory() noexcept;
+	[[nodiscard]] static std::vector<const char*> GetThreadNames() noexcept;
+	// Zones lost because a ring was full
+	[[nodiscard]] static std::size_t GetDropped() noexcept;
+	// Chrome trace event format, opens in chrome://tracing and ui.perfetto.dev
+	static bool ExportChromeTrace(const std::filesystem::path& path) noexcept;
+
+	static std::atomic<bool> s_m_isEnabled;
+	// The history stops growing while paused, the rings are still drained
+	static bool s_m_isPaused;
+
+	struct ThreadBuffer;
+private:
+	[[nodiscard]] static ThreadBuffer& GetThreadBuffer() noexcept;
+
+	static CPUFrame s_m_lastFrame;
+	static std::deque<CPUFrame> s_m_history;
+	static std::uint64_t s_m_frameBegin;
+};
+
+class CPUZone
+{
+public:
+	explicit CPUZone(const char* name) noexcept;
+	~CPUZone() noexcept;
+	CPUZone(const CPUZone&) = delete;
+	CPUZone& operator=(const CPUZone&) = delete;
+private:
+	const char* m_name = nullptr;
+	std::uint64_t m_begin = 0;
+	unsigned m_depth = 0;
+};
+
+// Defining CPU_PROFILER_DISABLED compiles every zone out
+#ifdef CPU_PROFILER_DISABLED
+#define PROFILE_ZONE(name) ((void)0)
+#else
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) const CPUZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#endif
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
@@ -6,13 +6,101 @@
  */
 #include "Camera.h"
 
+#include <algorithm>	// std::clamp
+#include <cstddef>	// offsetof
+#include <fstream>	// std::ifstream, std::ofstream
 #include <iostream>
-#include <gl/glew.h>	// gl functions for camera buffer
+#include <limits>	// std::numeric_limits
+#include <sstream>	// std::istringstream
 #include <glm/gtc/matrix_transform.hpp>	// matrix calculation
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>	// SSE2 for frustum culling
+#define FRUSTUM_USE_SSE
+#endif
 
 #include "Input.h"
+#include "UniformRing.h"	// UniformRing
 
- /* Camera - start -------------------------------------------------------------------------------*/
+/* Frustum - start ------------------------------------------------------------------------------*/
+
+void Frustum::Extract(const glm::mat4& world_to_ndc) noexcept
+{
+	// Gribb-Hartmann: each plane is a sum of the last row and one of the other rows
+	const glm::vec4 row0{ world_to_ndc[0][0], world_to_ndc[1][0], world_to_ndc[2][0], world_to_ndc[3][0] };
+	const glm::vec4 row1{ world_to_ndc[0][1], world_to_ndc[1][1], world_to_ndc[2][1], world_to_ndc[3][1] };
+	const glm::vec4 row2{ world_to_ndc[0][2], world_to_ndc[1][2], world_to_ndc[2][2], world_to_ndc[3][2] };
+	const glm::vec4 row3{ world_to_ndc[0][3], world_to_ndc[1][3], world_to_ndc[2][3], world_to_ndc[3][3] };
+	planes[0] = row3 + row0;
+	planes[1] = row3 - row0;
+	planes[2] = row3 + row1;
+	planes[3] = row3 - row1;
+	planes[4] = row3 + row2;
+	planes[5] = row3 - row2;
+	for (auto& plane : planes)
+		plane /= glm::length(glm::vec3{ plane });
+}
+
+bool Frustum::IsVisible(const glm::vec4& sphere) const noexcept
+{
+	for (const auto& plane : planes)
+	{
+		if (glm::dot(glm::vec3{ plane }, glm::vec3{ sphere }) + plane.w < -sphere.w)
+			return false;
+	}
+	return true;
+}
+
+std::size_t Frustum::CullSpheres(const glm::vec4* spheres, std::size_t count, unsigned char* visible) const noexcept
+{
+	std::size_t visible_count = 0;
+	std::size_t i = 0;
+#ifdef FRUSTUM_USE_SSE
+	// Four spheres against one plane at a time
+	__m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+	for (int p = 0; p < 6; ++p)
+	{
+		plane_x[p] = _mm_set1_ps(planes[p].x);
+		plane_y[p] = _mm_set1_ps(planes[p].y);
+		plane_z[p] = _mm_set1_ps(planes[p].z);
+		plane_w[p] = _mm_set1_ps(planes[p].w);
+	}
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&spheres[i].x);
+		__m128 y = _mm_loadu_ps(&spheres[i + 1].x);
+		__m128 z = _mm_loadu_ps(&spheres[i + 2].x);
+		__m128 r = _mm_loadu_ps(&spheres[i + 3].x);
+		_MM_TRANSPOSE4_PS(x, y, z, r);
+		const __m128 neg_r = _mm_sub_ps(_mm_setzero_ps(), r);
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; ++p)
+		{
+			__m128 distance = _mm_add_ps(_mm_mul_ps(plane_x[p], x), plane_w[p]);
+			distance = _mm_add_ps(distance, _mm_mul_ps(plane_y[p], y));
+			distance = _mm_add_ps(distance, _mm_mul_ps(plane_z[p], z));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, neg_r));
+		}
+
+		const int mask = _mm_movemask_ps(inside);
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			visible[i + lane] = static_cast<unsigned char>((mask >> lane) & 1);
+			visible_count += visible[i + lane];
+		}
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		visible[i] = IsVisible(spheres[i]) ? 1 : 0;
+		visible_count += visible[i];
+	}
+	return visible_count;
+}
+
+/* Frustum - end --------------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
+/* Camera - start -------------------------------------------------------------------------------*/
 
 Camera::Camera() noexcept
 	:
@@ -98,6 +186,16 @@ const glm::mat4& Camera::GetCameraToNDCMatrix() const noexcept
 	return  m_cameraToNDC;
 }
 
+const glm::mat4& Camera::GetWorldToNDCMatrix() const noexcept
+{
+	return m_worldToNDC;
+}
+
+const Frustum& Camera::GetFrustum() const noexcept
+{
+	return m_frustum;
+}
+
 const glm::vec3& Camera::Eye() const noexcept
 {
 	return m_eye;
@@ -209,37 +307,123 @@ void Camera::UpdateMatrix() noexcept
 	m_worldToCamera = glm::lookAt(m_eye, m_eye + m_back, m_up);
 	m_cameraToNDC = glm::perspective(glm::radians(m_fov), CameraBuffer::s_m_aspectRatio, m_near, m_far);
 	m_worldToNDC = m_cameraToNDC * m_worldToCamera;
+	m_frustum.Extract(m_worldToNDC);
 }
 
 /* Camera - end ---------------------------------------------------------------------------------*/
 /*-----------------------------------------------------------------------------------------------*/
+/* CameraPath - start ---------------------------------------------------------------------------*/
+
+namespace
+{
+	// Uniform Catmull-Rom segment from p1 to p2
+	glm::vec3 CatmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t) noexcept
+	{
+		const float t2 = t * t, t3 = t2 * t;
+		return 0.5f * (2.f * p1 + (p2 - p0) * t + (2.f * p0 - 5.f * p1 + 4.f * p2 - p3) * t2 + (3.f * p1 - p0 - 3.f * p2 + p3) * t3);
+	}
+}
+
+bool CameraPath::Load(const std::filesystem::path& path) noexcept
+{
+	std::ifstream file(path);
+	if (file.is_open() == false)
+	{
+		std::cout << "[CameraPath]: Cannot open " << path.string() << std::endl;
+		return false;
+	}
+	keys.clear();
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream stream(line.substr(0, line.find('#')));
+		CameraKey key;
+		if (stream >> key.eye.x >> key.eye.y >> key.eye.z >> key.target.x >> key.target.y >> key.target.z)
+			keys.push_back(key);
+	}
+	return keys.empty() == false;
+}
+
+bool CameraPath::Save(const std::filesystem::path& path) const noexcept
+{
+	std::ofstream file(path);
+	if (file.is_open() == false)
+	{
+		std::cout << "[CameraPath]: Cannot write " << path.string() << std::endl;
+		return false;
+	}
+	// Enough digits to read back the exact floats, so a replay sees the recorded views
+	file.precision(std::numeric_limits<float>::max_digits10);
+	for (const CameraKey& key : keys)
+		file << key.eye.x << ' ' << key.eye.y << ' ' << key.eye.z << ' ' << key.target.x << ' ' << key.target.y << ' ' << key.target.z << '\n';
+	return file.good();
+}
+
+CameraKey CameraPath::Sample(float t) const noexcept
+{
+	if (keys.empty())
+		return CameraKey{};
+	if (keys.size() == 1)
+		return keys.front();
+
+	const float position = std::clamp(t, 0.f, 1.f) * static_cast<float>(keys.size() - 1);
+	const std::size_t i = std::min(static_cast<std::size_t>(position), keys.size() - 2);
+	const float u = position - static_cast<float>(i);
+	const CameraKey& k1 = keys[i];
+	const CameraKey& k2 = keys[i + 1];
+	if (isSpline == false)
+		return CameraKey{ glm::mix(k1.eye, k2.eye, u), glm::mix(k1.target, k2.target, u) };
+
+	// The end keys are repeated so the curve passes through every key
+	const CameraKey& k0 = keys[i > 0 ? i - 1 : 0];
+	const CameraKey& k3 = keys[std::min(i + 2, keys.size() - 1)];
+	return CameraKey{ CatmullRom(k0.eye, k1.eye, k2.eye, k3.eye, u), CatmullRom(k0.target, k1.target, k2.target, k3.target, u) };
+}
+
+/* CameraPath - end -----------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
 /* CameraBuffer - start -------------------------------------------------------------------------*/
 
-unsigned CameraBuffer::s_m_handle = 0;
+namespace
+{
+	// Transform block of the shaders (std140)
+	struct TransformBlock
+	{
+		glm::mat4 worldToCamera;
+		glm::mat4 cameraToNDC;
+		glm::mat4 worldToNDC;
+		glm::vec3 camPosition;
+		float camNear;
+		float camFar;
+	};
+	static_assert(offsetof(TransformBlock, camPosition) == 192 && offsetof(TransformBlock, camFar) == 208);
+}
+
 float CameraBuffer::s_m_aspectRatio = 1200.f / 900.f;
 Camera* CameraBuffer::s_m_camera = nullptr;
+bool CameraBuffer::s_m_isInputEnabled = true;
+CameraPath* CameraBuffer::s_m_recording = nullptr;
 
 void CameraBuffer::Clear() noexcept
 {
 	delete s_m_camera;
 	s_m_camera = nullptr;
-	glDeleteBuffers(1, &s_m_handle);
-	s_m_handle = 0;
+	UniformRing::Clear();
 }
 
 void CameraBuffer::SetMainCamera(Camera* p_camera) noexcept
 {
 	s_m_camera = p_camera;
-	if (s_m_handle < 1)
-	{
-		glCreateBuffers(1, &s_m_handle);
-		glNamedBufferStorage(s_m_handle, sizeof(glm::mat4) * 3 + sizeof(glm::vec3) + sizeof(float) * 2, nullptr, GL_DYNAMIC_STORAGE_BIT);
-		glBindBufferBase(GL_UNIFORM_BUFFER, 0, s_m_handle);
-	}
 }
 
 void CameraBuffer::UpdateMainCamera() noexcept
 {
+	if (s_m_recording)
+		// The view looks along m_back, the recorded target is one unit in front of the eye
+		s_m_recording->keys.push_back(CameraKey{ s_m_camera->m_eye, s_m_camera->m_eye + s_m_camera->m_back });
+	if (s_m_isInputEnabled == false)
+		return;
+
 	auto cursor_dir = Input::GetMouseMovingDirection(MouseButton::Right);
 	if (cursor_dir.x != 0 || cursor_dir.y != 0)
 	{
@@ -292,15 +476,44 @@ Camera* CameraBuffer::GetMainCamera() noexcept
 	return s_m_camera;
 }
 
+void CameraBuffer::SetMainCamera(const CameraKey& key) noexcept
+{
+	// Set faces the camera against its look vector, so the vector goes from the target to the eye
+	const glm::vec3 look = key.eye - key.target;
+	if (glm::dot(look, look) < 1e-12f)
+		return;
+	// Looking straight up or down needs another up vector
+	const glm::vec3 direction = glm::normalize(look);
+	const glm::vec3 up = std::abs(direction.y) > 0.999f ? glm::vec3{ 0, 0, -1 } : glm::vec3{ 0, 1, 0 };
+	s_m_camera->Set(key.eye, direction, up);
+}
+
+void CameraBuffer::Record(CameraPath* p_path) noexcept
+{
+	s_m_recording = p_path;
+	if (s_m_recording)
+	{
+		s_m_recording->keys.clear();
+		s_m_recording->isSpline = false;
+	}
+}
+
+bool CameraBuffer::IsRecording() noexcept
+{
+	return s_m_recording != nullptr;
+}
+
 void CameraBuffer::Bind() noexcept
 {
-	glNamedBufferSubData(s_m_handle, 0, sizeof(glm::mat4), &s_m_camera->m_worldToCamera[0][0]);
-	glNamedBufferSubData(s_m_handle, sizeof(glm::mat4), sizeof(glm::mat4), &s_m_camera->m_cameraToNDC[0][0]);
-	glNamedBufferSubData(s_m_handle, sizeof(glm::mat4) * 2, sizeof(glm::mat4), &s_m_camera->m_worldToNDC[0][0]);
-	glNamedBufferSubData(s_m_handle, sizeof(glm::mat4) * 3, sizeof(glm::vec3), &s_m_camera->Eye()[0]);
-	glNamedBufferSubData(s_m_handle, sizeof(glm::mat4) * 3 + sizeof(glm::vec3), sizeof(float), &s_m_camera->m_near);
-	glNamedBufferSubData(s_m_handle, sizeof(glm::mat4) * 3 + sizeof(glm::vec3) + sizeof(float), sizeof(float), &s_m_camera->m_far);
-	glBindBuffer(GL_UNIFORM_BUFFER, s_m_handle);
+	const TransformBlock block{ s_m_camera->m_worldToCamera, s_m_camera->m_cameraToNDC, s_m_camera->m_worldToNDC,
+		s_m_camera->m_eye, s_m_camera->m_near, s_m_camera->m_far };
+	UniformRing::Bind(0, &block, sizeof(block));
+}
+
+void CameraBuffer::Bind(const glm::mat4& world_to_camera, const glm::mat4& camera_to_ndc, const glm::vec3& eye, float near_plane, float far_plane) noexcept
+{
+	const TransformBlock block{ world_to_camera, camera_to_ndc, camera_to_ndc * world_to_camera, eye, near_plane, far_plane };
+	UniformRing::Bind(0, &block, sizeof(block));
 }
 
 glm::vec3 CameraBuffer::GetMouseRay() noexcept
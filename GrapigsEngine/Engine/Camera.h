@@ -5,8 +5,20 @@
  *	Desc		: Camera functions
  */
 #pragma once
+#include <filesystem>	// std::filesystem::path
+#include <vector>		// std::vector
 #include <glm/glm.hpp>	// glm
 
+struct Frustum
+{
+	void Extract(const glm::mat4& world_to_ndc) noexcept;
+	[[nodiscard]] bool IsVisible(const glm::vec4& sphere) const noexcept;
+	std::size_t CullSpheres(const glm::vec4* spheres, std::size_t count, unsigned char* visible) const noexcept;
+
+	// left, right, bottom, top, near, far (xyz: normal pointing inside, w: distance)
+	glm::vec4 planes[6]{};
+};
+
 class Camera
 {
 	friend class CameraBuffer;
@@ -22,6 +34,8 @@ public:
 
 	[[nodiscard]] const glm::mat4& GetWorldToCameraMatrix() const noexcept;
 	[[nodiscard]] const glm::mat4& GetCameraToNDCMatrix() const noexcept;
+	[[nodiscard]] const glm::mat4& GetWorldToNDCMatrix() const noexcept;
+	[[nodiscard]] const Frustum& GetFrustum() const noexcept;
 
 	[[nodiscard]] const glm::vec3& Eye() const noexcept;
 	[[nodiscard]] const glm::vec3& Back() const noexcept;
@@ -43,6 +57,27 @@ private:
 	float m_near, m_far, m_fov;
 	glm::vec3 m_eye, m_right, m_up, m_back;
 	glm::mat4 m_worldToCamera, m_cameraToNDC, m_worldToNDC;
+	Frustum m_frustum;
+};
+
+// Eye and point looked at by the camera at one point of a path
+struct CameraKey
+{
+	glm::vec3 eye{ 0, 0, 1.3f };
+	glm::vec3 target{ 0 };
+};
+
+// A recorded path holds one key per frame, a spline path is a Catmull-Rom curve through a few keys
+struct CameraPath
+{
+	// One key per line: eye.x eye.y eye.z target.x target.y target.z
+	bool Load(const std::filesystem::path& path) noexcept;
+	bool Save(const std::filesystem::path& path) const noexcept;
+	// t in [0, 1] over the whole path
+	[[nodiscard]] CameraKey Sample(float t) const noexcept;
+
+	std::vector<CameraKey> keys;
+	bool isSpline = false;
 };
 
 class CameraBuffer
@@ -52,11 +87,19 @@ public:
 	static void SetMainCamera(Camera* p_camera) noexcept;
 	static void UpdateMainCamera() noexcept;
 	static Camera* GetMainCamera() noexcept;
+	// Places the main camera at a key of a path, input should be disabled while a path drives it
+	static void SetMainCamera(const CameraKey& key) noexcept;
+	// Appends the main camera to the path every frame until called with nullptr
+	static void Record(CameraPath* p_path) noexcept;
+	[[nodiscard]] static bool IsRecording() noexcept;
 	static void Bind() noexcept;
+	// Transform block of another view, such as a light rendering its shadow map
+	static void Bind(const glm::mat4& world_to_camera, const glm::mat4& camera_to_ndc, const glm::vec3& eye, float near_plane, float far_plane) noexcept;
 	static glm::vec3 GetMouseRay() noexcept;
 	static void UpdateMatrix() noexcept;
 	static float s_m_aspectRatio;
 	static Camera* s_m_camera;
+	static bool s_m_isInputEnabled;
 private:
-	static unsigned s_m_handle;
+	static CameraPath* s_m_recording;
 };
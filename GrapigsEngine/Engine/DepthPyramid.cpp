@@ -0,0 +1,98 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: DepthPyramid.cpp
+ *	Desc		: Hierarchical depth (Hi-Z) built from the scene depth for occlusion culling
+ */
+#include "DepthPyramid.h"
+
+#include <gl/glew.h>	// gl functions
+#include <algorithm>	// std::max
+
+#include "GLState.h"	// GLState
+
+DepthPyramid::DepthPyramid() noexcept
+	: m_unit(Texture::s_textureCount++), m_depthUnit(Texture::s_textureCount++)
+{
+	const std::vector<std::pair<ShaderType, std::filesystem::path>> files = {
+		std::make_pair(ShaderType::Compute, "shader/hiz.comp")
+	};
+	m_program = new ShaderProgram(files);
+	m_program->m_name = "hiz";
+}
+
+DepthPyramid::~DepthPyramid() noexcept
+{
+	delete m_program;
+	m_program = nullptr;
+	GLState::DeleteTextures(1, &m_texture);
+	m_texture = 0;
+}
+
+void DepthPyramid::Build(const FrameBufferObject& fbo, const glm::mat4& world_to_ndc) noexcept
+{
+	if (fbo.GetDepthTexture() == 0)
+		return;
+	if (fbo.Width() != m_width || fbo.Height() != m_height)
+		Resize(fbo.Width(), fbo.Height());
+
+	m_program->Use();
+	GLState::BindTextureUnit(m_depthUnit, fbo.GetDepthTexture());
+	m_program->SendUniform("t_depth", static_cast<int>(m_depthUnit));
+
+	// Level 0 copies the depth, each next level reduces the previous one
+	int width = m_width, height = m_height;
+	for (int level = 0; level < m_levels; ++level)
+	{
+		m_program->SendUniform("u_level", level);
+		if (level > 0)
+			glBindImageTexture(0, m_texture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		glBindImageTexture(1, m_texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glDispatchCompute(static_cast<unsigned>(width + 7) / 8, static_cast<unsigned>(height + 7) / 8, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+	}
+	m_program->UnUse();
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	m_worldToNDC = world_to_ndc;
+	m_isValid = true;
+}
+
+void DepthPyramid::Bind(const ShaderProgram* program) const noexcept
+{
+	program->SendUniform("t_hiz", static_cast<int>(m_unit));
+	program->SendUniform("u_hizSize", glm::vec2{ static_cast<float>(m_width), static_cast<float>(m_height) });
+	program->SendUniform("u_hizLevels", m_levels);
+	program->SendUniform("u_previousWorldToNDC", m_worldToNDC);
+}
+
+void DepthPyramid::Invalidate() noexcept
+{
+	m_isValid = false;
+}
+
+bool DepthPyramid::IsValid() const noexcept
+{
+	return m_isValid;
+}
+
+void DepthPyramid::Resize(int width, int height) noexcept
+{
+	GLState::DeleteTextures(1, &m_texture);
+	m_width = width;
+	m_height = height;
+	m_levels = 1;
+	while ((std::max(width, height) >> m_levels) > 0)
+		++m_levels;
+
+	glCreateTextures(GL_TEXTURE_2D, 1, &m_texture);
+	glTextureStorage2D(m_texture, m_levels, GL_R32F, width, height);
+	glTextureParameteri(m_texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTextureParameteri(m_texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTextureParameteri(m_texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(m_texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLState::BindTextureUnit(m_unit, m_texture);
+	m_isValid = false;
+}
@@ -0,0 +1,32 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: DepthPyramid.h
+ *	Desc		: Hierarchical depth (Hi-Z) built from the scene depth for occlusion culling
+ */
+#pragma once
+#include <glm/glm.hpp>	// glm
+
+#include "Shader.h"	// ShaderProgram, FrameBufferObject
+
+class DepthPyramid
+{
+public:
+	DepthPyramid() noexcept;
+	~DepthPyramid() noexcept;
+	// Every level keeps the farthest depth of the texels below it
+	void Build(const FrameBufferObject& fbo, const glm::mat4& world_to_ndc) noexcept;
+	// Sends the pyramid and the matrix it was built with to a culling program
+	void Bind(const ShaderProgram* program) const noexcept;
+	void Invalidate() noexcept;
+	[[nodiscard]] bool IsValid() const noexcept;
+private:
+	void Resize(int width, int height) noexcept;
+
+	ShaderProgram* m_program = nullptr;
+	const unsigned m_unit, m_depthUnit;
+	unsigned m_texture = 0;
+	int m_width = 0, m_height = 0, m_levels = 0;
+	glm::mat4 m_worldToNDC{ 1 };
+	bool m_isValid = false;
+};
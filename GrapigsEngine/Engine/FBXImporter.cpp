@@ -12,8 +12,99 @@
 #include <gl/glew.h>		// gl	
 #include <glm/gtc/matrix_transform.hpp> // transform matrix calculation
 #include <sstream>			// stringstream
+#include <unordered_map>	// std::unordered_map
+#include <cstring>			// std::memcmp
 
- /* Model - start --------------------------------------------------------------------------------*/
+#include "GLState.h"			// GLState
+#include "MeshSimplifier.h"	// MeshSimplifier
+#include "MeshletBuilder.h"	// MeshletBuilder
+
+ /* Material - start -----------------------------------------------------------------------------*/
+
+void Material::SendTextures(ShaderProgram* program) const noexcept
+{
+	// Depth-only programs and variants without a map declare none of these samplers
+	const std::pair<const char*, const Texture*> samplers[] = {
+		{ "t_albedo", t_albedo }, { "t_metallic", t_metallic }, { "t_roughness", t_roughness }, { "t_ao", t_ao }, { "t_normal", t_normal }
+	};
+	for (const auto& [p_name, p_texture] : samplers)
+	{
+		if (p_texture && program->HasUniform(p_name))
+			program->SendUniform(p_name, p_texture->Unit());
+	}
+}
+
+bool Material::HasSameTextures(const Material& other) const noexcept
+{
+	return t_albedo == other.t_albedo && t_metallic == other.t_metallic && t_roughness == other.t_roughness
+		&& t_ao == other.t_ao && t_normal == other.t_normal;
+}
+
+unsigned Material::GetFeatures() const noexcept
+{
+	unsigned features = 0;
+	if (t_albedo)
+		features |= static_cast<unsigned>(ShaderFeature::AlbedoMap);
+	if (t_metallic)
+		features |= static_cast<unsigned>(ShaderFeature::MetallicMap);
+	if (t_roughness)
+		features |= static_cast<unsigned>(ShaderFeature::RoughnessMap);
+	if (t_ao)
+		features |= static_cast<unsigned>(ShaderFeature::AOMap);
+	return features;
+}
+
+/* Material - end -------------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
+/* Bounds - start -------------------------------------------------------------------------------*/
+
+void Bounds::Expand(const glm::vec3& point) noexcept
+{
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+}
+
+void Bounds::Expand(const Bounds& bounds, const glm::mat4& transform) noexcept
+{
+	if (bounds.IsEmpty())
+		return;
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		const glm::vec3 point{ (corner & 1) ? bounds.max.x : bounds.min.x, (corner & 2) ? bounds.max.y : bounds.min.y, (corner & 4) ? bounds.max.z : bounds.min.z };
+		Expand(glm::vec3{ transform * glm::vec4{ point, 1 } });
+	}
+	center = (min + max) * 0.5f;
+	radius = glm::length(max - min) * 0.5f;
+}
+
+void Bounds::UpdateSphere(const std::vector<Vertex>& vertices) noexcept
+{
+	// Sphere around the box center, tightened to the farthest vertex
+	center = (min + max) * 0.5f;
+	float radius_sq = 0.f;
+	for (const auto& v : vertices)
+	{
+		const glm::vec3 d = glm::vec3{ v.position } - center;
+		radius_sq = std::max(radius_sq, glm::dot(d, d));
+	}
+	radius = std::sqrt(radius_sq);
+}
+
+bool Bounds::IsEmpty() const noexcept
+{
+	return min.x > max.x;
+}
+
+glm::vec4 Bounds::GetSphere(const glm::mat4& transform) const noexcept
+{
+	const float scale_sq = std::max(glm::dot(glm::vec3{ transform[0] }, glm::vec3{ transform[0] }),
+		std::max(glm::dot(glm::vec3{ transform[1] }, glm::vec3{ transform[1] }), glm::dot(glm::vec3{ transform[2] }, glm::vec3{ transform[2] })));
+	return glm::vec4{ glm::vec3{ transform * glm::vec4{ center, 1 } }, radius * std::sqrt(scale_sq) };
+}
+
+/* Bounds - end ---------------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
+/* Model - start --------------------------------------------------------------------------------*/
 
 Model::Model(const std::filesystem::path& file_path)
 	: m_path(file_path)
@@ -25,18 +116,45 @@ Model::~Model()
 	Clear();
 }
 
-void Model::InitBuffers(int largest_index) noexcept
+void Model::InitBuffers() noexcept
 {
-	if (largest_index < 0)
+	// Every mesh of the model shares one vertex buffer and one index buffer
+	std::size_t vertex_count = 0, index_count = 0;
+	for (auto& mesh : m_meshes)
+	{
+		mesh.baseVertex = static_cast<int>(vertex_count);
+		mesh.firstIndex = static_cast<unsigned>(index_count);
+		vertex_count += mesh.vertices.size();
+		index_count += mesh.indices.size();
+	}
+	if (vertex_count == 0 || index_count == 0)
 		return;
 
 	if (m_vbo == 0)
 		glCreateBuffers(1, &m_vbo);
-	glNamedBufferStorage(m_vbo, static_cast<GLsizeiptr>(sizeof(Vertex) * m_meshes[largest_index].vertices.size()), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glNamedBufferStorage(m_vbo, static_cast<GLsizeiptr>(sizeof(Vertex) * vertex_count), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	if (m_ibo == 0)
+		glCreateBuffers(1, &m_ibo);
+	glNamedBufferStorage(m_ibo, static_cast<GLsizeiptr>(sizeof(unsigned) * index_count), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	if (m_positionVbo == 0)
+		glCreateBuffers(1, &m_positionVbo);
+	glNamedBufferStorage(m_positionVbo, static_cast<GLsizeiptr>(sizeof(glm::vec4) * vertex_count), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	std::vector<glm::vec4> positions;
+	for (const auto& mesh : m_meshes)
+	{
+		if (mesh.indices.empty())
+			continue;
+		glNamedBufferSubData(m_vbo, static_cast<GLintptr>(sizeof(Vertex) * mesh.baseVertex), static_cast<GLsizeiptr>(sizeof(Vertex) * mesh.vertices.size()), mesh.vertices.data());
+		glNamedBufferSubData(m_ibo, static_cast<GLintptr>(sizeof(unsigned) * mesh.firstIndex), static_cast<GLsizeiptr>(sizeof(unsigned) * mesh.indices.size()), mesh.indices.data());
+
+		positions.clear();
+		for (const auto& v : mesh.vertices)
+			positions.push_back(v.position);
+		glNamedBufferSubData(m_positionVbo, static_cast<GLintptr>(sizeof(glm::vec4) * mesh.baseVertex), static_cast<GLsizeiptr>(sizeof(glm::vec4) * positions.size()), positions.data());
+	}
 
 	if (m_vao == 0)
 		glCreateVertexArrays(1, &m_vao);
-	glBindVertexArray(m_vao);
 
 	// Vertex Position
 	glEnableVertexArrayAttrib(m_vao, 0);
@@ -49,75 +167,110 @@ void Model::InitBuffers(int largest_index) noexcept
 	glVertexArrayAttribFormat(m_vao, 1, 4, GL_FLOAT, GL_FALSE, offsetof(Vertex, vertex_normal));
 	glVertexArrayAttribBinding(m_vao, 1, 0);
 
-	// Face Normal
-	glEnableVertexArrayAttrib(m_vao, 2);
-	glVertexArrayAttribFormat(m_vao, 2, 4, GL_FLOAT, GL_FALSE, offsetof(Vertex, face_normal));
-	glVertexArrayAttribBinding(m_vao, 2, 0);
-
     // Texture Coordinate
 	glEnableVertexArrayAttrib(m_vao, 3);
 	glVertexArrayAttribFormat(m_vao, 3, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, texture_coordinate));
 	glVertexArrayAttribBinding(m_vao, 3, 0);
 
-	glBindVertexArray(0);
+	// Index
+	glVertexArrayElementBuffer(m_vao, m_ibo);
+
+	// Depth-only draws fetch 16 bytes per vertex instead of the whole vertex
+	if (m_positionVao == 0)
+		glCreateVertexArrays(1, &m_positionVao);
+	glEnableVertexArrayAttrib(m_positionVao, 0);
+	glVertexArrayVertexBuffer(m_positionVao, 0, m_positionVbo, 0, sizeof(glm::vec4));
+	glVertexArrayAttribFormat(m_positionVao, 0, 4, GL_FLOAT, GL_FALSE, 0);
+	glVertexArrayAttribBinding(m_positionVao, 0, 0);
+	glVertexArrayElementBuffer(m_positionVao, m_ibo);
 }
 
 void Model::Clear() noexcept
 {
 	if(m_vao > 0)
-		glDeleteVertexArrays(1, &m_vao);
+		GLState::DeleteVertexArrays(1, &m_vao);
 	m_vao = 0;
 	if(m_vbo > 0)
-		glDeleteBuffers(1, &m_vbo);
+		GLState::DeleteBuffers(1, &m_vbo);
 	m_vbo = 0;
+	if (m_ibo > 0)
+		GLState::DeleteBuffers(1, &m_ibo);
+	m_ibo = 0;
+	if (m_positionVao > 0)
+		GLState::DeleteVertexArrays(1, &m_positionVao);
+	m_positionVao = 0;
+	if (m_positionVbo > 0)
+		GLState::DeleteBuffers(1, &m_positionVbo);
+	m_positionVbo = 0;
 }
 
-void Model::Draw(Primitive primitive, ShaderProgram* program) noexcept
+void Model::Draw(Primitive primitive, ShaderProgram* program, unsigned first_instance, unsigned instance_count) noexcept
 {
-	if (m_vao)
+	if (m_vao && instance_count > 0)
 	{
-		glBindVertexArray(m_vao);
-		Draw(primitive, program, m_root, glm::mat4{ 1 });
-		glBindVertexArray(0);
+		GLState::BindVertexArray(m_vao);
+		Draw(primitive, program, m_root, InstanceRange{ first_instance, instance_count });
 	}
 }
 
-void Model::Draw(Primitive primitive, ShaderProgram* program, int index, glm::mat4 transform) const noexcept
+void Model::DrawMeshes(Primitive primitive, const InstanceRange* mesh_ranges, const Material& material) const noexcept
 {
-	const auto& mesh = m_meshes[index];
-	const auto& vertex = mesh.vertices;
+	if (mesh_ranges == nullptr)
+		return;
 
-	if (vertex.empty() == false)
+	// Transform and constants of each mesh are read from the mesh draw buffer
+	for (std::size_t i = 0; i < m_meshes.size(); ++i)
 	{
-		program->SendUniform("u_localToModel", mesh.transform);
+		const auto& mesh = m_meshes[i];
+		if (mesh.lods.empty() || mesh.material.HasSameTextures(material) == false)
+			continue;
 
-		program->SendUniform("u_has_albedo", mesh.material.t_albedo!=nullptr);
-		program->SendUniform("u_has_metallic", mesh.material.t_metallic != nullptr);
-		program->SendUniform("u_has_roughness", mesh.material.t_roughness != nullptr);
-		program->SendUniform("u_has_ao", mesh.material.t_ao != nullptr);
-		program->SendUniform("u_has_normalmap", mesh.material.t_normal != nullptr);
-
-		if (mesh.material.t_albedo)
-			program->SendUniform("t_albedo", mesh.material.t_albedo->Unit());
-		if (mesh.material.t_metallic)
-			program->SendUniform("t_metallic", mesh.material.t_metallic->Unit());
-	    if (mesh.material.t_roughness)
-			program->SendUniform("t_roughness", mesh.material.t_roughness->Unit());
-		if (mesh.material.t_ao)
-			program->SendUniform("t_ao", mesh.material.t_ao->Unit());
-		if (mesh.material.t_normal)
-			program->SendUniform("t_normal", mesh.material.t_normal->Unit());
+		// One draw covers every visible instance of a LOD
+		for (std::size_t lod = 0; lod < mesh.lods.size(); ++lod)
+		{
+			const InstanceRange& range = mesh_ranges[i * Mesh::s_maxLods + lod];
+			if (range.count == 0)
+				continue;
+			const void* offset = reinterpret_cast<const void*>(sizeof(unsigned) * static_cast<std::size_t>(mesh.firstIndex + mesh.lods[lod].firstIndex));
+			glDrawElementsInstancedBaseVertexBaseInstance(static_cast<GLenum>(primitive), static_cast<GLsizei>(mesh.lods[lod].indexCount), GL_UNSIGNED_INT,
+				offset, static_cast<GLsizei>(range.count), mesh.baseVertex, range.first);
+		}
+	}
+}
+
+void Model::DrawIndirect(Primitive primitive, std::size_t first_command, std::size_t count_offset, unsigned max_draw_count) const noexcept
+{
+	if (m_vao && max_draw_count > 0)
+	{
+		glMultiDrawElementsIndirectCount(static_cast<GLenum>(primitive), GL_UNSIGNED_INT, reinterpret_cast<const void*>(first_command * sizeof(DrawCommand)),
+			static_cast<GLintptr>(count_offset), static_cast<GLsizei>(max_draw_count), 0);
+	}
+}
+
+unsigned Model::GetVao(VertexStream stream) const noexcept
+{
+	return stream == VertexStream::Position && m_positionVao ? m_positionVao : m_vao;
+}
 
+void Model::Draw(Primitive primitive, ShaderProgram* program, int index, const InstanceRange& object_range) const noexcept
+{
+	const auto& mesh = m_meshes[index];
+	if (mesh.lods.empty() == false)
+	{
+		mesh.material.SendTextures(program);
+		program->SendUniform("u_localToModel", mesh.transform);
 		program->SendUniform("u_metallic", mesh.material.metallic);
 		program->SendUniform("u_roughness", mesh.material.roughness);
 		program->SendUniform("u_albedo", mesh.material.albedo);
-		glNamedBufferSubData(m_vbo, 0, static_cast<GLsizeiptr>(sizeof(Vertex) * vertex.size()), vertex.data());
-		glDrawArrays(static_cast<GLenum>(primitive), 0, static_cast<GLsizei>(vertex.size()));
+
+		const void* offset = reinterpret_cast<const void*>(sizeof(unsigned) * static_cast<std::size_t>(mesh.firstIndex + mesh.lods[0].firstIndex));
+		glDrawElementsInstancedBaseVertexBaseInstance(static_cast<GLenum>(primitive), static_cast<GLsizei>(mesh.lods[0].indexCount), GL_UNSIGNED_INT,
+			offset, static_cast<GLsizei>(object_range.count), mesh.baseVertex, object_range.first);
 	}
 
 	for (const auto& c : m_meshes[index].children)
 	{
-		Draw(primitive, program, c, transform * mesh.transform);
+		Draw(primitive, program, c, object_range);
 	}
 }
 
@@ -263,9 +416,7 @@ namespace ParseHelper
 /* FBXImporter - start --------------------------------------------------------------------------*/
 
 std::filesystem::path FBXImporter::s_path{ "" };
-std::size_t FBXImporter::s_m_verticesCount = 0;
-int FBXImporter::s_m_meshIndex = -1;
-glm::vec3 FBXImporter::max{ std::numeric_limits<float>::min() };
+glm::vec3 FBXImporter::max{ std::numeric_limits<float>::lowest() };
 glm::vec3 FBXImporter::min{ std::numeric_limits<float>::max() };
 glm::vec4 FBXImporter::sum{ 0};
 glm::mat4 FBXImporter::globalTransform{ 1 };
@@ -328,9 +479,7 @@ FbxScene* FBXImporter::ImportFbx(FbxManager* p_manager, const char* file_path) n
 Model* FBXImporter::Parse(FbxNode* p_root) noexcept
 {
 	Model* model = nullptr;
-	s_m_meshIndex = -1;
-	s_m_verticesCount = 0;
-	max = glm::vec3{ std::numeric_limits<float>::min() };
+	max = glm::vec3{ std::numeric_limits<float>::lowest() };
 	min = glm::vec3{ std::numeric_limits<float>::max() };
 	sum = glm::vec4{ 0 };
 	globalTransform = glm::mat4{ 1 };
@@ -359,7 +508,7 @@ Model* FBXImporter::Parse(FbxNode* p_root) noexcept
 		else
 		{
 			model->m_name = p_root->GetName();
-			model->InitBuffers(s_m_meshIndex);
+			model->InitBuffers();
 		}
 	}
 
@@ -379,6 +528,10 @@ Model* FBXImporter::Parse(FbxNode* p_root) noexcept
 	}
 	model->m_meshes.front().transform = glm::mat4{ 1 };
 
+	// Bounding volume of the model in model space
+	for (const auto& m : model->m_meshes)
+		model->m_bounds.Expand(m.bounds, m.transform);
+
 	return model;
 }
 
@@ -400,11 +553,14 @@ int FBXImporter::ParseNode(FbxNode* p_node, int parent, std::vector<Mesh>& meshe
 			{
 				// Read vertex, normal, uv data
 				mesh.vertices = GetVertices(p_node->GetMesh());
-				if(mesh.vertices.size() > s_m_verticesCount)
-				{
-					s_m_verticesCount = mesh.vertices.size();
-					s_m_meshIndex = index;
-				}
+				mesh.indices = WeldVertices(mesh.vertices);
+				for (const auto& v : mesh.vertices)
+					mesh.bounds.Expand(glm::vec3{ v.position });
+				mesh.bounds.UpdateSphere(mesh.vertices);
+				// Reorders the finest LOD, so clusters are built before the coarser LODs are appended
+				if (mesh.indices.size() > 3 * MeshletBuilder::s_maxTriangles)
+					mesh.meshlets = MeshletBuilder::Build(mesh.vertices, mesh.indices);
+				BuildLods(mesh);
 			}
 
 			break;
@@ -435,7 +591,6 @@ int FBXImporter::ParseNode(FbxNode* p_node, int parent, std::vector<Mesh>& meshe
 std::vector<Vertex> FBXImporter::GetVertices(FbxMesh* p_mesh) noexcept
 {
 	std::vector<glm::vec3> ctrl_pts;
-	std::vector<glm::vec4> face_normal;
 	std::vector<int> indices;
 	std::map<int, glm::vec4> vertex_normal;
 	std::vector<glm::vec2> texture_coordinate=ParseHelper::LoadUVInformation(p_mesh);
@@ -459,7 +614,6 @@ std::vector<Vertex> FBXImporter::GetVertices(FbxMesh* p_mesh) noexcept
 			{
 				const int index = p_mesh->GetPolygonVertex(poly, vert);
 				indices.push_back(index);
-				face_normal.emplace_back(glm::vec4{ 0 });
 				auto find = vertex_normal.find(index);
 				if (find == vertex_normal.end())
 					vertex_normal[index] = glm::vec4{ ParseHelper::GetVertexNormal(p_mesh, poly, vert), 1 };
@@ -486,9 +640,6 @@ std::vector<Vertex> FBXImporter::GetVertices(FbxMesh* p_mesh) noexcept
 			int p1 = p_mesh->GetPolygonVertex(poly, 1);
 			int p2 = p_mesh->GetPolygonVertex(poly, 2);
 
-			// Face normal
-			const glm::vec4& face_norm = glm::normalize(glm::vec4{ glm::cross(ctrl_pts[p1] - ctrl_pts[p0], ctrl_pts[p2] - ctrl_pts[p0]), 0 });
-
 			for (int vert = 2; vert < vert_cnt; ++vert)
 			{
 				// Vertex
@@ -496,11 +647,6 @@ std::vector<Vertex> FBXImporter::GetVertices(FbxMesh* p_mesh) noexcept
 				indices.push_back(p1);
 				indices.push_back(p2);
 
-				// Face normal
-				face_normal.push_back(face_norm);
-				face_normal.push_back(face_norm);
-				face_normal.push_back(face_norm);
-
 				p1 = p2;
 				p2 = p_mesh->GetPolygonVertex(poly, vert + 1);
 			}
@@ -516,12 +662,84 @@ std::vector<Vertex> FBXImporter::GetVertices(FbxMesh* p_mesh) noexcept
 	for (int i = 0; i < static_cast<int>(indices.size()); ++i)
 	{
 		const glm::vec4 vertex{ ctrl_pts[indices[i]], 1 };
-		attrib.emplace_back(Vertex{ vertex, vertex_normal[indices[i]], face_normal[i], texture_coordinate.size() <= i ? glm::vec2(0) : texture_coordinate[i] });
+		attrib.emplace_back(Vertex{ vertex, vertex_normal[indices[i]], texture_coordinate.size() <= i ? glm::vec2(0) : texture_coordinate[i] });
 	}
 
 	return attrib;
 }
 
+std::vector<unsigned> FBXImporter::WeldVertices(std::vector<Vertex>& vertices) noexcept
+{
+	// Vertices are read per polygon corner, so merge the corners with identical attributes.
+	// Only the attributes the shaders read are compared, anything per face would keep every corner apart.
+	struct VertexHash
+	{
+		std::size_t operator()(const Vertex& v) const noexcept
+		{
+			std::size_t hash = 14695981039346656037ull;
+			const auto add = [&hash](const float* p_values, std::size_t count)
+			{
+				const auto* bytes = reinterpret_cast<const unsigned char*>(p_values);
+				for (std::size_t i = 0; i < sizeof(float) * count; ++i)
+					hash = (hash ^ bytes[i]) * 1099511628211ull;
+			};
+			add(&v.position[0], 4);
+			add(&v.vertex_normal[0], 4);
+			add(&v.texture_coordinate[0], 2);
+			return hash;
+		}
+	};
+	struct VertexEqual
+	{
+		bool operator()(const Vertex& a, const Vertex& b) const noexcept
+		{
+			// Bytewise like the hash, so that 0 and -0 never compare equal with different hashes
+			return std::memcmp(&a.position, &b.position, sizeof(a.position)) == 0
+				&& std::memcmp(&a.vertex_normal, &b.vertex_normal, sizeof(a.vertex_normal)) == 0
+				&& std::memcmp(&a.texture_coordinate, &b.texture_coordinate, sizeof(a.texture_coordinate)) == 0;
+		}
+	};
+
+	std::vector<unsigned> indices;
+	indices.reserve(vertices.size());
+	std::vector<Vertex> unique;
+	unique.reserve(vertices.size());
+	std::unordered_map<Vertex, unsigned, VertexHash, VertexEqual> lookup;
+	lookup.reserve(vertices.size());
+	for (const auto& v : vertices)
+	{
+		const auto [iter, inserted] = lookup.try_emplace(v, static_cast<unsigned>(unique.size()));
+		if (inserted)
+			unique.push_back(v);
+		indices.push_back(iter->second);
+	}
+	vertices = std::move(unique);
+	return indices;
+}
+
+void FBXImporter::BuildLods(Mesh& mesh) noexcept
+{
+	constexpr std::size_t min_index_count = 3 * 128;
+	mesh.lods.clear();
+	if (mesh.indices.empty())
+		return;
+	mesh.lods.push_back(MeshLod{ 0, static_cast<unsigned>(mesh.indices.size()), 0.f });
+
+	// Each LOD halves the previous one, errors add up along the chain
+	std::vector<unsigned> previous = mesh.indices;
+	while (mesh.lods.size() < Mesh::s_maxLods && previous.size() >= min_index_count)
+	{
+		float error = 0.f;
+		std::vector<unsigned> lod = MeshSimplifier::Simplify(mesh.vertices, previous, previous.size() / 2, error);
+		// Locked borders and seams can keep the mesh from shrinking
+		if (lod.empty() || lod.size() * 10 > previous.size() * 8)
+			break;
+		mesh.lods.push_back(MeshLod{ static_cast<unsigned>(mesh.indices.size()), static_cast<unsigned>(lod.size()), mesh.lods.back().error + error });
+		mesh.indices.insert(mesh.indices.end(), lod.begin(), lod.end());
+		previous = std::move(lod);
+	}
+}
+
 void FBXImporter::SetRange(float x, float y, float z) noexcept
 {
 	if (x < min.x)
@@ -7,6 +7,7 @@
 #pragma once
 #include <fbxsdk.h>	// Fbx variables and functions
 #include <vector>	// std::vector
+#include <limits>	// std::numeric_limits
 #include <glm/glm.hpp>	// glm
 #include "Shader.h" // ShaderProgram
 
@@ -18,16 +19,58 @@ enum class Primitive
 
 };
 
+// Attributes bound by a draw, depth-only passes read positions from a tightly packed stream
+enum class VertexStream
+{
+    Full, Position
+};
+
 struct Vertex
 {
 	glm::vec4 position{};
 	glm::vec4 vertex_normal{};
-	glm::vec4 face_normal{};
     glm::vec2 texture_coordinate{};
 };
 
+struct Bounds
+{
+    void Expand(const glm::vec3& point) noexcept;
+    void Expand(const Bounds& bounds, const glm::mat4& transform) noexcept;
+    void UpdateSphere(const std::vector<Vertex>& vertices) noexcept;
+    [[nodiscard]] bool IsEmpty() const noexcept;
+    [[nodiscard]] glm::vec4 GetSphere(const glm::mat4& transform) const noexcept;
+
+    glm::vec3 min{ std::numeric_limits<float>::max() };
+    glm::vec3 max{ std::numeric_limits<float>::lowest() };
+    glm::vec3 center{ 0 };
+    float radius = 0.f;
+};
+
+// Instances drawn for one mesh, gl_BaseInstance is first
+struct InstanceRange
+{
+    unsigned first = 0;
+    unsigned count = 0;
+};
+
+// Matches DrawElementsIndirectCommand of glMultiDrawElementsIndirect
+struct DrawCommand
+{
+    unsigned count = 0;
+    unsigned instanceCount = 0;
+    unsigned firstIndex = 0;
+    int baseVertex = 0;
+    unsigned baseInstance = 0;
+};
+
 struct Material
 {
+    // Samplers of the maps the program declares, its variant already knows which maps exist
+    void SendTextures(ShaderProgram* program) const noexcept;
+    [[nodiscard]] bool HasSameTextures(const Material& other) const noexcept;
+    // ShaderFeature bits of the maps this material has, picks the program variant
+    [[nodiscard]] unsigned GetFeatures() const noexcept;
+
     float metallic = 0.f;
     float roughness = 0.f;
     glm::vec3 albedo = glm::vec3(1);
@@ -38,15 +81,43 @@ struct Material
     Texture* t_normal = nullptr;
 };
 
+// Index range of one level of detail, relative to Mesh::firstIndex
+struct MeshLod
+{
+    unsigned firstIndex = 0;
+    unsigned indexCount = 0;
+    float error = 0.f;  // geometric error in vertex units
+};
+
+// Cluster of the finest LOD, matches Meshlet in cluster.comp (std430)
+struct Meshlet
+{
+    glm::vec4 sphere{ 0 };          // bounding sphere in vertex units
+    glm::vec4 cone{ 0, 0, 0, 2 };   // xyz: average face normal, w: sine of the normal spread, above 1 is never back-facing
+    unsigned firstIndex = 0;        // relative to Mesh::firstIndex
+    unsigned indexCount = 0;
+    unsigned padding[2]{};
+};
+
 struct Mesh
 {
+    static constexpr unsigned s_maxLods = 4;
+
     std::string name{};
     glm::mat4 transform{ 1 };
     std::vector<Vertex> vertices;
+    // Every LOD, finest first
+    std::vector<unsigned> indices;
+    std::vector<MeshLod> lods;
+    // Contiguous index ranges of the finest LOD, empty for small meshes
+    std::vector<Meshlet> meshlets;
     std::vector<int> children;
     Material material;
+    Bounds bounds;
     int parent = -1;
     int index = 0;
+    int baseVertex = 0;
+    unsigned firstIndex = 0;
     glm::vec3 translation{ 0 }, rotation{ 0 }, scaling{ 1 };
 };
 
@@ -55,18 +126,28 @@ class Model
 public:
     Model(const std::filesystem::path& file_path);
     ~Model();
-    void InitBuffers(int largest_index) noexcept;
+    void InitBuffers() noexcept;
     void Clear() noexcept;
-    void Draw(Primitive primitive, ShaderProgram* program) noexcept;
+    void Draw(Primitive primitive, ShaderProgram* program, unsigned first_instance = 0, unsigned instance_count = 1) noexcept;
+    // Draws the visible instances of the meshes sharing the textures of material
+    // The VAO of the stream is bound and the material sent by the caller
+    void DrawMeshes(Primitive primitive, const InstanceRange* mesh_ranges, const Material& material) const noexcept;
+    // Draws commands of the bound GL_DRAW_INDIRECT_BUFFER, the count is read at count_offset of GL_PARAMETER_BUFFER
+    void DrawIndirect(Primitive primitive, std::size_t first_command, std::size_t count_offset, unsigned max_draw_count) const noexcept;
+    [[nodiscard]] unsigned GetVao(VertexStream stream) const noexcept;
 
     std::string m_name{};
     int m_root = -1;
     std::vector<Mesh> m_meshes;
+    Bounds m_bounds;
     const unsigned m_tag = 0;
     const std::filesystem::path m_path;
 private:
-    void Draw(Primitive primitive, ShaderProgram* program, int index, glm::mat4 transform) const noexcept;
-    unsigned m_vao = 0, m_vbo = 0;
+    // Finest LOD of every mesh for object_range, constants are sent as uniforms
+    void Draw(Primitive primitive, ShaderProgram* program, int index, const InstanceRange& object_range) const noexcept;
+    unsigned m_vao = 0, m_vbo = 0, m_ibo = 0;
+    // Positions only, shares the index buffer
+    unsigned m_positionVao = 0, m_positionVbo = 0;
 };
 
 class FBXImporter
@@ -78,10 +159,10 @@ private:
 	static Model* Parse(FbxNode* p_root) noexcept;
 	static int ParseNode(FbxNode* p_node, int parent, std::vector<Mesh>& meshes) noexcept;
 	static std::vector<Vertex> GetVertices(FbxMesh* p_mesh) noexcept;
+	static std::vector<unsigned> WeldVertices(std::vector<Vertex>& vertices) noexcept;
+	static void BuildLods(Mesh& mesh) noexcept;
     static void SetRange(float x, float y, float z) noexcept;
     static std::filesystem::path s_path;
-    static std::size_t s_m_verticesCount;
-    static int s_m_meshIndex;
     static glm::vec3 min, max;
     static glm::vec4 sum;
     static glm::mat4 globalTransform;
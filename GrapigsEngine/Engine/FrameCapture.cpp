@@ -0,0 +1,98 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: FrameCapture.cpp
+ *	Desc		: Screenshots and image sequences of the scene FBO written in the background
+ */
+#include "FrameCapture.h"
+
+#include <cstdio>	// std::snprintf
+
+#include "CPUProfiler.h"	// PROFILE_FUNCTION
+#include "Shader.h"			// FrameBufferObject
+
+FrameCapture::FrameCapture() noexcept = default;
+
+FrameCapture::~FrameCapture() noexcept
+{
+	Flush();
+}
+
+void FrameCapture::Screenshot(const std::filesystem::path& path) noexcept
+{
+	m_screenshot = path;
+}
+
+void FrameCapture::StartSequence(const std::filesystem::path& folder, const std::string& extension) noexcept
+{
+	m_folder = folder;
+	m_extension = extension;
+	m_sequenceIndex = 0;
+	m_isRecording = true;
+}
+
+void FrameCapture::StopSequence() noexcept
+{
+	m_isRecording = false;
+}
+
+bool FrameCapture::IsRecording() const noexcept
+{
+	return m_isRecording;
+}
+
+void FrameCapture::Update(const FrameBufferObject& fbo) noexcept
+{
+	PROFILE_FUNCTION();
+	m_readback.Poll();
+	if (m_screenshot.empty() == false)
+	{
+		Request(fbo, m_screenshot);
+		m_screenshot.clear();
+	}
+	if (m_isRecording == false)
+		return;
+
+	char name[32];
+	std::snprintf(name, sizeof(name), "frame_%05d", static_cast<int>(m_sequenceIndex++));
+	// A slow disk costs frames of the sequence, never frame time
+	if (m_readback.Pending() + (m_p_writer ? m_p_writer->Queued() : 0) >= s_maxQueued)
+	{
+		++m_dropped;
+		return;
+	}
+	Request(fbo, m_folder / (std::string(name) + m_extension));
+}
+
+void FrameCapture::Request(const FrameBufferObject& fbo, std::filesystem::path path) noexcept
+{
+	if (m_p_writer == nullptr)
+		m_p_writer = std::make_unique<ImageWriter>();
+	// EXR keeps the half-float scene colour, PNG takes it clamped to 8 bits
+	const PixelFormat format = path.extension() == ".exr" ? PixelFormat::RGBA16F : PixelFormat::RGBA8;
+	m_readback.Request(fbo.GetTexture(), fbo.Width(), fbo.Height(), format,
+		[p_writer = m_p_writer.get(), path = std::move(path)](CapturedImage&& image) mutable { p_writer->Write(std::move(path), std::move(image)); });
+	++m_captured;
+}
+
+void FrameCapture::Flush() noexcept
+{
+	if (m_readback.Pending() > 0)
+		m_readback.Flush();
+	if (m_p_writer)
+		m_p_writer->Finish();
+}
+
+FrameCaptureStats FrameCapture::GetStats() const noexcept
+{
+	FrameCaptureStats stats;
+	stats.captured = m_captured;
+	stats.dropped = m_dropped;
+	if (m_p_writer)
+	{
+		stats.written = m_p_writer->Written();
+		stats.queued = m_p_writer->Queued();
+	}
+	stats.queued += m_readback.Pending();
+	return stats;
+}
@@ -0,0 +1,53 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: FrameCapture.h
+ *	Desc		: Screenshots and image sequences of the scene FBO written in the background
+ */
+#pragma once
+#include <filesystem>	// std::filesystem::path
+#include <memory>		// std::unique_ptr
+#include <string>		// std::string
+
+#include "FrameReadback.h"	// FrameReadback
+
+class FrameBufferObject;
+
+struct FrameCaptureStats
+{
+	std::size_t captured = 0, written = 0, dropped = 0, queued = 0;
+};
+
+class FrameCapture
+{
+public:
+	// Sequence frames are skipped rather than stalling the frame once this many images wait
+	static constexpr std::size_t s_maxQueued = 16;
+
+	FrameCapture() noexcept;
+	~FrameCapture() noexcept;
+
+	// The next frame is written to path, .png or .exr
+	void Screenshot(const std::filesystem::path& path) noexcept;
+	// Every frame is written to folder as frame_00000.<extension> until stopped
+	void StartSequence(const std::filesystem::path& folder, const std::string& extension = ".png") noexcept;
+	void StopSequence() noexcept;
+	[[nodiscard]] bool IsRecording() const noexcept;
+
+	// Called once a frame after the scene is drawn into fbo
+	void Update(const FrameBufferObject& fbo) noexcept;
+	// Waits until every requested image is on disk
+	void Flush() noexcept;
+	[[nodiscard]] FrameCaptureStats GetStats() const noexcept;
+private:
+	void Request(const FrameBufferObject& fbo, std::filesystem::path path) noexcept;
+
+	FrameReadback m_readback;
+	// Started on the first capture
+	std::unique_ptr<ImageWriter> m_p_writer;
+	std::filesystem::path m_screenshot, m_folder;
+	std::string m_extension = ".png";
+	bool m_isRecording = false;
+	std::size_t m_sequenceIndex = 0;
+	std::size_t m_captured = 0, m_dropped = 0;
+};
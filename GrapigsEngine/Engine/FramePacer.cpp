@@ -0,0 +1,203 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: FramePacer.cpp
+ *	Desc		: Present modes, frame rate cap and frame time statistics
+ */
+#include "FramePacer.h"
+
+#include <algorithm>	// std::nth_element
+#include <chrono>		// std::chrono
+#include <gl/glew.h>	// glFinish
+#include <GLFW/glfw3.h>	// glfwSwapInterval
+#include <iostream>		// std::cout
+#include <thread>		// std::this_thread
+
+#include "CPUProfiler.h"	// PROFILE_FUNCTION
+
+/* FrameHistogram - start -----------------------------------------------------------------------*/
+
+void FrameHistogram::Add(double milliseconds) noexcept
+{
+	m_samples[m_head] = milliseconds;
+	m_head = (m_head + 1) % s_capacity;
+	m_count = std::min(m_count + 1, s_capacity);
+}
+
+void FrameHistogram::Reset() noexcept
+{
+	m_head = m_count = 0;
+}
+
+double FrameHistogram::Percentile(double p) const noexcept
+{
+	if (m_count == 0)
+		return 0.0;
+	double sorted[s_capacity];
+	std::copy_n(m_samples, m_count, sorted);
+	const auto rank = static_cast<std::size_t>(std::clamp(p, 0.0, 1.0) * static_cast<double>(m_count - 1) + 0.5);
+	std::nth_element(sorted, sorted + rank, sorted + m_count);
+	return sorted[rank];
+}
+
+double FrameHistogram::Average() const noexcept
+{
+	if (m_count == 0)
+		return 0.0;
+	double sum = 0.0;
+	for (std::size_t i = 0; i < m_count; ++i)
+		sum += m_samples[i];
+	return sum / static_cast<double>(m_count);
+}
+
+std::size_t FrameHistogram::Count() const noexcept
+{
+	return m_count;
+}
+
+void FrameHistogram::Bins(float* p_bins, std::size_t bin_count, double max_milliseconds) const noexcept
+{
+	if (p_bins == nullptr || bin_count == 0)
+		return;
+	std::fill_n(p_bins, bin_count, 0.f);
+	const double scale = max_milliseconds > 0.0 ? static_cast<double>(bin_count) / max_milliseconds : 0.0;
+	for (std::size_t i = 0; i < m_count; ++i)
+	{
+		const auto bin = static_cast<std::size_t>(std::max(m_samples[i] * scale, 0.0));
+		p_bins[std::min(bin, bin_count - 1)] += 1.f;
+	}
+}
+
+/* FrameHistogram - end -------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
+/* FramePacer - start ---------------------------------------------------------------------------*/
+
+bool FramePacer::s_m_isLowLatency = false;
+PresentMode FramePacer::s_m_mode = PresentMode::VSync;
+double FramePacer::s_m_targetFps = 120.0;
+double FramePacer::s_m_refreshRate = 60.0;
+double FramePacer::s_m_slot = 0.0;
+double FramePacer::s_m_lastBegin = 0.0;
+double FramePacer::s_m_workBegin = 0.0;
+FrameHistogram FramePacer::s_m_frameTimes;
+FrameHistogram FramePacer::s_m_workTimes;
+
+namespace
+{
+	// Sleeping wakes up late by up to the timer resolution, the rest of the wait spins
+	constexpr double s_spinMargin = 0.002;
+	// Slack kept before the present when polling late
+	constexpr double s_latencyMargin = 0.001;
+
+	double Now() noexcept
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+void FramePacer::SetPresentMode(PresentMode mode) noexcept
+{
+	int interval = 0;
+	if (mode == PresentMode::VSync)
+		interval = 1;
+	else if (mode == PresentMode::AdaptiveVSync)
+	{
+		// A late frame is presented at once instead of waiting for the next vertical blank
+		if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+			interval = -1;
+		else
+		{
+			std::cout << "[FramePacer]: Adaptive v-sync is not supported, using v-sync" << std::endl;
+			mode = PresentMode::VSync;
+			interval = 1;
+		}
+	}
+	glfwSwapInterval(interval);
+	if (const GLFWvidmode* p_mode = glfwGetVideoMode(glfwGetPrimaryMonitor()); p_mode && p_mode->refreshRate > 0)
+		s_m_refreshRate = static_cast<double>(p_mode->refreshRate);
+	s_m_mode = mode;
+	s_m_slot = 0.0;
+	s_m_frameTimes.Reset();
+	s_m_workTimes.Reset();
+}
+
+PresentMode FramePacer::GetPresentMode() noexcept
+{
+	return s_m_mode;
+}
+
+void FramePacer::SetTargetFps(double fps) noexcept
+{
+	s_m_targetFps = std::max(fps, 1.0);
+	s_m_slot = 0.0;
+}
+
+double FramePacer::GetTargetFps() noexcept
+{
+	return s_m_targetFps;
+}
+
+double FramePacer::Period() noexcept
+{
+	if (s_m_mode == PresentMode::Capped)
+		return 1.0 / s_m_targetFps;
+	// V-sync paces by itself, the period only places the late poll
+	if (s_m_isLowLatency && s_m_mode != PresentMode::Uncapped)
+		return 1.0 / s_m_refreshRate;
+	return 0.0;
+}
+
+void FramePacer::WaitUntil(double seconds) noexcept
+{
+	PROFILE_FUNCTION();
+	double remaining = seconds - Now();
+	if (remaining > s_spinMargin)
+		std::this_thread::sleep_for(std::chrono::duration<double>(remaining - s_spinMargin));
+	while (Now() < seconds)
+		std::this_thread::yield();
+}
+
+void FramePacer::BeginFrame() noexcept
+{
+	const double period = Period();
+	double delay = 0.0;
+	if (period > 0.0 && s_m_slot > 0.0)
+	{
+		// The frame starts as late as the recent work times allow
+		if (s_m_isLowLatency)
+			delay = std::max(period - s_m_workTimes.Percentile(0.9) * 1e-3 - s_latencyMargin, 0.0);
+		WaitUntil(s_m_slot + delay);
+	}
+
+	const double now = Now();
+	if (s_m_lastBegin > 0.0)
+		s_m_frameTimes.Add((now - s_m_lastBegin) * 1e3);
+	s_m_lastBegin = s_m_workBegin = now;
+	// A late frame moves the schedule rather than rushing the next frames to catch up
+	if (s_m_mode == PresentMode::Capped)
+		s_m_slot = std::max(s_m_slot + period, now - delay + period);
+}
+
+void FramePacer::EndFrame() noexcept
+{
+	// Waiting for the flip keeps the driver from queuing frames, the next slot starts at the vertical blank
+	s_m_workTimes.Add((Now() - s_m_workBegin) * 1e3);
+	if (s_m_isLowLatency && (s_m_mode == PresentMode::VSync || s_m_mode == PresentMode::AdaptiveVSync))
+	{
+		glFinish();
+		s_m_slot = Now();
+	}
+}
+
+const FrameHistogram& FramePacer::GetFrameTimes() noexcept
+{
+	return s_m_frameTimes;
+}
+
+const FrameHistogram& FramePacer::GetWorkTimes() noexcept
+{
+	return s_m_workTimes;
+}
+
+/* FramePacer - end -----------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
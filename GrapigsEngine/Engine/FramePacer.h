@@ -0,0 +1,58 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: FramePacer.h
+ *	Desc		: Present modes, frame rate cap and frame time statistics
+ */
+#pragma once
+#include <cstddef>	// std::size_t
+
+enum class PresentMode { VSync, AdaptiveVSync, Uncapped, Capped };
+
+// Durations of the most recent frames in milliseconds
+class FrameHistogram
+{
+public:
+	static constexpr std::size_t s_capacity = 1024;
+
+	void Add(double milliseconds) noexcept;
+	void Reset() noexcept;
+	// p in [0, 1], 0.5 is the median
+	[[nodiscard]] double Percentile(double p) const noexcept;
+	[[nodiscard]] double Average() const noexcept;
+	[[nodiscard]] std::size_t Count() const noexcept;
+	// Frames per bin over [0, max_milliseconds], longer frames land in the last bin
+	void Bins(float* p_bins, std::size_t bin_count, double max_milliseconds) const noexcept;
+private:
+	double m_samples[s_capacity]{};
+	std::size_t m_head = 0, m_count = 0;
+};
+
+// Application calls BeginFrame before polling input and EndFrame after presenting
+class FramePacer
+{
+public:
+	static void SetPresentMode(PresentMode mode) noexcept;
+	[[nodiscard]] static PresentMode GetPresentMode() noexcept;
+	static void SetTargetFps(double fps) noexcept;
+	[[nodiscard]] static double GetTargetFps() noexcept;
+
+	static void BeginFrame() noexcept;
+	static void EndFrame() noexcept;
+
+	// Time between the starts of two frames
+	[[nodiscard]] static const FrameHistogram& GetFrameTimes() noexcept;
+	// Time from polling input to presenting, without the wait
+	[[nodiscard]] static const FrameHistogram& GetWorkTimes() noexcept;
+
+	// Delays polling input until just enough time is left to render before the next present
+	static bool s_m_isLowLatency;
+private:
+	[[nodiscard]] static double Period() noexcept;
+	static void WaitUntil(double seconds) noexcept;
+
+	static PresentMode s_m_mode;
+	static double s_m_targetFps, s_m_refreshRate;
+	static double s_m_slot, s_m_lastBegin, s_m_workBegin;
+	static FrameHistogram s_m_frameTimes, s_m_workTimes;
+};
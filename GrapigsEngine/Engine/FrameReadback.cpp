@@ -0,0 +1,125 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: FrameReadback.cpp
+ *	Desc		: Texture copies into pixel buffers read once their fence signals
+ */
+#include "FrameReadback.h"
+
+#include <algorithm>	// std::min
+#include <cstring>		// std::memcpy
+#include <gl/glew.h>	// gl functions
+
+#include "GLState.h"	// GLState
+
+FrameReadback::FrameReadback(std::size_t latency) noexcept
+	: m_latency(std::min(latency, s_slotCount - 1))
+{
+}
+
+FrameReadback::~FrameReadback() noexcept
+{
+	for (Slot& slot : m_slots)
+	{
+		if (slot.fence)
+			glDeleteSync(static_cast<GLsync>(slot.fence));
+		if (slot.buffer)
+			GLState::DeleteBuffers(1, &slot.buffer);
+	}
+}
+
+void FrameReadback::Request(unsigned texture, int width, int height, PixelFormat format, Callback callback) noexcept
+{
+	if (texture == 0 || width <= 0 || height <= 0)
+		return;
+	if (m_count == s_slotCount)
+	{
+		Slot& oldest = m_slots[m_head];
+		glClientWaitSync(static_cast<GLsync>(oldest.fence), GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		Complete(oldest);
+	}
+
+	Slot& slot = m_slots[(m_head + m_count) % s_slotCount];
+	const bool is_half = format == PixelFormat::RGBA16F;
+	const std::size_t size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * (is_half ? 8 : 4);
+	if (slot.capacity < size)
+	{
+		if (slot.buffer)
+			GLState::DeleteBuffers(1, &slot.buffer);
+		glCreateBuffers(1, &slot.buffer);
+		glNamedBufferStorage(slot.buffer, static_cast<GLsizeiptr>(size), nullptr, GL_MAP_READ_BIT | GL_CLIENT_STORAGE_BIT);
+		slot.capacity = size;
+	}
+
+	// The copy lands in the buffer bound to GL_PIXEL_PACK_BUFFER, the call returns at once
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glGetTextureImage(texture, 0, GL_RGBA, is_half ? GL_HALF_FLOAT : GL_UNSIGNED_BYTE, static_cast<GLsizei>(size), nullptr);
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.width = width;
+	slot.height = height;
+	slot.format = format;
+	slot.frame = m_frame;
+	slot.callback = std::move(callback);
+	++m_count;
+}
+
+std::size_t FrameReadback::Poll() noexcept
+{
+	++m_frame;
+	std::size_t completed = 0;
+	while (m_count > 0)
+	{
+		Slot& oldest = m_slots[m_head];
+		if (oldest.frame + m_latency > m_frame)
+			break;
+		const GLenum status = glClientWaitSync(static_cast<GLsync>(oldest.fence), GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
+		Complete(oldest);
+		++completed;
+	}
+	return completed;
+}
+
+void FrameReadback::Flush() noexcept
+{
+	while (m_count > 0)
+	{
+		Slot& oldest = m_slots[m_head];
+		glClientWaitSync(static_cast<GLsync>(oldest.fence), GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		Complete(oldest);
+	}
+}
+
+std::size_t FrameReadback::Pending() const noexcept
+{
+	return m_count;
+}
+
+void FrameReadback::Complete(Slot& slot) noexcept
+{
+	glDeleteSync(static_cast<GLsync>(slot.fence));
+	slot.fence = nullptr;
+
+	CapturedImage image;
+	image.width = slot.width;
+	image.height = slot.height;
+	image.channels = 4;
+	image.format = slot.format;
+	const std::size_t size = static_cast<std::size_t>(slot.width) * static_cast<std::size_t>(slot.height) * image.PixelSize();
+	image.pixels.resize(size);
+	if (const void* p_data = glMapNamedBufferRange(slot.buffer, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT))
+	{
+		std::memcpy(image.pixels.data(), p_data, size);
+		glUnmapNamedBuffer(slot.buffer);
+	}
+
+	Callback callback = std::move(slot.callback);
+	slot.callback = nullptr;
+	m_head = (m_head + 1) % s_slotCount;
+	--m_count;
+	if (callback)
+		callback(std::move(image));
+}
@@ -0,0 +1,50 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: FrameReadback.h
+ *	Desc		: Texture copies into pixel buffers read once their fence signals
+ */
+#pragma once
+#include <functional>	// std::function
+
+#include "ImageWriter.h"	// CapturedImage
+
+// A copy is mapped a few frames after it was queued, by then the GPU has long finished it
+class FrameReadback
+{
+public:
+	static constexpr std::size_t s_slotCount = 8;
+	using Callback = std::function<void(CapturedImage&&)>;
+
+	explicit FrameReadback(std::size_t latency = 2) noexcept;
+	~FrameReadback() noexcept;
+	FrameReadback(const FrameReadback&) = delete;
+	FrameReadback& operator=(const FrameReadback&) = delete;
+
+	// Queues a copy of level 0, waits only when every slot is still in flight
+	void Request(unsigned texture, int width, int height, PixelFormat format, Callback callback) noexcept;
+	// Called once a frame, hands copies queued at least latency frames ago to their callbacks in request order
+	// A copy whose fence has not signalled yet is left for a later frame, it never waits
+	std::size_t Poll() noexcept;
+	// Waits for every copy in flight
+	void Flush() noexcept;
+	[[nodiscard]] std::size_t Pending() const noexcept;
+private:
+	struct Slot
+	{
+		unsigned buffer = 0;
+		std::size_t capacity = 0;
+		void* fence = nullptr;
+		int width = 0, height = 0;
+		PixelFormat format = PixelFormat::RGBA8;
+		std::size_t frame = 0;
+		Callback callback;
+	};
+
+	// Maps the oldest slot and hands it to its callback
+	void Complete(Slot& slot) noexcept;
+
+	Slot m_slots[s_slotCount];
+	std::size_t m_head = 0, m_count = 0;
+	std::size_t m_latency = 2, m_frame = 0;
+};
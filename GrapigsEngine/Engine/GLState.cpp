@@ -0,0 +1,298 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: GLState.cpp
+ *	Desc		: Shadow copy of the bound GL state that skips calls setting what is already set
+ */
+#include "GLState.h"
+
+unsigned GLState::s_m_program = GLState::s_unknown;
+unsigned GLState::s_m_vao = GLState::s_unknown;
+unsigned GLState::s_m_fbo = GLState::s_unknown;
+unsigned GLState::s_m_buffers[GLState::s_bufferTargets]{};
+GLState::BufferRange GLState::s_m_indexed[GLState::s_indexedTargets][GLState::s_maxBufferBindings]{};
+unsigned GLState::s_m_textures[GLState::s_maxTextureUnits]{};
+unsigned GLState::s_m_capabilities[GLState::s_capabilities]{};
+unsigned GLState::s_m_depthFunc = GLState::s_unknown;
+unsigned GLState::s_m_depthMask = GLState::s_unknown;
+unsigned GLState::s_m_blendSource = GLState::s_unknown;
+unsigned GLState::s_m_blendDestination = GLState::s_unknown;
+GLStateStats GLState::s_m_frame{};
+GLStateStats GLState::s_m_stats{};
+
+namespace
+{
+	// The tables start out unknown, the first call of every kind reaches the driver
+	const bool s_isInvalidated = []
+	{
+		GLState::Invalidate();
+		return true;
+	}();
+}
+
+/* Binding - start ------------------------------------------------------------------------------*/
+
+void GLState::UseProgram(unsigned program) noexcept
+{
+	if (Set(s_m_program, program))
+		glUseProgram(program);
+}
+
+void GLState::BindVertexArray(unsigned vao) noexcept
+{
+	if (Set(s_m_vao, vao))
+		glBindVertexArray(vao);
+}
+
+void GLState::BindFramebuffer(unsigned fbo) noexcept
+{
+	if (Set(s_m_fbo, fbo))
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+}
+
+void GLState::BindBuffer(GLenum target, unsigned buffer) noexcept
+{
+	const int slot = BufferSlot(target);
+	if (slot < 0)
+	{
+		++s_m_frame.calls;
+		glBindBuffer(target, buffer);
+		return;
+	}
+	if (Set(s_m_buffers[slot], buffer))
+		glBindBuffer(target, buffer);
+}
+
+void GLState::BindBufferBase(GLenum target, unsigned index, unsigned buffer) noexcept
+{
+	BindBufferRange(target, index, buffer, 0, -1);
+}
+
+void GLState::BindBufferRange(GLenum target, unsigned index, unsigned buffer, GLintptr offset, GLsizeiptr size) noexcept
+{
+	const int slot = IndexedSlot(target);
+	if (slot >= 0 && index < s_maxBufferBindings)
+	{
+		BufferRange& range = s_m_indexed[slot][index];
+		if (range.buffer == buffer && range.offset == offset && range.size == size)
+		{
+			++s_m_frame.elided;
+			return;
+		}
+		range = BufferRange{ buffer, offset, size };
+	}
+
+	// Indexed binds also replace the generic binding of the target
+	++s_m_frame.calls;
+	if (const int generic = BufferSlot(target); generic >= 0)
+		s_m_buffers[generic] = buffer;
+	if (size < 0)
+		glBindBufferBase(target, index, buffer);
+	else
+		glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void GLState::BindTextureUnit(unsigned unit, unsigned texture) noexcept
+{
+	if (unit >= s_maxTextureUnits)
+	{
+		++s_m_frame.calls;
+		glBindTextureUnit(unit, texture);
+		return;
+	}
+	if (Set(s_m_textures[unit], texture))
+		glBindTextureUnit(unit, texture);
+}
+
+void GLState::BindTexture(GLenum target, unsigned texture) noexcept
+{
+	++s_m_frame.calls;
+	GLint active = GL_TEXTURE0;
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+	const auto unit = static_cast<unsigned>(active - GL_TEXTURE0);
+	if (unit < s_maxTextureUnits)
+		s_m_textures[unit] = s_unknown;
+	glBindTexture(target, texture);
+}
+
+/* Binding - end --------------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
+/* Fixed function - start -----------------------------------------------------------------------*/
+
+void GLState::SetCapability(GLenum capability, bool is_enabled) noexcept
+{
+	const int slot = CapabilitySlot(capability);
+	if (slot >= 0 && Set(s_m_capabilities[slot], is_enabled ? 1u : 0u) == false)
+		return;
+	if (slot < 0)
+		++s_m_frame.calls;
+	if (is_enabled)
+		glEnable(capability);
+	else
+		glDisable(capability);
+}
+
+void GLState::DepthFunc(GLenum func) noexcept
+{
+	if (Set(s_m_depthFunc, func))
+		glDepthFunc(func);
+}
+
+void GLState::DepthMask(bool is_writing) noexcept
+{
+	if (Set(s_m_depthMask, is_writing ? 1u : 0u))
+		glDepthMask(is_writing ? GL_TRUE : GL_FALSE);
+}
+
+void GLState::BlendFunc(GLenum source, GLenum destination) noexcept
+{
+	if (s_m_blendSource == source && s_m_blendDestination == destination)
+	{
+		++s_m_frame.elided;
+		return;
+	}
+	++s_m_frame.calls;
+	s_m_blendSource = source;
+	s_m_blendDestination = destination;
+	glBlendFunc(source, destination);
+}
+
+/* Fixed function - end -------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
+/* Deletion - start -----------------------------------------------------------------------------*/
+
+void GLState::DeleteProgram(unsigned program) noexcept
+{
+	if (program && s_m_program == program)
+		s_m_program = s_unknown;
+	glDeleteProgram(program);
+}
+
+void GLState::DeleteVertexArrays(int count, const unsigned* p_vaos) noexcept
+{
+	for (int i = 0; i < count; ++i)
+		if (p_vaos[i] && s_m_vao == p_vaos[i])
+			s_m_vao = s_unknown;
+	glDeleteVertexArrays(count, p_vaos);
+}
+
+void GLState::DeleteFramebuffers(int count, const unsigned* p_fbos) noexcept
+{
+	for (int i = 0; i < count; ++i)
+		if (p_fbos[i] && s_m_fbo == p_fbos[i])
+			s_m_fbo = s_unknown;
+	glDeleteFramebuffers(count, p_fbos);
+}
+
+void GLState::DeleteBuffers(int count, const unsigned* p_buffers) noexcept
+{
+	for (int i = 0; i < count; ++i)
+	{
+		if (p_buffers[i] == 0)
+			continue;
+		for (auto& buffer : s_m_buffers)
+			if (buffer == p_buffers[i])
+				buffer = s_unknown;
+		for (auto& target : s_m_indexed)
+			for (auto& range : target)
+				if (range.buffer == p_buffers[i])
+					range.buffer = s_unknown;
+	}
+	glDeleteBuffers(count, p_buffers);
+}
+
+void GLState::DeleteTextures(int count, const unsigned* p_textures) noexcept
+{
+	for (int i = 0; i < count; ++i)
+	{
+		if (p_textures[i] == 0)
+			continue;
+		for (auto& texture : s_m_textures)
+			if (texture == p_textures[i])
+				texture = s_unknown;
+	}
+	glDeleteTextures(count, p_textures);
+}
+
+/* Deletion - end -------------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
+/* Tracking - start -----------------------------------------------------------------------------*/
+
+void GLState::Invalidate() noexcept
+{
+	s_m_program = s_m_vao = s_m_fbo = s_unknown;
+	for (auto& buffer : s_m_buffers)
+		buffer = s_unknown;
+	for (auto& target : s_m_indexed)
+		for (auto& range : target)
+			range = BufferRange{ s_unknown, 0, 0 };
+	for (auto& texture : s_m_textures)
+		texture = s_unknown;
+	for (auto& capability : s_m_capabilities)
+		capability = s_unknown;
+	s_m_depthFunc = s_m_depthMask = s_m_blendSource = s_m_blendDestination = s_unknown;
+}
+
+void GLState::EndFrame() noexcept
+{
+	s_m_stats = s_m_frame;
+	s_m_frame = GLStateStats{};
+}
+
+const GLStateStats& GLState::GetStats() noexcept
+{
+	return s_m_stats;
+}
+
+int GLState::BufferSlot(GLenum target) noexcept
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER: return 0;
+	case GL_DRAW_INDIRECT_BUFFER: return 1;
+	case GL_PARAMETER_BUFFER: return 2;
+	case GL_DISPATCH_INDIRECT_BUFFER: return 3;
+	case GL_SHADER_STORAGE_BUFFER: return 4;
+	case GL_UNIFORM_BUFFER: return 5;
+	case GL_PIXEL_PACK_BUFFER: return 6;
+	case GL_PIXEL_UNPACK_BUFFER: return 7;
+	default: return -1;
+	}
+}
+
+int GLState::IndexedSlot(GLenum target) noexcept
+{
+	switch (target)
+	{
+	case GL_SHADER_STORAGE_BUFFER: return 0;
+	case GL_UNIFORM_BUFFER: return 1;
+	default: return -1;
+	}
+}
+
+int GLState::CapabilitySlot(GLenum capability) noexcept
+{
+	switch (capability)
+	{
+	case GL_BLEND: return 0;
+	case GL_DEPTH_TEST: return 1;
+	case GL_CULL_FACE: return 2;
+	case GL_SCISSOR_TEST: return 3;
+	case GL_POLYGON_OFFSET_FILL: return 4;
+	default: return -1;
+	}
+}
+
+bool GLState::Set(unsigned& current, unsigned value) noexcept
+{
+	if (current == value)
+	{
+		++s_m_frame.elided;
+		return false;
+	}
+	++s_m_frame.calls;
+	current = value;
+	return true;
+}
+
+/* Tracking - end -------------------------------------------------------------------------------*/
@@ -0,0 +1,76 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: GLState.h
+ *	Desc		: Shadow copy of the bound GL state that skips calls setting what is already set
+ */
+#pragma once
+#include <cstddef>		// std::size_t
+#include <gl/glew.h>	// GLenum, GLintptr, GLsizeiptr
+
+struct GLStateStats
+{
+	std::size_t calls = 0;	// calls passed to the driver
+	std::size_t elided = 0;	// calls skipped because they changed nothing
+};
+
+// Engine code binds through this class, everything else has to call Invalidate after changing state
+// Objects are deleted through it as well, a new object may get the name of a deleted one
+class GLState
+{
+public:
+	static constexpr unsigned s_maxTextureUnits = 64;
+	static constexpr unsigned s_maxBufferBindings = 32;
+
+	static void UseProgram(unsigned program) noexcept;
+	static void BindVertexArray(unsigned vao) noexcept;
+	static void BindFramebuffer(unsigned fbo) noexcept;
+	static void BindBuffer(GLenum target, unsigned buffer) noexcept;
+	static void BindBufferBase(GLenum target, unsigned index, unsigned buffer) noexcept;
+	static void BindBufferRange(GLenum target, unsigned index, unsigned buffer, GLintptr offset, GLsizeiptr size) noexcept;
+	static void BindTextureUnit(unsigned unit, unsigned texture) noexcept;
+	// Binds to the active unit for non-DSA uploads, the unit is not known afterwards
+	static void BindTexture(GLenum target, unsigned texture) noexcept;
+
+	static void SetCapability(GLenum capability, bool is_enabled) noexcept;
+	static void DepthFunc(GLenum func) noexcept;
+	static void DepthMask(bool is_writing) noexcept;
+	static void BlendFunc(GLenum source, GLenum destination) noexcept;
+
+	static void DeleteProgram(unsigned program) noexcept;
+	static void DeleteVertexArrays(int count, const unsigned* p_vaos) noexcept;
+	static void DeleteFramebuffers(int count, const unsigned* p_fbos) noexcept;
+	static void DeleteBuffers(int count, const unsigned* p_buffers) noexcept;
+	static void DeleteTextures(int count, const unsigned* p_textures) noexcept;
+
+	// Forgets the whole state, the next call of every kind reaches the driver
+	static void Invalidate() noexcept;
+	// Counters of the finished frame become the ones returned by GetStats
+	static void EndFrame() noexcept;
+	[[nodiscard]] static const GLStateStats& GetStats() noexcept;
+private:
+	struct BufferRange
+	{
+		unsigned buffer;
+		GLintptr offset;
+		GLsizeiptr size;	// -1 for the whole buffer
+	};
+
+	// Slot of a tracked target, or -1 for a target passed straight to the driver
+	[[nodiscard]] static int BufferSlot(GLenum target) noexcept;
+	[[nodiscard]] static int IndexedSlot(GLenum target) noexcept;
+	[[nodiscard]] static int CapabilitySlot(GLenum capability) noexcept;
+	// Counts the call and returns true when it has to be made
+	static bool Set(unsigned& current, unsigned value) noexcept;
+
+	static constexpr unsigned s_unknown = 0xFFFFFFFF;
+	static constexpr int s_bufferTargets = 8, s_indexedTargets = 2, s_capabilities = 5;
+
+	static unsigned s_m_program, s_m_vao, s_m_fbo;
+	static unsigned s_m_buffers[s_bufferTargets];
+	static BufferRange s_m_indexed[s_indexedTargets][s_maxBufferBindings];
+	static unsigned s_m_textures[s_maxTextureUnits];
+	static unsigned s_m_capabilities[s_capabilities];
+	static unsigned s_m_depthFunc, s_m_depthMask, s_m_blendSource, s_m_blendDestination;
+	static GLStateStats s_m_frame, s_m_stats;
+};
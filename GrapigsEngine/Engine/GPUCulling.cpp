@@ -0,0 +1,221 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: GPUCulling.cpp
+ *	Desc		: Cull instances in a compute shader and draw them with indirect commands
+ */
+#include "GPUCulling.h"
+
+#include <gl/glew.h>	// gl functions
+
+#include "GLState.h"	// GLState
+#include "World.h"	// World, InstanceBuffer
+
+namespace
+{
+	constexpr unsigned s_groupSize = 64;	// local_size_x of cull.comp and compact.comp
+
+	void Reserve(unsigned handle, std::size_t& capacity, std::size_t count, std::size_t stride) noexcept
+	{
+		count = std::max<std::size_t>(count, 1);
+		if (count <= capacity)
+			return;
+		capacity = std::max(count, capacity * 2);
+		glNamedBufferData(handle, static_cast<GLsizeiptr>(stride * capacity), nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	unsigned GroupCount(std::size_t count) noexcept
+	{
+		return static_cast<unsigned>((count + s_groupSize - 1) / s_groupSize);
+	}
+}
+
+GPUCulling::GPUCulling() noexcept
+{
+	const std::vector<std::pair<ShaderType, std::filesystem::path>> cull_files = {
+		std::make_pair(ShaderType::Compute, "shader/cull.comp")
+	};
+	m_cull = new ShaderProgram(cull_files);
+	m_cull->m_name = "cull";
+
+	const std::vector<std::pair<ShaderType, std::filesystem::path>> compact_files = {
+		std::make_pair(ShaderType::Compute, "shader/compact.comp")
+	};
+	m_compact = new ShaderProgram(compact_files);
+	m_compact->m_name = "compact";
+
+	const std::vector<std::pair<ShaderType, std::filesystem::path>> cluster_files = {
+		std::make_pair(ShaderType::Compute, "shader/cluster.comp")
+	};
+	m_cluster = new ShaderProgram(cluster_files);
+	m_cluster->m_name = "cluster";
+
+	glCreateBuffers(1, &m_commandBuffer);
+	glCreateBuffers(1, &m_drawBuffer);
+	glCreateBuffers(1, &m_parameterBuffer);
+	glCreateBuffers(1, &m_meshletBuffer);
+	glCreateBuffers(1, &m_workBuffer);
+	glCreateBuffers(1, &m_dispatchBuffer);
+	glNamedBufferData(m_dispatchBuffer, sizeof(unsigned) * 3, nullptr, GL_DYNAMIC_DRAW);
+	GLint max_work_groups = 0;
+	glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 0, &max_work_groups);
+	if (max_work_groups > 0)
+		m_maxClusterWork = static_cast<unsigned>(max_work_groups);
+}
+
+GPUCulling::~GPUCulling() noexcept
+{
+	delete m_cull;
+	delete m_compact;
+	delete m_cluster;
+	m_cull = m_compact = m_cluster = nullptr;
+	GLState::DeleteBuffers(1, &m_commandBuffer);
+	GLState::DeleteBuffers(1, &m_drawBuffer);
+	GLState::DeleteBuffers(1, &m_parameterBuffer);
+	GLState::DeleteBuffers(1, &m_meshletBuffer);
+	GLState::DeleteBuffers(1, &m_workBuffer);
+	GLState::DeleteBuffers(1, &m_dispatchBuffer);
+	m_commandBuffer = m_drawBuffer = m_parameterBuffer = 0;
+	m_meshletBuffer = m_workBuffer = m_dispatchBuffer = 0;
+}
+
+void GPUCulling::Cull(const World& world, InstanceBuffer& instances, const LodSelection& lod_selection, bool is_shadow) noexcept
+{
+	const auto& batches = world.GetBatches();
+	const auto& mesh_draws = world.GetMeshDraws();
+	const auto& groups = world.GetDrawGroups();
+	if (batches.empty())
+		return;
+
+	// One command per (mesh draw, LOD) with room for every instance of its batch, the GPU fills instanceCount
+	m_commands.assign(mesh_draws.size() * Mesh::s_maxLods, DrawCommand{});
+	unsigned visible_count = 0;
+	for (const auto& batch : batches)
+	{
+		const auto& meshes = batch.p_model->m_meshes;
+		for (std::size_t m = 0; m < meshes.size(); ++m)
+		{
+			for (std::size_t lod = 0; lod < meshes[m].lods.size(); ++lod)
+			{
+				const MeshLod& mesh_lod = meshes[m].lods[lod];
+				m_commands[(batch.firstMeshDraw + m) * Mesh::s_maxLods + lod]
+					= DrawCommand{ mesh_lod.indexCount, 0, meshes[m].firstIndex + mesh_lod.firstIndex, meshes[m].baseVertex, visible_count };
+				visible_count += batch.instanceCount;
+			}
+		}
+	}
+
+	// Meshes kept at the finest LOD are handed to the cluster pass once per instance
+	const unsigned cluster_count = world.GetClusterCount();
+	const bool is_cluster = world.m_isCulling && cluster_count > 0;
+	std::size_t work_count = 0;
+	for (const auto& batch : batches)
+		work_count += static_cast<std::size_t>(batch.instanceCount) * batch.p_model->m_meshes.size();
+
+	Reserve(m_commandBuffer, m_commandCapacity, m_commands.size(), sizeof(DrawCommand));
+	glNamedBufferSubData(m_commandBuffer, 0, static_cast<GLsizeiptr>(sizeof(DrawCommand) * m_commands.size()), m_commands.data());
+	// Cluster regions follow the group regions, slots a culled meshlet leaves behind must draw nothing
+	m_clusterDrawOffset = m_commands.size();
+	Reserve(m_drawBuffer, m_drawCapacity, m_commands.size() + cluster_count, sizeof(DrawCommand));
+	if (is_cluster)
+		glClearNamedBufferSubData(m_drawBuffer, GL_R32UI, static_cast<GLintptr>(sizeof(DrawCommand) * m_clusterDrawOffset),
+			static_cast<GLsizeiptr>(sizeof(DrawCommand) * cluster_count), GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	Reserve(m_parameterBuffer, m_parameterCapacity, groups.size() * 2, sizeof(unsigned));
+	glClearNamedBufferData(m_parameterBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	instances.ReserveVisible(visible_count + cluster_count);
+	instances.Bind();
+
+	if (is_cluster)
+	{
+		const auto& meshlets = world.GetMeshlets();
+		if (m_meshletVersion != world.GetMeshletVersion())
+		{
+			m_meshletVersion = world.GetMeshletVersion();
+			Reserve(m_meshletBuffer, m_meshletCapacity, meshlets.size(), sizeof(Meshlet));
+			glNamedBufferSubData(m_meshletBuffer, 0, static_cast<GLsizeiptr>(sizeof(Meshlet) * meshlets.size()), meshlets.data());
+		}
+		Reserve(m_workBuffer, m_workCapacity, work_count, sizeof(glm::uvec2));
+		const unsigned dispatch[3] = { 0, 1, 1 };
+		glNamedBufferSubData(m_dispatchBuffer, 0, sizeof(dispatch), dispatch);
+		GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, m_meshletBuffer);
+		GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, m_workBuffer);
+		GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, m_dispatchBuffer);
+	}
+
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, m_commandBuffer);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, m_drawBuffer);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, m_parameterBuffer);
+
+	// Cost on the CPU is one dispatch per batch, whatever the instance count
+	// Occlusion is tested against the pyramid of the previous frame, reprojected with its own matrix
+	if (world.m_isOcclusionCulling == false)
+		m_depthPyramid.Invalidate();
+	const bool is_occlusion = world.m_isCulling && m_depthPyramid.IsValid() && is_shadow == false;
+
+	m_cull->Use();
+	m_cull->SendUniform("u_isCulling", world.m_isCulling);
+	m_cull->SendUniform("u_isOcclusion", is_occlusion);
+	m_cull->SendUniform("u_lodPixelsPerUnit", world.m_isLod ? lod_selection.pixelsPerUnit : 0.f);
+	m_cull->SendUniform("u_lodEye", lod_selection.eye);
+	m_cull->SendUniform("u_lodThreshold", world.m_lodThreshold);
+	m_cull->SendUniform("u_isClusterCulling", is_cluster);
+	m_cull->SendUniform("u_maxClusterWork", static_cast<int>(m_maxClusterWork));
+	if (is_occlusion)
+		m_depthPyramid.Bind(m_cull);
+	for (const auto& batch : batches)
+	{
+		m_cull->SendUniform("u_firstInstance", static_cast<int>(batch.firstInstance));
+		m_cull->SendUniform("u_instanceCount", static_cast<int>(batch.instanceCount));
+		m_cull->SendUniform("u_firstMeshDraw", static_cast<int>(batch.firstMeshDraw));
+		m_cull->SendUniform("u_meshDrawCount", static_cast<int>(batch.p_model->m_meshes.size()));
+		m_cull->SendUniform("u_modelSphere", batch.p_model->m_bounds.GetSphere(glm::mat4{ 1 }));
+		glDispatchCompute(GroupCount(batch.instanceCount), 1, 1);
+	}
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | (is_cluster ? GL_COMMAND_BARRIER_BIT : 0));
+
+	// One workgroup per (instance, mesh) the cull pass handed over, sized on the GPU
+	if (is_cluster)
+	{
+		m_cluster->Use();
+		m_cluster->SendUniform("u_groupCount", static_cast<int>(groups.size()));
+		m_cluster->SendUniform("u_clusterVisibleBase", static_cast<int>(visible_count));
+		m_cluster->SendUniform("u_clusterDrawOffset", static_cast<int>(m_clusterDrawOffset));
+		GLState::BindBuffer(GL_DISPATCH_INDIRECT_BUFFER, m_dispatchBuffer);
+		glDispatchComputeIndirect(0);
+		GLState::BindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+
+	// Move non-empty commands into the region of their group and count them
+	m_compact->Use();
+	m_compact->SendUniform("u_commandCount", static_cast<int>(m_commands.size()));
+	glDispatchCompute(GroupCount(m_commands.size()), 1, 1);
+	m_compact->UnUse();
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GPUCulling::BuildDepthPyramid(const FrameBufferObject& fbo, const glm::mat4& world_to_ndc) noexcept
+{
+	m_depthPyramid.Build(fbo, world_to_ndc);
+}
+
+void GPUCulling::BeginDraw() const noexcept
+{
+	GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_drawBuffer);
+	GLState::BindBuffer(GL_PARAMETER_BUFFER, m_parameterBuffer);
+}
+
+void GPUCulling::DrawGroup(const World& world, const RenderBatch& batch, unsigned group, Primitive primitive) const noexcept
+{
+	const auto& groups = world.GetDrawGroups();
+	const auto& draw_group = groups[group];
+	batch.p_model->DrawIndirect(primitive, draw_group.firstCommand, sizeof(unsigned) * group, draw_group.commandCount);
+	if (draw_group.clusterCapacity > 0)
+		batch.p_model->DrawIndirect(primitive, m_clusterDrawOffset + draw_group.clusterFirst, sizeof(unsigned) * (groups.size() + group), draw_group.clusterCapacity);
+}
+
+void GPUCulling::EndDraw() const noexcept
+{
+	GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	GLState::BindBuffer(GL_PARAMETER_BUFFER, 0);
+}
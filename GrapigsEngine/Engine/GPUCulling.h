@@ -0,0 +1,50 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: GPUCulling.h
+ *	Desc		: Cull instances in a compute shader and draw them with indirect commands
+ */
+#pragma once
+#include <vector>	// std::vector
+
+#include "FBXImporter.h"	// DrawCommand, Primitive
+#include "DepthPyramid.h"	// DepthPyramid
+
+class World;
+class InstanceBuffer;
+struct RenderBatch;
+struct LodSelection;
+
+class GPUCulling
+{
+public:
+	GPUCulling() noexcept;
+	~GPUCulling() noexcept;
+	// Writes the visible entries and the compacted commands of every batch
+	// Shadow views skip the occlusion test, the depth pyramid belongs to the camera
+	void Cull(const World& world, InstanceBuffer& instances, const LodSelection& lod_selection, bool is_shadow = false) noexcept;
+	// Binds the compacted commands and their counts for DrawGroup
+	void BeginDraw() const noexcept;
+	// Draws one group of a batch, the VAO of the batch's model is bound by the caller
+	void DrawGroup(const World& world, const RenderBatch& batch, unsigned group, Primitive primitive) const noexcept;
+	void EndDraw() const noexcept;
+	// Occluders of the next frame's culling pass
+	void BuildDepthPyramid(const FrameBufferObject& fbo, const glm::mat4& world_to_ndc) noexcept;
+private:
+	ShaderProgram* m_cull = nullptr;
+	ShaderProgram* m_compact = nullptr;
+	ShaderProgram* m_cluster = nullptr;
+	// Raw commands (one per mesh draw and LOD), compacted commands (per group regions, then cluster regions)
+	// and draw counts (per group, then per cluster region)
+	unsigned m_commandBuffer = 0, m_drawBuffer = 0, m_parameterBuffer = 0;
+	std::size_t m_commandCapacity = 0, m_drawCapacity = 0, m_parameterCapacity = 0;
+	// Meshlets of the world, (instance, mesh draw) pairs handed to the cluster pass and its dispatch size
+	unsigned m_meshletBuffer = 0, m_workBuffer = 0, m_dispatchBuffer = 0;
+	std::size_t m_meshletCapacity = 0, m_workCapacity = 0;
+	unsigned m_meshletVersion = 0;
+	std::size_t m_clusterDrawOffset = 0;
+	// Workgroups one indirect dispatch may launch, at least 65535
+	unsigned m_maxClusterWork = 65535;
+	std::vector<DrawCommand> m_commands;
+	DepthPyramid m_depthPyramid;
+};
@@ -0,0 +1,229 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: GPUProfiler.cpp
+ *	Desc		: Nested GPU and CPU timings of the passes of a frame
+ */
+#include "GPUProfiler.h"
+
+#include <chrono>		// std::chrono
+#include <fstream>		// std::ofstream
+#include <gl/glew.h>	// gl functions
+#include <iostream>		// std::cout
+
+GPUProfiler::Pool GPUProfiler::s_m_pools[GPUProfiler::s_frameCount]{};
+std::vector<int> GPUProfiler::s_m_stack;
+std::vector<ProfileScope> GPUProfiler::s_m_lastFrame;
+std::deque<std::vector<ProfileScope>> GPUProfiler::s_m_history;
+std::size_t GPUProfiler::s_m_frame = 0;
+std::size_t GPUProfiler::s_m_skipped = 0;
+std::int64_t GPUProfiler::s_m_gpuOffset = 0;
+bool GPUProfiler::s_m_isInitialized = false;
+bool GPUProfiler::s_m_isRecording = false;
+bool GPUProfiler::s_m_isEnabled = true;
+bool GPUProfiler::s_m_isPaused = false;
+
+namespace
+{
+	const auto s_epoch = std::chrono::steady_clock::now();
+
+	void WriteEvent(std::ofstream& file, bool& is_first, const char* name, int tid, std::uint64_t begin, std::uint64_t end)
+	{
+		file << (is_first ? "\n" : ",\n") << "{\"name\":\"";
+		for (const char* p_c = name; *p_c; ++p_c)
+		{
+			if (*p_c == '"' || *p_c == '\\')
+				file << '\\';
+			file << *p_c;
+		}
+		file << "\",\"cat\":\"" << (tid == 1 ? "cpu" : "gpu") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+			<< ",\"ts\":" << static_cast<double>(begin) * 1e-3 << ",\"dur\":" << static_cast<double>(end - begin) * 1e-3 << "}";
+		is_first = false;
+	}
+}
+
+std::uint64_t GPUProfiler::Now() noexcept
+{
+	return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_epoch).count());
+}
+
+void GPUProfiler::Init() noexcept
+{
+	for (auto& pool : s_m_pools)
+	{
+		glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(s_maxScopes * 2), pool.queries);
+		pool.scopes.reserve(s_maxScopes);
+		pool.isPending = false;
+	}
+	s_m_stack.reserve(32);
+	s_m_isInitialized = true;
+	Calibrate();
+}
+
+void GPUProfiler::Clear() noexcept
+{
+	if (s_m_isInitialized)
+	{
+		for (auto& pool : s_m_pools)
+		{
+			glDeleteQueries(static_cast<GLsizei>(s_maxScopes * 2), pool.queries);
+			pool.scopes.clear();
+			pool.isPending = false;
+		}
+	}
+	s_m_isInitialized = s_m_isRecording = false;
+	s_m_stack.clear();
+	s_m_lastFrame.clear();
+	s_m_history.clear();
+}
+
+void GPUProfiler::Calibrate() noexcept
+{
+	// The current GPU time is read without waiting for queued commands
+	GLint64 gpu = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpu);
+	s_m_gpuOffset = static_cast<std::int64_t>(gpu) - static_cast<std::int64_t>(Now());
+}
+
+void GPUProfiler::BeginFrame() noexcept
+{
+	s_m_isRecording = false;
+	s_m_stack.clear();
+	if (s_m_isEnabled == false)
+		return;
+	if (s_m_isInitialized == false)
+		Init();
+
+	Pool& pool = s_m_pools[s_m_frame % s_frameCount];
+	if (pool.isPending)
+	{
+		// The last query of a frame is the end of the frame scope, every other query finished before it
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(pool.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_FALSE)
+		{
+			++s_m_skipped;
+			return;
+		}
+		Resolve(pool);
+	}
+	// The clocks drift apart slowly, they are matched again once in a while
+	if (s_m_frame % s_historySize == 0)
+		Calibrate();
+
+	pool.scopes.clear();
+	s_m_isRecording = true;
+	Begin("Frame");
+}
+
+void GPUProfiler::EndFrame() noexcept
+{
+	if (s_m_isRecording == false)
+		return;
+	while (s_m_stack.empty() == false)
+		End();
+	s_m_pools[s_m_frame % s_frameCount].isPending = true;
+	s_m_isRecording = false;
+	++s_m_frame;
+}
+
+void GPUProfiler::Begin(const char* name) noexcept
+{
+	if (s_m_isRecording == false)
+		return;
+	Pool& pool = s_m_pools[s_m_frame % s_frameCount];
+	// Scopes past the pool are not measured, -1 keeps Begin and End paired
+	if (pool.scopes.size() >= s_maxScopes)
+	{
+		s_m_stack.push_back(-1);
+		return;
+	}
+	const int parent = s_m_stack.empty() ? -1 : s_m_stack.back();
+	ProfileScope scope;
+	scope.name = name;
+	scope.parent = parent;
+	scope.depth = static_cast<unsigned>(s_m_stack.size());
+	scope.cpuBegin = Now();
+	const auto index = static_cast<int>(pool.scopes.size());
+	glQueryCounter(pool.queries[index * 2], GL_TIMESTAMP);
+	pool.scopes.push_back(scope);
+	s_m_stack.push_back(index);
+}
+
+void GPUProfiler::End() noexcept
+{
+	if (s_m_isRecording == false || s_m_stack.empty())
+		return;
+	const int index = s_m_stack.back();
+	s_m_stack.pop_back();
+	if (index < 0)
+		return;
+	Pool& pool = s_m_pools[s_m_frame % s_frameCount];
+	glQueryCounter(pool.queries[index * 2 + 1], GL_TIMESTAMP);
+	pool.scopes[static_cast<std::size_t>(index)].cpuEnd = Now();
+}
+
+void GPUProfiler::Resolve(Pool& pool) noexcept
+{
+	pool.isPending = false;
+	for (std::size_t i = 0; i < pool.scopes.size(); ++i)
+	{
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(pool.queries[i * 2], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(pool.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+		pool.scopes[i].gpuBegin = static_cast<std::uint64_t>(static_cast<std::int64_t>(begin) - s_m_gpuOffset);
+		pool.scopes[i].gpuEnd = static_cast<std::uint64_t>(static_cast<std::int64_t>(end) - s_m_gpuOffset);
+	}
+	if (s_m_isPaused)
+		return;
+	s_m_lastFrame = pool.scopes;
+	s_m_history.push_back(pool.scopes);
+	if (s_m_history.size() > s_historySize)
+		s_m_history.pop_front();
+}
+
+const std::vector<ProfileScope>& GPUProfiler::GetLastFrame() noexcept
+{
+	return s_m_lastFrame;
+}
+
+const std::deque<std::vector<ProfileScope>>& GPUProfiler::GetHistory() noexcept
+{
+	return s_m_history;
+}
+
+bool GPUProfiler::ExportChromeTrace(const std::filesystem::path& path) noexcept
+{
+	std::ofstream file(path);
+	if (file.is_open() == false)
+	{
+		std::cout << "[GPUProfiler]: Cannot open " << path.string() << std::endl;
+		return false;
+	}
+	file << std::fixed;
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	file << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}}";
+	file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+	bool is_first = false;
+	for (const auto& frame : s_m_history)
+	{
+		for (const auto& scope : frame)
+		{
+			WriteEvent(file, is_first, scope.name, 1, scope.cpuBegin, scope.cpuEnd);
+			if (scope.gpuEnd > scope.gpuBegin)
+				WriteEvent(file, is_first, scope.name, 2, scope.gpuBegin, scope.gpuEnd);
+		}
+	}
+	file << "\n]}\n";
+	return file.good();
+}
+
+GPUProfileScope::GPUProfileScope(const char* name) noexcept
+{
+	GPUProfiler::Begin(name);
+}
+
+GPUProfileScope::~GPUProfileScope() noexcept
+{
+	GPUProfiler::End();
+}
@@ -0,0 +1,78 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: GPUProfiler.h
+ *	Desc		: Nested GPU and CPU timings of the passes of a frame
+ */
+#pragma once
+#include <cstdint>		// std::uint64_t
+#include <deque>		// std::deque
+#include <filesystem>	// std::filesystem::path
+#include <vector>		// std::vector
+
+// Times are nanoseconds on the profiler's CPU clock, GPU timestamps are moved onto it
+struct ProfileScope
+{
+	const char* name = nullptr;
+	int parent = -1;
+	unsigned depth = 0;
+	std::uint64_t cpuBegin = 0, cpuEnd = 0;
+	std::uint64_t gpuBegin = 0, gpuEnd = 0;
+};
+
+// A timestamp query is written at both ends of every scope, so scopes nest freely
+// Each frame owns a query pool that is read once the GPU finished it, reading never waits
+class GPUProfiler
+{
+public:
+	static constexpr std::size_t s_frameCount = 2;
+	static constexpr std::size_t s_maxScopes = 128;
+	static constexpr std::size_t s_historySize = 300;
+
+	static void BeginFrame() noexcept;
+	static void EndFrame() noexcept;
+	static void Begin(const char* name) noexcept;
+	static void End() noexcept;
+	static void Clear() noexcept;
+
+	// Scopes of the newest finished frame, parents come before their children, the first one is the frame
+	[[nodiscard]] static const std::vector<ProfileScope>& GetLastFrame() noexcept;
+	[[nodiscard]] static const std::deque<std::vector<ProfileScope>>& GetHistory() noexcept;
+	// Chrome trace event format, opens in chrome://tracing and ui.perfetto.dev
+	static bool ExportChromeTrace(const std::filesystem::path& path) noexcept;
+	[[nodiscard]] static std::uint64_t Now() noexcept;
+
+	static bool s_m_isEnabled;
+	// The history stops growing while paused, new frames are still measured
+	static bool s_m_isPaused;
+private:
+	struct Pool
+	{
+		unsigned queries[s_maxScopes * 2]{};
+		std::vector<ProfileScope> scopes;
+		bool isPending = false;
+	};
+
+	static void Init() noexcept;
+	static void Resolve(Pool& pool) noexcept;
+	static void Calibrate() noexcept;
+
+	static Pool s_m_pools[s_frameCount];
+	static std::vector<int> s_m_stack;
+	static std::vector<ProfileScope> s_m_lastFrame;
+	static std::deque<std::vector<ProfileScope>> s_m_history;
+	static std::size_t s_m_frame, s_m_skipped;
+	// GPU clock minus CPU clock
+	static std::int64_t s_m_gpuOffset;
+	static bool s_m_isInitialized, s_m_isRecording;
+};
+
+// Profiles the enclosing block
+class GPUProfileScope
+{
+public:
+	explicit GPUProfileScope(const char* name) noexcept;
+	~GPUProfileScope() noexcept;
+	GPUProfileScope(const GPUProfileScope&) = delete;
+	GPUProfileScope& operator=(const GPUProfileScope&) = delete;
+};
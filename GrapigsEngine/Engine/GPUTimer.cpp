@@ -0,0 +1,54 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: GPUTimer.cpp
+ *	Desc		: GPU time of a pass measured with timer queries
+ */
+#include "GPUTimer.h"
+
+#include <gl/glew.h>	// gl functions
+
+GPUTimer::GPUTimer() noexcept
+{
+	glCreateQueries(GL_TIME_ELAPSED, static_cast<GLsizei>(s_latency), m_queries);
+}
+
+GPUTimer::~GPUTimer() noexcept
+{
+	glDeleteQueries(static_cast<GLsizei>(s_latency), m_queries);
+}
+
+void GPUTimer::Begin() noexcept
+{
+	m_isActive = false;
+	// The oldest query is reused, its result is taken only if the GPU already finished it
+	if (m_isPending[m_current])
+	{
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(m_queries[m_current], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_FALSE)
+			return;
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(m_queries[m_current], GL_QUERY_RESULT, &elapsed);
+		const double milliseconds = static_cast<double>(elapsed) * 1e-6;
+		m_milliseconds = m_milliseconds > 0.0 ? m_milliseconds * 0.9 + milliseconds * 0.1 : milliseconds;
+		m_isPending[m_current] = false;
+	}
+	glBeginQuery(GL_TIME_ELAPSED, m_queries[m_current]);
+	m_isPending[m_current] = true;
+	m_isActive = true;
+}
+
+void GPUTimer::End() noexcept
+{
+	if (m_isActive == false)
+		return;
+	m_isActive = false;
+	glEndQuery(GL_TIME_ELAPSED);
+	m_current = (m_current + 1) % s_latency;
+}
+
+double GPUTimer::Milliseconds() const noexcept
+{
+	return m_milliseconds;
+}
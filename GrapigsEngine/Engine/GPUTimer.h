@@ -0,0 +1,29 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: GPUTimer.h
+ *	Desc		: GPU time of a pass measured with timer queries
+ */
+#pragma once
+#include <cstddef>	// std::size_t
+
+// Results are read a few frames after their query was issued so reading never waits for the GPU
+class GPUTimer
+{
+public:
+	static constexpr std::size_t s_latency = 3;
+
+	GPUTimer() noexcept;
+	~GPUTimer() noexcept;
+	void Begin() noexcept;
+	void End() noexcept;
+	// Smoothed time of the finished passes, 0 until the first result is available
+	[[nodiscard]] double Milliseconds() const noexcept;
+private:
+	unsigned m_queries[s_latency]{};
+	bool m_isPending[s_latency]{};
+	std::size_t m_current = 0;
+	// False when every query was still in flight and this pass is not measured
+	bool m_isActive = false;
+	double m_milliseconds = 0.0;
+};
@@ -7,6 +7,9 @@
 #include "GUI.h"
 #include <imgui.h>  // ImGui functions
 
+#include "CPUProfiler.h"  // PROFILE_FUNCTION
+#include "GPUProfiler.h"  // GPUProfileScope
+
 /* GUI - start ----------------------------------------------------------------------------------*/
 
 GUI::GUI(ResourceManager* p_resourceManager) noexcept
@@ -22,6 +25,8 @@ void GUI::SetObject(Object* object) noexcept
 
 void GUI::Update() noexcept
 {
+    PROFILE_FUNCTION();
+    const GPUProfileScope profile("GUI");
     DockSpace();
     m_windows.Update();
 }
@@ -72,6 +77,10 @@ void GUI::MainMenuBar() noexcept
             ImGui::MenuItem("Scene Window", "", &m_windows.m_sceneWin.m_open);
             ImGui::MenuItem("Mesh Window", "", &m_windows.m_meshWin.m_open);
             ImGui::MenuItem("Asset Window", "", &m_windows.m_assetWin.m_open);
+            ImGui::MenuItem("World Window", "", &m_windows.m_worldWin.m_open);
+            ImGui::MenuItem("Statistics Window", "", &m_windows.m_statsWin.m_open);
+            ImGui::MenuItem("Shadow Window", "", &m_windows.m_shadowWin.m_open);
+            ImGui::MenuItem("Profiler Window", "", &m_windows.m_profilerWin.m_open);
             ImGui::MenuItem("Instruction", "", &m_windows.m_testWin.m_open);
             ImGui::EndMenu();
         }
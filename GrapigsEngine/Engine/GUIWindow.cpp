@@ -10,12 +10,22 @@
 #pragma warning (disable : 4201)
 
 #include <imgui.h>              // ImGui functions
+#include <algorithm>            // std::ranges::sort
+#include <string_view>          // std::string_view
 #include <glm/gtc/type_ptr.hpp>          // glm::value_ptr
 
 #include "ImGuizmo/ImGuizmo.h"  // ImGuizmo
 
 #include "Input.h"              // Input::s_windowSize
 #include "Camera.h"             // CameraBuffer
+#include "FrameCapture.h"       // FrameCapture
+#include "FramePacer.h"         // FramePacer
+#include "GLState.h"            // GLState
+#include "GPUProfiler.h"        // GPUProfiler
+#include "ShaderCache.h"        // ShaderCache
+#include "ShaderWatcher.h"      // ShaderWatcher
+#include "ShadowMaps.h"         // ShadowMaps
+#include "World.h"              // World
 
 namespace GUIWindow
 {
@@ -157,6 +167,10 @@ namespace GUIWindow
         m_assetWin("Imported Asset", this),
         m_gizmoToolWin("Tool", this),
 		m_testWin("Instruction", this),
+		m_worldWin("World", this),
+		m_statsWin("Statistics", this),
+		m_shadowWin("Shadows", this),
+		m_profilerWin("Profiler", this),
 		m_p_resource(p_resource)
     {
     }
@@ -170,6 +184,10 @@ namespace GUIWindow
         m_textureModal.SetObject(p_object);
         m_assetWin.SetObject(p_object);
         m_testWin.SetObject(p_object);
+        m_worldWin.SetObject(p_object);
+        m_statsWin.SetObject(p_object);
+        m_shadowWin.SetObject(p_object);
+        m_profilerWin.SetObject(p_object);
     }
 
     void WindowInst::Update() noexcept
@@ -181,6 +199,10 @@ namespace GUIWindow
         m_textureModal.Update();
         m_assetWin.Update();
         m_testWin.Update();
+        m_worldWin.Update();
+        m_statsWin.Update();
+        m_shadowWin.Update();
+        m_profilerWin.Update();
         m_sceneWin.Update();
     }
 
@@ -864,6 +886,509 @@ namespace GUIWindow
 
     /* Test Window - end ----------------------------------------------------------------------------*/
     /*-----------------------------------------------------------------------------------------------*/
+    /* World Window - start -------------------------------------------------------------------------*/
+
+    World::World(const char* name, WindowInst* p_inst) noexcept
+        : Window(name, p_inst)
+    {
+    }
+
+    void World::Content() noexcept
+    {
+        ::World* p_world = m_p_windows->m_p_resource->GetWorld();
+        auto& objects = p_world->Objects();
+        ImGui::Text("Objects: %d", static_cast<int>(objects.size()));
+
+        // Only the visible rows are submitted, the world can hold thousands of objects
+        ImGui::BeginChild("Object List", ImVec2{ 0, 200 }, true);
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(objects.size()));
+        while (clipper.Step())
+        {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+            {
+                ImGui::PushID(i);
+                if (ImGui::Selectable(objects[i].m_name.c_str(), &objects[i] == m_p_object))
+                    Select(&objects[i]);
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndChild();
+
+        if (m_p_object == nullptr)
+            return;
+
+        if (ImGui::Button("Duplicate"))
+        {
+            const ObjectHandle handle = p_world->Create(*m_p_object);
+            Select(p_world->Get(handle));
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Remove") && objects.size() > 1)
+        {
+            p_world->Destroy(p_world->GetHandle(static_cast<std::size_t>(m_p_object - objects.data())));
+            Select(&objects.back());
+        }
+
+        ImGui::Separator();
+        ImGui::DragInt("Copies", &m_scatterCount, 1, 1, 10000);
+        ImGui::DragFloat("Spacing", &m_scatterSpacing, 0.01f, 0.1f, 100.f, "%.2f");
+        if (ImGui::Button("Scatter copies"))
+            Scatter(*m_p_object);
+        HelpMarker("Place copies of the selected object on a grid around it.\nCopies share the model and the shader of the selected object.");
+    }
+
+    void World::Select(::Object* p_object) const noexcept
+    {
+        m_p_windows->m_p_resource->SelectObject(p_object);
+        m_p_windows->SetObject(p_object);
+    }
+
+    void World::Scatter(const ::Object& prototype) const noexcept
+    {
+        ::World* p_world = m_p_windows->m_p_resource->GetWorld();
+        const ObjectHandle selected = p_world->GetHandle(static_cast<std::size_t>(&prototype - p_world->Objects().data()));
+        const ::Object copy = prototype;
+        const glm::vec3 origin = copy.m_transform.GetPosition();
+        const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(m_scatterCount))));
+
+        for (int i = 0; i < m_scatterCount; ++i)
+        {
+            ::Object* p_object = p_world->Get(p_world->Create(copy));
+            const glm::vec3 offset{ static_cast<float>(i % side + 1), 0, static_cast<float>(i / side) };
+            p_object->m_transform.Translate(origin + offset * m_scatterSpacing);
+        }
+
+        // The storage may be reallocated, so find the selected object again
+        m_p_windows->SetObject(p_world->Get(selected));
+    }
+
+    /* World Window - end ---------------------------------------------------------------------------*/
+    /*-----------------------------------------------------------------------------------------------*/
+    /* Statistics Window - start --------------------------------------------------------------------*/
+
+    Stats::Stats(const char* name, WindowInst* p_inst) noexcept
+        : Window(name, p_inst)
+    {
+    }
+
+    void Stats::Content() noexcept
+    {
+        ::World* p_world = m_p_windows->m_p_resource->GetWorld();
+        const CullingStats& stats = p_world->GetCullingStats();
+        const float frame_time = ImGui::GetIO().DeltaTime;
+
+        ImGui::Text("Frame: %.2f ms (%.0f FPS)", frame_time * 1000.f, frame_time > 0.f ? 1.f / frame_time : 0.f);
+        FramePacing();
+        Capture();
+        ImGui::Separator();
+        ::ResourceManager* p_resource = m_p_windows->m_p_resource;
+        ImGui::Checkbox("Depth Prepass", &p_resource->m_isDepthPrepass);
+        HelpMarker("Draw the depth of every batch with positions only, then shade with an equal depth test.\nOverdrawn fragments skip the PBR and IBL work.");
+        ImGui::Text("Scene pass (GPU): direct %.3f ms, prepass %.3f ms", p_resource->GetScenePassTime(false), p_resource->GetScenePassTime(true));
+        const StateCacheStats& state = p_resource->GetStateCacheStats();
+        ImGui::Text("State changes: %d programs, %d VAOs, %d materials (skipped %d)", static_cast<int>(state.programs),
+            static_cast<int>(state.vertexArrays), static_cast<int>(state.materials), static_cast<int>(state.skipped));
+        HelpMarker("Draws are sorted by pass, program, variant, material, VAO and depth before they are submitted.\nBinding what is already bound is skipped.");
+        ImGui::Text("Shader variants: %d", static_cast<int>(ShaderProgram::GetVariantCount()));
+        HelpMarker("A program is compiled once for each set of material maps it is drawn with.\nMissing maps are left out when compiling instead of branched over for every fragment.");
+        const ShaderCacheStats& cache = ShaderCache::GetStats();
+        ImGui::Text("Program cache: %d hits, %d misses, %d rejected, %.1f ms creating programs", static_cast<int>(cache.hits),
+            static_cast<int>(cache.misses), static_cast<int>(cache.rejected), cache.milliseconds);
+        HelpMarker("Linked programs are kept in the shadercache folder, named by their sources and the driver.\nA warm start loads them without compiling any GLSL.");
+        ImGui::Text("Shader reloads: %d, parallel compile %s", static_cast<int>(ShaderWatcher::GetReloadCount()), ShaderProgram::IsParallelCompile() ? "on" : "off");
+        HelpMarker("Saving a shader file rebuilds the programs using it in the background.\nThe new program replaces the old one once it linked, a failed build keeps the old one.");
+        const GLStateStats& gl_state = GLState::GetStats();
+        ImGui::Text("GL state calls: %d made, %d elided", static_cast<int>(gl_state.calls), static_cast<int>(gl_state.elided));
+        HelpMarker("Binds and fixed-function changes of the last frame.\nCalls setting what is already set are skipped by the state tracker.");
+        ImGui::Checkbox("Full-screen Sky", &p_resource->m_isFullscreenSky);
+        HelpMarker("Draw the sky with one triangle generated in the vertex shader instead of the skycube mesh.\nEither way it is drawn last, so covered pixels are rejected by the depth test.");
+        ImGui::Separator();
+        ImGui::Checkbox("Frustum Culling", &p_world->m_isCulling);
+        HelpMarker("Test the bounding sphere of every object and mesh against the camera frustum before drawing.");
+        ImGui::Checkbox("Mesh LOD", &p_world->m_isLod);
+        HelpMarker("Draw a simplified mesh when its error on screen is below the threshold.");
+        ImGui::DragFloat("LOD Threshold", &p_world->m_lodThreshold, 0.05f, 0.1f, 32.f, "%.2f px");
+        ImGui::Checkbox("GPU Culling", &p_world->m_isGPUCulling);
+        HelpMarker("Cull in a compute shader and draw with glMultiDrawElementsIndirectCount.\nThe results stay on the GPU, so the counters below are not updated.");
+        if (p_world->m_isGPUCulling)
+        {
+            ImGui::Checkbox("Occlusion Culling", &p_world->m_isOcclusionCulling);
+            HelpMarker("Test bounds against a depth pyramid built from the previous frame.\nObjects revealed by a fast camera move may appear one frame late.");
+            ImGui::Checkbox("Cluster Culling", &p_world->m_isClusterCulling);
+            HelpMarker("Meshes drawn at their finest LOD are split into meshlets of up to 124 triangles.\nMeshlets outside the frustum or facing away from the camera are skipped.");
+            ImGui::Text("Multi-draws: %d", static_cast<int>(p_world->GetDrawGroups().size()));
+            ImGui::Text("Cluster slots: %d", static_cast<int>(p_world->GetClusterCount()));
+            return;
+        }
+        ImGui::Text("Objects  visible: %d / %d (culled %d)", static_cast<int>(stats.objectsVisible), static_cast<int>(stats.objectsTested),
+            static_cast<int>(stats.objectsTested - stats.objectsVisible));
+        ImGui::Text("Meshes   visible: %d / %d (culled %d)", static_cast<int>(stats.meshesVisible), static_cast<int>(stats.meshesTested),
+            static_cast<int>(stats.meshesTested - stats.meshesVisible));
+        ImGui::Text("Draw calls: %d", static_cast<int>(stats.drawCalls));
+        ImGui::Text("Triangles: %d", static_cast<int>(stats.triangles));
+        for (unsigned lod = 0; lod < ::Mesh::s_maxLods; ++lod)
+            ImGui::Text("  LOD %u: %d meshes", lod, static_cast<int>(stats.lodMeshes[lod]));
+    }
+
+    void Stats::FramePacing() noexcept
+    {
+        constexpr const char* modes[] = { "V-Sync", "Adaptive V-Sync", "Uncapped", "Capped" };
+        int mode = static_cast<int>(FramePacer::GetPresentMode());
+        if (ImGui::Combo("Present Mode", &mode, modes, 4))
+            FramePacer::SetPresentMode(static_cast<PresentMode>(mode));
+        if (FramePacer::GetPresentMode() == PresentMode::Capped)
+        {
+            float fps = static_cast<float>(FramePacer::GetTargetFps());
+            if (ImGui::DragFloat("Target FPS", &fps, 1.f, 10.f, 1000.f, "%.0f"))
+                FramePacer::SetTargetFps(static_cast<double>(fps));
+        }
+        ImGui::Checkbox("Low Latency", &FramePacer::s_m_isLowLatency);
+        HelpMarker("Wait before polling input instead of after presenting, so input is read just in time to render.\nWith v-sync the CPU also waits for each flip, so no frames are queued.");
+
+        const FrameHistogram& frames = FramePacer::GetFrameTimes();
+        const FrameHistogram& work = FramePacer::GetWorkTimes();
+        ImGui::Text("Frame time: p50 %.2f ms, p99 %.2f ms", frames.Percentile(0.5), frames.Percentile(0.99));
+        ImGui::Text("Work time:  p50 %.2f ms, p99 %.2f ms", work.Percentile(0.5), work.Percentile(0.99));
+        constexpr std::size_t bin_count = 50;
+        constexpr double max_milliseconds = 50.0;
+        float bins[bin_count];
+        frames.Bins(bins, bin_count, max_milliseconds);
+        ImGui::PlotHistogram("##FrameTimes", bins, static_cast<int>(bin_count), 0, "Frame times, 0 - 50 ms", 0.f, FLT_MAX, ImVec2(0.f, 60.f));
+    }
+
+    void Stats::Capture() noexcept
+    {
+        FrameCapture* p_capture = m_p_windows->m_p_resource->GetFrameCapture();
+        static int screenshot = 0;
+        if (ImGui::Button("Screenshot PNG"))
+            p_capture->Screenshot("captures/screenshot_" + std::to_string(screenshot++) + ".png");
+        ImGui::SameLine();
+        if (ImGui::Button("Screenshot EXR"))
+            p_capture->Screenshot("captures/screenshot_" + std::to_string(screenshot++) + ".exr");
+        ImGui::SameLine();
+        if (p_capture->IsRecording() == false && ImGui::Button("Record"))
+            p_capture->StartSequence("captures/sequence");
+        else if (p_capture->IsRecording() && ImGui::Button("Stop"))
+            p_capture->StopSequence();
+        HelpMarker("The scene is copied into pixel buffers and read two frames later,\nthen encoded and written by worker threads into the captures folder.\nA sequence skips frames rather than stalling when the disk falls behind.");
+        if (CameraBuffer::IsRecording() == false && ImGui::Button("Record Camera Path"))
+            CameraBuffer::Record(&m_cameraPath);
+        else if (CameraBuffer::IsRecording() && ImGui::Button("Stop Camera Path"))
+        {
+            CameraBuffer::Record(nullptr);
+            std::error_code error;
+            std::filesystem::create_directories("captures", error);
+            m_cameraPath.Save("captures/camera.path");
+        }
+        HelpMarker("Keeps the camera of every frame in captures/camera.path.\nA benchmark scene replays it with: path camera.path");
+        if (Input::IsRecording() == false && Input::IsReplaying() == false && ImGui::Button("Record Input"))
+        {
+            // A replay starts from the camera the recording started from
+            std::error_code error;
+            std::filesystem::create_directories("captures", error);
+            const Camera* p_camera = CameraBuffer::GetMainCamera();
+            const CameraPath start{ { CameraKey{ p_camera->Eye(), p_camera->Eye() + p_camera->Back() } } };
+            if (start.Save("captures/input.path"))
+                Input::StartRecording("captures/input.log");
+        }
+        else if (Input::IsRecording() && ImGui::Button("Stop Input"))
+            Input::StopRecording();
+        ImGui::SameLine();
+        if (Input::IsRecording() == false && Input::IsReplaying() == false && ImGui::Button("Replay Input"))
+        {
+            CameraPath start;
+            if (start.Load("captures/input.path") && Input::StartReplay("captures/input.log"))
+                CameraBuffer::SetMainCamera(start.keys.front());
+        }
+        else if (Input::IsReplaying() && ImGui::Button("Stop Replay"))
+            Input::StopReplay();
+        HelpMarker("Mouse and keyboard events are written with the frame they were applied on to captures/input.log.\nA replay applies them on the same frames, so the camera moves the same way whatever the frame rate.");
+        ImGui::Text("Input: %d events, latency %.3f ms, dropped %d", static_cast<int>(Input::GetEvents().size()), Input::GetEventLatency(),
+            static_cast<int>(Input::GetDroppedEvents()));
+        const FrameCaptureStats stats = p_capture->GetStats();
+        ImGui::Text("Captured %d, written %d, queued %d, dropped %d", static_cast<int>(stats.captured), static_cast<int>(stats.written),
+            static_cast<int>(stats.queued), static_cast<int>(stats.dropped));
+    }
+
+    /* Statistics Window - end ----------------------------------------------------------------------*/
+    /*-----------------------------------------------------------------------------------------------*/
+    /* Shadow Window - start ------------------------------------------------------------------------*/
+
+    Shadows::Shadows(const char* name, WindowInst* p_inst) noexcept
+        : Window(name, p_inst)
+    {
+    }
+
+    void Shadows::Content() noexcept
+    {
+        ShadowSettings& settings = m_p_windows->m_p_resource->GetShadowMaps()->m_settings;
+
+        ImGui::Checkbox("Enable Shadows", &settings.isEnabled);
+        HelpMarker("Cascaded shadow maps for the first directional light,\nand one atlas tile for each of the first 16 spot lights.");
+        ImGui::SliderInt("Cascades", &settings.cascadeCount, 1, static_cast<int>(ShadowMaps::s_maxCascades));
+        constexpr int resolutions[] = { 512, 1024, 2048, 4096 };
+        constexpr const char* resolution_names[] = { "512", "1024", "2048", "4096" };
+        for (int i = 0; i < 2; ++i)
+        {
+            int& resolution = i == 0 ? settings.resolution : settings.spotResolution;
+            int current = 0;
+            while (current < 3 && resolutions[current] < resolution)
+                ++current;
+            if (ImGui::Combo(i == 0 ? "Cascade Size" : "Spot Tile Size", &current, resolution_names, 4))
+                resolution = resolutions[current];
+        }
+        ImGui::SliderInt("Filter Radius", &settings.filterRadius, 0, 3);
+        HelpMarker("PCF over (2r+1)^2 taps, each tap is a 2x2 hardware compare.\nLarger radii give softer edges and cost more per pixel.");
+        ImGui::SliderFloat("Split Lambda", &settings.splitLambda, 0.f, 1.f, "%.2f");
+        HelpMarker("0 spaces the cascades evenly, 1 spaces them logarithmically.");
+        ImGui::DragFloat("Distance", &settings.maxDistance, 0.5f, 1.f, 1000.f, "%.1f");
+        ImGui::DragFloat("Slope Bias", &settings.slopeBias, 0.05f, 0.f, 10.f, "%.2f");
+        ImGui::DragFloat("Constant Bias", &settings.constantBias, 0.05f, 0.f, 10.f, "%.2f");
+        ImGui::DragFloat("Normal Bias", &settings.normalBias, 0.05f, 0.f, 10.f, "%.2f texels");
+    }
+
+    /* Shadow Window - end --------------------------------------------------------------------------*/
+    /*-----------------------------------------------------------------------------------------------*/
+    /* Profiler Window - start ----------------------------------------------------------------------*/
+
+    Profiler::Profiler(const char* name, WindowInst* p_inst) noexcept
+        : Window(name, p_inst)
+    {
+    }
+
+    void Profiler::Content() noexcept
+    {
+        if (ImGui::BeginTabBar("Profilers") == false)
+            return;
+        if (ImGui::BeginTabItem("Passes"))
+        {
+            Passes();
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("CPU Zones"))
+        {
+            Zones();
+            ImGui::EndTabItem();
+        }
+        ImGui::EndTabBar();
+    }
+
+    void Profiler::Passes() noexcept
+    {
+        ImGui::Checkbox("Enable", &GPUProfiler::s_m_isEnabled);
+        ImGui::SameLine();
+        ImGui::Checkbox("Pause", &GPUProfiler::s_m_isPaused);
+        ImGui::SameLine();
+        if (ImGui::Button("Export Chrome Trace"))
+            GPUProfiler::ExportChromeTrace("profile.json");
+        HelpMarker("Writes the last frames to profile.json.\nOpen it in chrome://tracing or ui.perfetto.dev.");
+
+        // A copy, the profiler replaces its frame while the window is drawn
+        m_frame = GPUProfiler::GetLastFrame();
+        if (m_frame.empty())
+        {
+            ImGui::Text("No frame measured yet");
+            return;
+        }
+        const ProfileScope& frame = m_frame.front();
+        ImGui::Text("Frame: CPU %.3f ms, GPU %.3f ms", static_cast<double>(frame.cpuEnd - frame.cpuBegin) * 1e-6,
+            static_cast<double>(frame.gpuEnd - frame.gpuBegin) * 1e-6);
+        Timeline("CPU", false);
+        Timeline("GPU", true);
+
+        ImGui::Separator();
+        constexpr ImGuiTableFlags flags = ImGuiTableFlags_BordersV | ImGuiTableFlags_BordersOuterH | ImGuiTableFlags_RowBg;
+        if (ImGui::BeginTable("Scopes", 3, flags))
+        {
+            ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("CPU ms", ImGuiTableColumnFlags_WidthFixed, 70.f);
+            ImGui::TableSetupColumn("GPU ms", ImGuiTableColumnFlags_WidthFixed, 70.f);
+            ImGui::TableHeadersRow();
+            Tree(0);
+            ImGui::EndTable();
+        }
+    }
+
+    void Profiler::Zones() noexcept
+    {
+        bool is_enabled = CPUProfiler::s_m_isEnabled.load();
+        if (ImGui::Checkbox("Enable##Zones", &is_enabled))
+            CPUProfiler::s_m_isEnabled.store(is_enabled);
+        ImGui::SameLine();
+        ImGui::Checkbox("Pause##Zones", &CPUProfiler::s_m_isPaused);
+        ImGui::SameLine();
+        if (ImGui::Button("Export Trace"))
+            CPUProfiler::ExportChromeTrace("cpu_profile.json");
+        HelpMarker("Writes the zones of the last frames to cpu_profile.json.\nOpen it in chrome://tracing or ui.perfetto.dev.");
+
+        m_zones = CPUProfiler::GetLastFrame();
+        if (m_zones.end <= m_zones.begin)
+        {
+            ImGui::Text("No frame recorded yet");
+            return;
+        }
+        ImGui::Text("Frame: %.3f ms, %d zones, %d dropped", static_cast<double>(m_zones.end - m_zones.begin) * 1e-6,
+            static_cast<int>(m_zones.zones.size()), static_cast<int>(CPUProfiler::GetDropped()));
+
+        // One lane per thread, zones stack downwards by depth
+        const std::vector<const char*> names = CPUProfiler::GetThreadNames();
+        constexpr float row_height = 18.f;
+        const float width = std::max(ImGui::GetContentRegionAvail().x, 1.f);
+        const float scale = width / static_cast<float>(m_zones.end - m_zones.begin);
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        ImDrawList* p_draw = ImGui::GetWindowDrawList();
+        for (unsigned thread = 0; thread < names.size(); ++thread)
+        {
+            unsigned depth = 0;
+            bool has_zones = false;
+            for (const CPUZoneEvent& zone : m_zones.zones)
+            {
+                if (zone.thread != thread)
+                    continue;
+                depth = std::max(depth, zone.depth);
+                has_zones = true;
+            }
+            if (has_zones == false)
+                continue;
+
+            ImGui::Text("%s", names[thread] ? names[thread] : "Worker");
+            const ImVec2 origin = ImGui::GetCursorScreenPos();
+            const ImVec2 size(width, row_height * static_cast<float>(depth + 1));
+            ImGui::PushID(static_cast<int>(thread));
+            ImGui::InvisibleButton("Lane", size);
+            ImGui::PopID();
+            const bool is_hovered = ImGui::IsItemHovered();
+            p_draw->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), IM_COL32(30, 30, 30, 255));
+            for (const CPUZoneEvent& zone : m_zones.zones)
+            {
+                if (zone.thread != thread || zone.end <= zone.begin)
+                    continue;
+                // Zones begun in the previous frame are clipped to the start of this one
+                const std::uint64_t begin = std::max(zone.begin, m_zones.begin);
+                const ImVec2 min(origin.x + static_cast<float>(begin - m_zones.begin) * scale, origin.y + static_cast<float>(zone.depth) * row_height);
+                const ImVec2 max(std::max(origin.x + static_cast<float>(zone.end - m_zones.begin) * scale, min.x + 1.f), min.y + row_height - 1.f);
+                const auto hash = static_cast<unsigned>(std::hash<std::string_view>{}(zone.name));
+                p_draw->AddRectFilled(min, max, ImColor::HSV(static_cast<float>(hash % 360u) / 360.f, 0.55f, 0.75f));
+                p_draw->PushClipRect(min, max, true);
+                p_draw->AddText(ImVec2(min.x + 2.f, min.y + 2.f), IM_COL32(0, 0, 0, 255), zone.name);
+                p_draw->PopClipRect();
+                if (is_hovered && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y)
+                    ImGui::SetTooltip("%s\n%.3f ms", zone.name, static_cast<double>(zone.end - zone.begin) * 1e-6);
+            }
+        }
+
+        // Totals per zone name, heaviest first
+        std::vector<std::pair<std::string_view, std::pair<std::uint64_t, int>>> totals;
+        for (const CPUZoneEvent& zone : m_zones.zones)
+        {
+            const std::string_view name(zone.name);
+            auto found = std::ranges::find_if(totals, [&name](const auto& total) { return total.first == name; });
+            if (found == totals.end())
+            {
+                totals.emplace_back(name, std::make_pair(std::uint64_t{ 0 }, 0));
+                found = totals.end() - 1;
+            }
+            found->second.first += zone.end - zone.begin;
+            ++found->second.second;
+        }
+        std::ranges::sort(totals, [](const auto& a, const auto& b) { return a.second.first > b.second.first; });
+        ImGui::Separator();
+        constexpr ImGuiTableFlags flags = ImGuiTableFlags_BordersV | ImGuiTableFlags_BordersOuterH | ImGuiTableFlags_RowBg;
+        if (ImGui::BeginTable("Zones", 3, flags))
+        {
+            ImGui::TableSetupColumn("Zone", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_WidthFixed, 50.f);
+            ImGui::TableSetupColumn("Total ms", ImGuiTableColumnFlags_WidthFixed, 70.f);
+            ImGui::TableHeadersRow();
+            for (const auto& [name, total] : totals)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%.*s", static_cast<int>(name.size()), name.data());
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", total.second);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", static_cast<double>(total.first) * 1e-6);
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    void Profiler::Timeline(const char* label, bool is_gpu) const noexcept
+    {
+        // Each track starts at its own frame start, so the GPU latency does not stretch the view
+        const ProfileScope& frame = m_frame.front();
+        const std::uint64_t start = is_gpu ? frame.gpuBegin : frame.cpuBegin;
+        const std::uint64_t length = std::max(std::max(frame.cpuEnd - frame.cpuBegin, frame.gpuEnd - frame.gpuBegin), std::uint64_t{ 1 });
+        unsigned depth = 0;
+        for (const ProfileScope& scope : m_frame)
+            depth = std::max(depth, scope.depth);
+
+        constexpr float row_height = 18.f;
+        ImGui::Text("%s", label);
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float width = std::max(ImGui::GetContentRegionAvail().x, 1.f);
+        const ImVec2 size(width, row_height * static_cast<float>(depth + 1));
+        ImGui::InvisibleButton(label, size);
+        const bool is_hovered = ImGui::IsItemHovered();
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        ImDrawList* p_draw = ImGui::GetWindowDrawList();
+        p_draw->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), IM_COL32(30, 30, 30, 255));
+
+        const float scale = width / static_cast<float>(length);
+        for (const ProfileScope& scope : m_frame)
+        {
+            const std::uint64_t begin = is_gpu ? scope.gpuBegin : scope.cpuBegin;
+            const std::uint64_t end = is_gpu ? scope.gpuEnd : scope.cpuEnd;
+            if (end <= begin || begin < start)
+                continue;
+            const ImVec2 min(origin.x + static_cast<float>(begin - start) * scale, origin.y + static_cast<float>(scope.depth) * row_height);
+            const ImVec2 max(std::max(origin.x + static_cast<float>(end - start) * scale, min.x + 1.f), min.y + row_height - 1.f);
+            // The hue follows the name, so a pass keeps its colour across frames
+            const auto hash = static_cast<unsigned>(std::hash<std::string_view>{}(scope.name));
+            const ImU32 color = ImColor::HSV(static_cast<float>(hash % 360u) / 360.f, 0.55f, 0.75f);
+            p_draw->AddRectFilled(min, max, color);
+            p_draw->PushClipRect(min, max, true);
+            p_draw->AddText(ImVec2(min.x + 2.f, min.y + 2.f), IM_COL32(0, 0, 0, 255), scope.name);
+            p_draw->PopClipRect();
+            if (is_hovered && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y)
+                ImGui::SetTooltip("%s\n%s %.3f ms", scope.name, label, static_cast<double>(end - begin) * 1e-6);
+        }
+    }
+
+    void Profiler::Tree(std::size_t index) const noexcept
+    {
+        const ProfileScope& scope = m_frame[index];
+        bool has_children = false;
+        for (std::size_t i = index + 1; i < m_frame.size() && has_children == false; ++i)
+            has_children = m_frame[i].parent == static_cast<int>(index);
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanFullWidth;
+        if (has_children == false)
+            flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+        ImGui::PushID(static_cast<int>(index));
+        const bool is_open = ImGui::TreeNodeEx(scope.name, flags);
+        ImGui::PopID();
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", static_cast<double>(scope.cpuEnd - scope.cpuBegin) * 1e-6);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", static_cast<double>(scope.gpuEnd - scope.gpuBegin) * 1e-6);
+        if (has_children == false || is_open == false)
+            return;
+        // Children follow their parent in the order they began
+        for (std::size_t i = index + 1; i < m_frame.size(); ++i)
+        {
+            if (m_frame[i].parent == static_cast<int>(index))
+                Tree(i);
+        }
+        ImGui::TreePop();
+    }
+
+    /* Profiler Window - end ------------------------------------------------------------------------*/
+    /*-----------------------------------------------------------------------------------------------*/
     /* Splash - start -------------------------------------------------------------------------------*/
 
     Splash::Splash(const char* name, WindowInst* p_inst) noexcept
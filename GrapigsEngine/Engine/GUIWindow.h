@@ -10,6 +10,9 @@
 #include <string>				// std::string
 #include <queue>				// std::queue
 #include <set>					// std::set
+#include "Camera.h"				// CameraPath
+#include "CPUProfiler.h"		// CPUFrame
+#include "GPUProfiler.h"		// ProfileScope
 #include "ResourceManager.h"	// Object
 
 namespace GUIWindow
@@ -155,6 +158,50 @@ namespace GUIWindow
 		std::map<::Texture*, bool> m_textures;
 	};
 
+	class World final : public Window
+	{
+	public:
+		World(const char* name, WindowInst* p_inst) noexcept;
+		void Content() noexcept override;
+	private:
+		void Select(::Object* p_object) const noexcept;
+		void Scatter(const ::Object& prototype) const noexcept;
+		int m_scatterCount = 100;
+		float m_scatterSpacing = 1.5f;
+	};
+
+	class Stats final : public Window
+	{
+	public:
+		Stats(const char* name, WindowInst* p_inst) noexcept;
+		void Content() noexcept override;
+	private:
+		static void FramePacing() noexcept;
+		void Capture() noexcept;
+		CameraPath m_cameraPath;
+	};
+
+	class Shadows final : public Window
+	{
+	public:
+		Shadows(const char* name, WindowInst* p_inst) noexcept;
+		void Content() noexcept override;
+	};
+
+	class Profiler final : public Window
+	{
+	public:
+		Profiler(const char* name, WindowInst* p_inst) noexcept;
+		void Content() noexcept override;
+	private:
+		void Passes() noexcept;
+		void Zones() noexcept;
+		void Timeline(const char* label, bool is_gpu) const noexcept;
+		void Tree(std::size_t index) const noexcept;
+		std::vector<ProfileScope> m_frame;
+		CPUFrame m_zones;
+	};
+
 	class TestWindow : public Window
 	{
 	public:
@@ -189,6 +236,10 @@ namespace GUIWindow
 		GizmoTool m_gizmoToolWin;
 		TexturePreview m_texturePreview;
 		TestWindow m_testWin;
+		World m_worldWin;
+		Stats m_statsWin;
+		Shadows m_shadowWin;
+		Profiler m_profilerWin;
 		ResourceManager* m_p_resource;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,403 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: ImageWriter.cpp
+ *	Desc		: Image encoding and a background thread writing images to disk
+ */
+#include "ImageWriter.h"
+
+#include <algorithm>	// std::clamp
+#include <array>		// std::array
+#include <cctype>		// std::tolower
+#include <cstdint>		// std::uint16_t
+#include <cstring>		// std::strlen
+#include <fstream>		// std::ofstream
+#include <iostream>		// std::cout
+
+#include "CPUProfiler.h"	// PROFILE_ZONE
+
+namespace
+{
+	/* Deflate - start --------------------------------------------------------------------------*/
+
+	constexpr unsigned short s_lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	constexpr unsigned char s_lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	constexpr unsigned short s_distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	constexpr unsigned char s_distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	constexpr std::size_t s_window = 32768, s_hashSize = 1 << 15;
+	constexpr std::size_t s_minMatch = 3, s_maxMatch = 258;
+
+	class BitWriter
+	{
+	public:
+		explicit BitWriter(std::vector<unsigned char>& out) noexcept : m_out(out) {}
+		// Extra bits and headers go least significant bit first
+		void Bits(unsigned value, unsigned count) noexcept
+		{
+			m_buffer |= value << m_count;
+			m_count += count;
+			while (m_count >= 8)
+			{
+				m_out.push_back(static_cast<unsigned char>(m_buffer & 0xFF));
+				m_buffer >>= 8;
+				m_count -= 8;
+			}
+		}
+		// Huffman codes go most significant bit first
+		void Code(unsigned code, unsigned length) noexcept
+		{
+			unsigned reversed = 0;
+			for (unsigned i = 0; i < length; ++i)
+				reversed |= ((code >> i) & 1u) << (length - 1 - i);
+			Bits(reversed, length);
+		}
+		void Flush() noexcept
+		{
+			if (m_count > 0)
+				m_out.push_back(static_cast<unsigned char>(m_buffer & 0xFF));
+			m_buffer = m_count = 0;
+		}
+	private:
+		std::vector<unsigned char>& m_out;
+		unsigned m_buffer = 0, m_count = 0;
+	};
+
+	void Symbol(BitWriter& writer, unsigned symbol) noexcept
+	{
+		if (symbol < 144)
+			writer.Code(0x30 + symbol, 8);
+		else if (symbol < 256)
+			writer.Code(0x190 + symbol - 144, 9);
+		else if (symbol < 280)
+			writer.Code(symbol - 256, 7);
+		else
+			writer.Code(0xC0 + symbol - 280, 8);
+	}
+
+	void Match(BitWriter& writer, std::size_t length, std::size_t distance) noexcept
+	{
+		unsigned code = 28;
+		while (s_lengthBase[code] > length)
+			--code;
+		Symbol(writer, 257 + code);
+		writer.Bits(static_cast<unsigned>(length - s_lengthBase[code]), s_lengthExtra[code]);
+		code = 29;
+		while (s_distanceBase[code] > distance)
+			--code;
+		writer.Code(code, 5);
+		writer.Bits(static_cast<unsigned>(distance - s_distanceBase[code]), s_distanceExtra[code]);
+	}
+
+	// One fixed Huffman block, each position is matched against the last one with the same 3-byte hash
+	void Deflate(const std::vector<unsigned char>& data, std::vector<unsigned char>& out) noexcept
+	{
+		BitWriter writer(out);
+		writer.Bits(1, 1);
+		writer.Bits(1, 2);
+		std::vector<std::size_t> last(s_hashSize, static_cast<std::size_t>(-1));
+		const std::size_t size = data.size();
+		std::size_t i = 0;
+		while (i < size)
+		{
+			std::size_t length = 0, distance = 0;
+			if (i + s_minMatch <= size)
+			{
+				const unsigned hash = ((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & (s_hashSize - 1);
+				const std::size_t candidate = last[hash];
+				last[hash] = i;
+				if (candidate != static_cast<std::size_t>(-1) && i - candidate <= s_window)
+				{
+					const std::size_t limit = std::min(s_maxMatch, size - i);
+					while (length < limit && data[candidate + length] == data[i + length])
+						++length;
+					distance = i - candidate;
+				}
+			}
+			if (length >= s_minMatch)
+			{
+				Match(writer, length, distance);
+				i += length;
+			}
+			else
+				Symbol(writer, data[i++]);
+		}
+		Symbol(writer, 256);
+		writer.Flush();
+	}
+
+	/* Deflate - end ----------------------------------------------------------------------------*/
+
+	const std::array<unsigned, 256>& CrcTable() noexcept
+	{
+		static const std::array<unsigned, 256> table = []
+		{
+			std::array<unsigned, 256> result{};
+			for (unsigned n = 0; n < 256; ++n)
+			{
+				unsigned c = n;
+				for (int k = 0; k < 8; ++k)
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				result[n] = c;
+			}
+			return result;
+		}();
+		return table;
+	}
+
+	void PutBigEndian(std::vector<unsigned char>& out, unsigned value) noexcept
+	{
+		for (int shift = 24; shift >= 0; shift -= 8)
+			out.push_back(static_cast<unsigned char>((value >> shift) & 0xFF));
+	}
+
+	void Chunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data) noexcept
+	{
+		PutBigEndian(out, static_cast<unsigned>(data.size()));
+		const std::size_t begin = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data.begin(), data.end());
+		unsigned crc = 0xFFFFFFFFu;
+		for (std::size_t i = begin; i < out.size(); ++i)
+			crc = CrcTable()[(crc ^ out[i]) & 0xFF] ^ (crc >> 8);
+		PutBigEndian(out, crc ^ 0xFFFFFFFFu);
+	}
+}
+
+std::size_t CapturedImage::PixelSize() const noexcept
+{
+	return static_cast<std::size_t>(channels) * (format == PixelFormat::RGBA16F ? 2 : 1);
+}
+
+/* ImageEncoder - start -------------------------------------------------------------------------*/
+
+std::vector<unsigned char> ImageEncoder::Png(const CapturedImage& image) noexcept
+{
+	std::vector<unsigned char> png;
+	if (image.format != PixelFormat::RGBA8 || image.width <= 0 || image.height <= 0 || (image.channels != 3 && image.channels != 4))
+		return png;
+	const auto width = static_cast<std::size_t>(image.width);
+	const auto height = static_cast<std::size_t>(image.height);
+	const std::size_t stride = width * static_cast<std::size_t>(image.channels);
+	if (image.pixels.size() < stride * height)
+		return png;
+
+	// Rows top first, each filtered with the row above
+	std::vector<unsigned char> filtered;
+	filtered.reserve((stride + 1) * height);
+	for (std::size_t y = 0; y < height; ++y)
+	{
+		const unsigned char* p_row = image.pixels.data() + (height - 1 - y) * stride;
+		const unsigned char* p_above = y > 0 ? p_row + stride : nullptr;
+		filtered.push_back(2);
+		for (std::size_t x = 0; x < stride; ++x)
+			filtered.push_back(static_cast<unsigned char>(p_row[x] - (p_above ? p_above[x] : 0)));
+	}
+
+	std::vector<unsigned char> zlib = { 0x78, 0x01 };
+	Deflate(filtered, zlib);
+	unsigned a = 1, b = 0;
+	for (const unsigned char byte : filtered)
+	{
+		a = (a + byte) % 65521u;
+		b = (b + a) % 65521u;
+	}
+	PutBigEndian(zlib, (b << 16) | a);
+
+	std::vector<unsigned char> header;
+	PutBigEndian(header, static_cast<unsigned>(width));
+	PutBigEndian(header, static_cast<unsigned>(height));
+	header.insert(header.end(), { 8, static_cast<unsigned char>(image.channels == 4 ? 6 : 2), 0, 0, 0 });
+
+	png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	Chunk(png, "IHDR", header);
+	Chunk(png, "IDAT", zlib);
+	Chunk(png, "IEND", {});
+	return png;
+}
+
+std::vector<unsigned char> ImageEncoder::Exr(const CapturedImage& image) noexcept
+{
+	std::vector<unsigned char> exr;
+	if (image.format != PixelFormat::RGBA16F || image.width <= 0 || image.height <= 0 || image.channels != 4)
+		return exr;
+	const auto width = static_cast<std::size_t>(image.width);
+	const auto height = static_cast<std::size_t>(image.height);
+	if (image.pixels.size() < width * height * image.PixelSize())
+		return exr;
+
+	const auto put = [&exr](const void* p_data, std::size_t size)
+	{
+		const auto* p_bytes = static_cast<const unsigned char*>(p_data);
+		exr.insert(exr.end(), p_bytes, p_bytes + size);
+	};
+	// The format is little endian, as are the platforms the engine runs on
+	const auto put_int = [&put](std::int32_t value) { put(&value, sizeof(value)); };
+	const auto put_attribute = [&exr, &put_int](const char* name, const char* type, std::int32_t size)
+	{
+		exr.insert(exr.end(), name, name + std::strlen(name) + 1);
+		exr.insert(exr.end(), type, type + std::strlen(type) + 1);
+		put_int(size);
+	};
+
+	// Magic number and version 2, single part scanline file
+	exr = { 0x76, 0x2F, 0x31, 0x01, 2, 0, 0, 0 };
+	// Channels are stored in alphabetical order, each one half float
+	constexpr const char* channels[] = { "B", "G", "R" };
+	put_attribute("channels", "chlist", 3 * 18 + 1);
+	for (const char* channel : channels)
+	{
+		exr.insert(exr.end(), { static_cast<unsigned char>(channel[0]), 0 });
+		put_int(1);
+		exr.insert(exr.end(), { 0, 0, 0, 0 });
+		put_int(1);
+		put_int(1);
+	}
+	exr.push_back(0);
+	put_attribute("compression", "compression", 1);
+	exr.push_back(0);
+	const std::int32_t window[4] = { 0, 0, image.width - 1, image.height - 1 };
+	put_attribute("dataWindow", "box2i", 16);
+	put(window, sizeof(window));
+	put_attribute("displayWindow", "box2i", 16);
+	put(window, sizeof(window));
+	put_attribute("lineOrder", "lineOrder", 1);
+	exr.push_back(0);
+	const float aspect = 1.f, center[2] = { 0.f, 0.f };
+	put_attribute("pixelAspectRatio", "float", 4);
+	put(&aspect, sizeof(aspect));
+	put_attribute("screenWindowCenter", "v2f", 8);
+	put(center, sizeof(center));
+	put_attribute("screenWindowWidth", "float", 4);
+	put(&aspect, sizeof(aspect));
+	exr.push_back(0);
+
+	// One uncompressed scanline per block, top row first
+	const std::size_t row_size = width * 3 * 2;
+	std::uint64_t offset = exr.size() + height * sizeof(std::uint64_t);
+	for (std::size_t y = 0; y < height; ++y)
+	{
+		put(&offset, sizeof(offset));
+		offset += 8 + row_size;
+	}
+	const auto* p_half = reinterpret_cast<const std::uint16_t*>(image.pixels.data());
+	for (std::size_t y = 0; y < height; ++y)
+	{
+		put_int(static_cast<std::int32_t>(y));
+		put_int(static_cast<std::int32_t>(row_size));
+		const std::uint16_t* p_row = p_half + (height - 1 - y) * width * 4;
+		for (const int channel : { 2, 1, 0 })
+		{
+			for (std::size_t x = 0; x < width; ++x)
+				put(&p_row[x * 4 + static_cast<std::size_t>(channel)], sizeof(std::uint16_t));
+		}
+	}
+	return exr;
+}
+
+std::vector<unsigned char> ImageEncoder::Encode(const std::filesystem::path& path, const CapturedImage& image) noexcept
+{
+	std::string extension = path.extension().string();
+	for (char& c : extension)
+		c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	if (extension == ".exr")
+		return Exr(image);
+	return Png(image);
+}
+
+/* ImageEncoder - end ---------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
+/* ImageWriter - start --------------------------------------------------------------------------*/
+
+ImageWriter::ImageWriter(std::size_t thread_count) noexcept
+{
+	if (thread_count == 0)
+	{
+		const unsigned cores = std::thread::hardware_concurrency();
+		thread_count = std::clamp<std::size_t>(cores > 1 ? cores - 1 : 1, 1, 4);
+	}
+	m_threads.reserve(thread_count);
+	for (std::size_t i = 0; i < thread_count; ++i)
+		m_threads.emplace_back([this] { Run(); });
+}
+
+ImageWriter::~ImageWriter() noexcept
+{
+	{
+		const std::lock_guard lock(m_mutex);
+		m_isStopping = true;
+	}
+	m_wake.notify_all();
+	for (std::thread& thread : m_threads)
+		thread.join();
+}
+
+void ImageWriter::Write(std::filesystem::path path, CapturedImage&& image) noexcept
+{
+	{
+		const std::lock_guard lock(m_mutex);
+		m_jobs.push_back(Job{ std::move(path), std::move(image) });
+	}
+	m_wake.notify_one();
+}
+
+void ImageWriter::Finish() noexcept
+{
+	std::unique_lock lock(m_mutex);
+	m_idle.wait(lock, [this] { return m_jobs.empty() && m_busy == 0; });
+}
+
+std::size_t ImageWriter::Written() const noexcept
+{
+	return m_written.load();
+}
+
+std::size_t ImageWriter::Queued() const noexcept
+{
+	const std::lock_guard lock(m_mutex);
+	return m_jobs.size() + m_busy;
+}
+
+void ImageWriter::Run() noexcept
+{
+	CPUProfiler::SetThreadName("Image Writer");
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock lock(m_mutex);
+			m_wake.wait(lock, [this] { return m_isStopping || m_jobs.empty() == false; });
+			if (m_jobs.empty())
+				return;
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+			++m_busy;
+		}
+
+		{
+			PROFILE_ZONE("ImageWriter::Encode");
+			const std::vector<unsigned char> encoded = ImageEncoder::Encode(job.path, job.image);
+			if (job.path.has_parent_path())
+			{
+				std::error_code error;
+				std::filesystem::create_directories(job.path.parent_path(), error);
+			}
+			std::ofstream file(job.path, std::ios::binary);
+			if (encoded.empty() || file.is_open() == false)
+				std::cout << "[ImageWriter]: Cannot write " << job.path.string() << std::endl;
+			else
+			{
+				file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+				m_written.fetch_add(1);
+			}
+		}
+
+		{
+			const std::lock_guard lock(m_mutex);
+			--m_busy;
+		}
+		m_idle.notify_all();
+	}
+}
+
+/* ImageWriter - end ----------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
@@ -0,0 +1,72 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: ImageWriter.h
+ *	Desc		: Image encoding and a background thread writing images to disk
+ */
+#pragma once
+#include <atomic>				// std::atomic
+#include <condition_variable>	// std::condition_variable
+#include <deque>				// std::deque
+#include <filesystem>			// std::filesystem::path
+#include <mutex>				// std::mutex
+#include <thread>				// std::thread
+#include <vector>				// std::vector
+
+enum class PixelFormat { RGBA8, RGBA16F };
+
+// Pixels read back from the GPU, bottom row first as OpenGL returns them
+struct CapturedImage
+{
+	[[nodiscard]] std::size_t PixelSize() const noexcept;
+
+	int width = 0, height = 0;
+	int channels = 4;
+	PixelFormat format = PixelFormat::RGBA8;
+	std::vector<unsigned char> pixels;
+};
+
+class ImageEncoder
+{
+public:
+	// 8-bit RGB or RGBA, compressed with fixed Huffman codes
+	[[nodiscard]] static std::vector<unsigned char> Png(const CapturedImage& image) noexcept;
+	// Half-float RGBA written as uncompressed RGB scanlines, keeps the HDR scene colour
+	[[nodiscard]] static std::vector<unsigned char> Exr(const CapturedImage& image) noexcept;
+	// Picks the encoder from the extension, .exr or .png
+	[[nodiscard]] static std::vector<unsigned char> Encode(const std::filesystem::path& path, const CapturedImage& image) noexcept;
+};
+
+// Worker threads encode and write queued images, several images are in flight at once
+class ImageWriter
+{
+public:
+	// 0 picks one thread per spare core, up to four
+	explicit ImageWriter(std::size_t thread_count = 0) noexcept;
+	~ImageWriter() noexcept;
+	ImageWriter(const ImageWriter&) = delete;
+	ImageWriter& operator=(const ImageWriter&) = delete;
+
+	void Write(std::filesystem::path path, CapturedImage&& image) noexcept;
+	// Blocks until every queued image is on disk
+	void Finish() noexcept;
+	[[nodiscard]] std::size_t Written() const noexcept;
+	// Images waiting or being encoded
+	[[nodiscard]] std::size_t Queued() const noexcept;
+private:
+	struct Job
+	{
+		std::filesystem::path path;
+		CapturedImage image;
+	};
+
+	void Run() noexcept;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake, m_idle;
+	std::deque<Job> m_jobs;
+	std::size_t m_busy = 0;
+	bool m_isStopping = false;
+	std::atomic<std::size_t> m_written{ 0 };
+	std::vector<std::thread> m_threads;
+};
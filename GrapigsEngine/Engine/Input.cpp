@@ -6,12 +6,24 @@
  */
 #include "Input.h"
 
+#include <chrono>	// std::chrono
+#include <cstring>	// std::memcpy
 #include <iostream>	// std::cout
 #include <GLFW/glfw3.h>	// glfw functions
 
 glm::ivec2 Input::s_m_windowSize = glm::ivec2(1200, 900);
+InputQueue Input::s_m_queue;
+std::vector<InputEvent> Input::s_m_events;
+double Input::s_m_latency = 0.0;
+std::ofstream Input::s_m_log;
+std::vector<Input::Record> Input::s_m_replay;
+std::size_t Input::s_m_replayNext = 0;
+std::uint32_t Input::s_m_logFrame = 0;
+std::uint64_t Input::s_m_logBegin = 0;
+bool Input::s_m_isRecording = false;
+bool Input::s_m_isReplaying = false;
 bool Input::s_m_isMouseDown[3] = { false, false, false };
-int Input::s_m_scroll = 0;
+float Input::s_m_scroll = 0.f;
 Modifier Input::s_m_modifier = Modifier::None;
 glm::ivec2 Input::s_m_cursor = glm::ivec2(0, 0);
 glm::ivec2 Input::s_m_cursorDir = glm::ivec2(0);
@@ -56,8 +68,79 @@ namespace
 		}
 		return Keyboard::Unknown;
 	}
+
+	Modifier ToModifier(int mods) noexcept
+	{
+		if (mods == GLFW_MOD_SHIFT)
+			return Modifier::Shift;
+		if (mods == GLFW_MOD_CONTROL)
+			return Modifier::Control;
+		if (mods == GLFW_MOD_ALT)
+			return Modifier::Alt;
+		return Modifier::None;
+	}
+
+	std::uint64_t Now() noexcept
+	{
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	// Log layout, in the byte order of the machine that wrote it:
+	// header: "GINP", version, record size, cursor x, cursor y
+	// record: frame, microseconds since the recording started, type, code, action, mods, x, y
+	constexpr char s_logMagic[4] = { 'G', 'I', 'N', 'P' };
+	constexpr std::uint32_t s_logVersion = 1;
+	constexpr std::size_t s_headerSize = 20, s_recordSize = 20;
+
+	template <typename T>
+	void Write(unsigned char*& p_out, const T& value) noexcept
+	{
+		std::memcpy(p_out, &value, sizeof(T));
+		p_out += sizeof(T);
+	}
+
+	template <typename T>
+	void Read(const unsigned char*& p_in, T& value) noexcept
+	{
+		std::memcpy(&value, p_in, sizeof(T));
+		p_in += sizeof(T);
+	}
 }
 
+/* InputQueue - start ---------------------------------------------------------------------------*/
+
+bool InputQueue::Push(const InputEvent& event) noexcept
+{
+	const std::uint64_t head = m_head.load(std::memory_order_relaxed);
+	if (head - m_tail.load(std::memory_order_acquire) >= s_capacity)
+	{
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	m_events[head % s_capacity] = event;
+	m_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+bool InputQueue::Pop(InputEvent& event) noexcept
+{
+	const std::uint64_t tail = m_tail.load(std::memory_order_relaxed);
+	if (tail == m_head.load(std::memory_order_acquire))
+		return false;
+	event = m_events[tail % s_capacity];
+	m_tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+std::size_t InputQueue::Dropped() const noexcept
+{
+	return m_dropped.load(std::memory_order_relaxed);
+}
+
+/* InputQueue - end -----------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
+/* Input - start --------------------------------------------------------------------------------*/
+
 
 void Input::KeyboardCallback(void* p_window, int key, int, int action, int mod) noexcept
 {
@@ -65,85 +148,270 @@ void Input::KeyboardCallback(void* p_window, int key, int, int action, int mod)
 	{
 		glfwSetWindowShouldClose(static_cast<GLFWwindow*>(p_window), GLFW_TRUE);
 	}
+	Push(InputEvent{ Now(), InputEventType::Key, static_cast<std::uint8_t>(ToKeyboard(key)), static_cast<std::uint8_t>(action), static_cast<std::uint8_t>(mod) });
+}
+
+void Input::CursorPosCallback(void*, double x_pos, double y_pos) noexcept
+{
+	Push(InputEvent{ Now(), InputEventType::CursorPos, 0, 0, 0, glm::vec2{ x_pos, y_pos } });
+}
+
+void Input::MouseButtonCallback(void*, int button, int action, int mod) noexcept
+{
+	// Only left, right and middle are tracked
+	if (button > GLFW_MOUSE_BUTTON_MIDDLE)
+		return;
+	Push(InputEvent{ Now(), InputEventType::MouseButton, static_cast<std::uint8_t>(button), static_cast<std::uint8_t>(action), static_cast<std::uint8_t>(mod) });
+}
+
+void Input::ScrollCallback(void*, double x_offset, double y_offset) noexcept
+{
+	Push(InputEvent{ Now(), InputEventType::Scroll, 0, 0, 0, glm::vec2{ x_offset, y_offset } });
+}
+
+void Input::DragAndDropCallback(void*, int count, const char** paths) noexcept
+{
+	for (int i = 0; i < count; ++i)
+	{
+		const std::filesystem::path file_path{ paths[i] };
+		s_m_droppedPath.push_back(file_path);
+		std::cout << "[Input]: Drag and Drop detected: " << file_path << std::endl;
+	}
+}
+
+void Input::Update() noexcept
+{
+	// Movement, scroll and releases only last for the frame they happened on
+	s_m_cursorDir = glm::ivec2(0);
+	s_m_keyRelease.reset();
+	s_m_events.clear();
+
+	InputEvent event;
+	while (s_m_queue.Pop(event))
+	{
+		if (s_m_isReplaying == false)
+			s_m_events.push_back(event);
+	}
+	const std::uint64_t now = Now();
+	if (s_m_isReplaying)
+	{
+		for (; s_m_replayNext < s_m_replay.size() && s_m_replay[s_m_replayNext].frame <= s_m_logFrame; ++s_m_replayNext)
+		{
+			s_m_events.push_back(s_m_replay[s_m_replayNext].event);
+			s_m_events.back().time = now;
+		}
+	}
+	s_m_latency = s_m_events.empty() ? 0.0 : static_cast<double>(now - std::min(now, s_m_events.front().time)) * 1e-6;
 
-	if (mod == GLFW_MOD_SHIFT)
-		s_m_modifier = Modifier::Shift;
-	else if (mod == GLFW_MOD_CONTROL)
-		s_m_modifier = Modifier::Control;
-	else if (mod == GLFW_MOD_ALT)
-		s_m_modifier = Modifier::Alt;
-	else
-		s_m_modifier = Modifier::None;
-	
-	if (const int index = static_cast<int>(ToKeyboard(key)); action == GLFW_PRESS)
+	unsigned char buffer[s_recordSize];
+	for (const InputEvent& applied : s_m_events)
 	{
-		s_m_keyPress.set(index, true);
-		s_m_keyRelease.set(index, false);
+		Apply(applied);
+		if (s_m_isRecording)
+		{
+			unsigned char* p_out = buffer;
+			Write(p_out, s_m_logFrame);
+			Write(p_out, static_cast<std::uint32_t>((applied.time - std::min(applied.time, s_m_logBegin)) / 1000));
+			Write(p_out, applied.type);
+			Write(p_out, applied.code);
+			Write(p_out, applied.action);
+			Write(p_out, applied.mods);
+			Write(p_out, applied.position.x);
+			Write(p_out, applied.position.y);
+			s_m_log.write(reinterpret_cast<const char*>(buffer), s_recordSize);
+		}
 	}
-	else if (action == GLFW_RELEASE)
+
+	if (s_m_isRecording || s_m_isReplaying)
+		++s_m_logFrame;
+	if (s_m_isReplaying && s_m_replayNext >= s_m_replay.size())
 	{
-		s_m_keyPress.set(index, false);
-		s_m_keyRelease.set(index, true);
+		std::cout << "[Input]: Replay finished after " << s_m_logFrame << " frames" << std::endl;
+		StopReplay();
 	}
 }
 
-void Input::CursorPosCallback(void*, double x_pos, double y_pos) noexcept
+const std::vector<InputEvent>& Input::GetEvents() noexcept
 {
-	const glm::ivec2 pos = glm::ivec2(x_pos, s_m_windowSize.y - y_pos);
-	if (s_m_isMouseDown[0] || s_m_isMouseDown[1] || s_m_isMouseDown[2])
-		s_m_cursorDir = pos - s_m_cursor;
-	s_m_cursor = pos;
-	s_m_ray.x = 2.f * (static_cast<float>(pos.x) / static_cast<float>(s_m_windowSize.x)) - 1.f;
-	s_m_ray.y = 2.f * (static_cast<float>(pos.y) / static_cast<float>(s_m_windowSize.y)) - 1.f;
-	s_m_ray.z = -1;
+	return s_m_events;
 }
 
-void Input::MouseButtonCallback(void*, int button, int action, int mod) noexcept
+double Input::GetEventLatency() noexcept
+{
+	return s_m_latency;
+}
+
+std::size_t Input::GetDroppedEvents() noexcept
+{
+	return s_m_queue.Dropped();
+}
+
+bool Input::StartRecording(const std::filesystem::path& path) noexcept
 {
-	if (action == GLFW_RELEASE)
+	StopRecording();
+	StopReplay();
+	s_m_log.open(path, std::ios::binary | std::ios::trunc);
+	if (s_m_log.is_open() == false)
 	{
-		if (button == GLFW_MOUSE_BUTTON_LEFT)
-			s_m_isMouseDown[0] = false;
-		else if (button == GLFW_MOUSE_BUTTON_RIGHT)
-			s_m_isMouseDown[1] = false;
-		else if (button == GLFW_MOUSE_BUTTON_MIDDLE)
-			s_m_isMouseDown[2] = false;
-		s_m_modifier = Modifier::None;
-		s_m_cursorDir = glm::ivec2(0);
+		std::cout << "[Input]: Cannot write " << path.string() << std::endl;
+		return false;
 	}
-	else
+	// The first movement of a replay is measured from the cursor the recording started at
+	unsigned char header[s_headerSize];
+	unsigned char* p_out = header;
+	Write(p_out, s_logMagic);
+	Write(p_out, s_logVersion);
+	Write(p_out, static_cast<std::uint32_t>(s_recordSize));
+	Write(p_out, static_cast<float>(s_m_cursor.x));
+	Write(p_out, static_cast<float>(s_m_windowSize.y - s_m_cursor.y));
+	s_m_log.write(reinterpret_cast<const char*>(header), s_headerSize);
+	s_m_logFrame = 0;
+	s_m_logBegin = Now();
+	s_m_isRecording = true;
+	return true;
+}
+
+void Input::StopRecording() noexcept
+{
+	if (s_m_isRecording == false)
+		return;
+	s_m_log.close();
+	s_m_isRecording = false;
+}
+
+bool Input::IsRecording() noexcept
+{
+	return s_m_isRecording;
+}
+
+bool Input::StartReplay(const std::filesystem::path& path) noexcept
+{
+	StopRecording();
+	StopReplay();
+	std::ifstream file(path, std::ios::binary);
+	const std::vector<unsigned char> data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	char magic[4]{};
+	std::uint32_t version = 0, record_size = 0;
+	glm::vec2 cursor{ 0 };
+	const unsigned char* p_in = data.data();
+	if (data.size() >= s_headerSize)
+	{
+		Read(p_in, magic);
+		Read(p_in, version);
+		Read(p_in, record_size);
+		Read(p_in, cursor.x);
+		Read(p_in, cursor.y);
+	}
+	if (data.size() < s_headerSize || std::memcmp(magic, s_logMagic, sizeof(magic)) != 0 || version != s_logVersion || record_size != s_recordSize)
 	{
-		if (mod == GLFW_MOD_SHIFT)
-			s_m_modifier = Modifier::Shift;
-		else if (mod == GLFW_MOD_CONTROL)
-			s_m_modifier = Modifier::Control;
-		else if (mod == GLFW_MOD_ALT)
-			s_m_modifier = Modifier::Alt;
+		std::cout << "[Input]: " << path.string() << " is not an input log" << std::endl;
+		return false;
+	}
 
-		if (button == GLFW_MOUSE_BUTTON_LEFT)
-			s_m_isMouseDown[0] = true;
-		else if (button == GLFW_MOUSE_BUTTON_RIGHT)
-			s_m_isMouseDown[1] = true;
-		else if (button == GLFW_MOUSE_BUTTON_MIDDLE)
-			s_m_isMouseDown[2] = true;
+	const std::size_t count = (data.size() - s_headerSize) / s_recordSize;
+	s_m_replay.resize(count);
+	for (Record& record : s_m_replay)
+	{
+		std::uint32_t time = 0;
+		Read(p_in, record.frame);
+		Read(p_in, time);
+		Read(p_in, record.event.type);
+		Read(p_in, record.event.code);
+		Read(p_in, record.event.action);
+		Read(p_in, record.event.mods);
+		Read(p_in, record.event.position.x);
+		Read(p_in, record.event.position.y);
 	}
+	// Held buttons and keys of the live session would change what the log does
+	ResetState();
+	s_m_cursor = glm::ivec2(cursor.x, s_m_windowSize.y - static_cast<int>(cursor.y));
+	s_m_replayNext = 0;
+	s_m_logFrame = 0;
+	s_m_isReplaying = true;
+	return true;
 }
 
-void Input::ScrollCallback(void*, double , double y_offset) noexcept
+void Input::StopReplay() noexcept
 {
-	s_m_scroll = static_cast<int>(y_offset);
+	if (s_m_isReplaying == false)
+		return;
+	s_m_replay.clear();
+	s_m_isReplaying = false;
+	ResetState();
 }
 
-void Input::DragAndDropCallback(void*, int count, const char** paths) noexcept
+bool Input::IsReplaying() noexcept
 {
-	for (int i = 0; i < count; ++i)
+	return s_m_isReplaying;
+}
+
+void Input::Push(const InputEvent& event) noexcept
+{
+	s_m_queue.Push(event);
+}
+
+void Input::Apply(const InputEvent& event) noexcept
+{
+	switch (event.type)
 	{
-		const std::filesystem::path file_path{ paths[i] };
-		s_m_droppedPath.push_back(file_path);
-		std::cout << "[Input]: Drag and Drop detected: " << file_path << std::endl;
+	case InputEventType::Key:
+		s_m_modifier = ToModifier(event.mods);
+		if (event.code > static_cast<std::uint8_t>(Keyboard::Unknown))
+			break;
+		if (event.action == GLFW_PRESS)
+		{
+			s_m_keyPress.set(event.code, true);
+			s_m_keyRelease.set(event.code, false);
+		}
+		else if (event.action == GLFW_RELEASE)
+		{
+			s_m_keyPress.set(event.code, false);
+			s_m_keyRelease.set(event.code, true);
+		}
+		break;
+	case InputEventType::MouseButton:
+		if (event.code > GLFW_MOUSE_BUTTON_MIDDLE)
+			break;
+		if (event.action == GLFW_RELEASE)
+		{
+			s_m_isMouseDown[event.code] = false;
+			s_m_modifier = Modifier::None;
+		}
+		else
+		{
+			if (const Modifier modifier = ToModifier(event.mods); modifier != Modifier::None)
+				s_m_modifier = modifier;
+			s_m_isMouseDown[event.code] = true;
+		}
+		break;
+	case InputEventType::CursorPos:
+		{
+			const glm::ivec2 pos = glm::ivec2(event.position.x, static_cast<float>(s_m_windowSize.y) - event.position.y);
+			// Every movement of the frame adds up instead of the last one winning
+			if (s_m_isMouseDown[0] || s_m_isMouseDown[1] || s_m_isMouseDown[2])
+				s_m_cursorDir += pos - s_m_cursor;
+			s_m_cursor = pos;
+			s_m_ray.x = 2.f * (static_cast<float>(pos.x) / static_cast<float>(s_m_windowSize.x)) - 1.f;
+			s_m_ray.y = 2.f * (static_cast<float>(pos.y) / static_cast<float>(s_m_windowSize.y)) - 1.f;
+			s_m_ray.z = -1;
+		}
+		break;
+	case InputEventType::Scroll:
+		s_m_scroll += event.position.y;
+		break;
 	}
 }
 
+void Input::ResetState() noexcept
+{
+	s_m_isMouseDown[0] = s_m_isMouseDown[1] = s_m_isMouseDown[2] = false;
+	s_m_modifier = Modifier::None;
+	s_m_cursorDir = glm::ivec2(0);
+	s_m_scroll = 0.f;
+	s_m_keyPress.reset();
+	s_m_keyRelease.reset();
+}
+
 const glm::vec3& Input::GetNormalizedMousePos() noexcept
 {
 	return s_m_ray;
@@ -166,18 +434,14 @@ bool Input::IsKeyPressed(Keyboard key) noexcept
 
 bool Input::IsKeyReleased(Keyboard key) noexcept
 {
-	if (s_m_keyRelease[static_cast<int>(key)])
-	{
-		s_m_keyRelease.set(static_cast<int>(key), false);
-		return true;
-	}
-	return false;
+	return s_m_keyRelease[static_cast<int>(key)];
 }
 
 int Input::GetMouseScroll() noexcept
 {
-	const int scroll = s_m_scroll;
-	s_m_scroll = 0;
+	// Fractions of smooth scrolling are kept for the next frame
+	const int scroll = static_cast<int>(s_m_scroll);
+	s_m_scroll -= static_cast<float>(scroll);
 	return scroll;
 }
 
@@ -192,3 +456,5 @@ std::vector<std::filesystem::path> Input::GetDroppedPaths() noexcept
 	s_m_droppedPath.clear();
 	return paths;
 }
+
+/* Input - end ----------------------------------------------------------------------------------*/
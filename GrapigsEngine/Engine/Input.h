@@ -6,8 +6,12 @@
  */
 
 #pragma once
+#include <atomic>	// std::atomic
 #include <bitset>	// std::bitset
+#include <cstdint>	// std::uint64_t
 #include <filesystem>	// std::filesystem
+#include <fstream>	// std::ofstream
+#include <vector>	// std::vector
 #include <glm/glm.hpp>	// glm
 
 enum class MouseButton
@@ -30,6 +34,41 @@ enum class Keyboard
 	F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12, Unknown
 };
 
+enum class InputEventType : std::uint8_t
+{
+	Key = 0, MouseButton, CursorPos, Scroll
+};
+
+// One GLFW callback, stamped when it arrived
+struct InputEvent
+{
+	std::uint64_t time = 0;	// nanoseconds on the steady clock
+	InputEventType type = InputEventType::Key;
+	std::uint8_t code = 0;		// Keyboard or MouseButton
+	std::uint8_t action = 0;	// GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT
+	std::uint8_t mods = 0;		// GLFW_MOD_* bits
+	glm::vec2 position{ 0 };	// cursor position or scroll offsets
+};
+
+// Single producer, single consumer ring: the GLFW callbacks push and Input::Update pops, neither waits
+class InputQueue
+{
+public:
+	static constexpr std::size_t s_capacity = 1024;
+
+	// A full ring drops the event and counts it
+	bool Push(const InputEvent& event) noexcept;
+	bool Pop(InputEvent& event) noexcept;
+	[[nodiscard]] std::size_t Dropped() const noexcept;
+private:
+	InputEvent m_events[s_capacity]{};
+	alignas(64) std::atomic<std::uint64_t> m_head{ 0 };
+	alignas(64) std::atomic<std::uint64_t> m_tail{ 0 };
+	std::atomic<std::size_t> m_dropped{ 0 };
+};
+
+// Callbacks only queue events, Update applies them in order once per frame.
+// The state read by the getters is the state after the last Update.
 class Input
 {
 public:
@@ -39,6 +78,23 @@ public:
 	static void ScrollCallback(void* p_window, double x_offset, double y_offset) noexcept;
 	static void DragAndDropCallback(void* p_window, int count, const char** paths) noexcept;
 
+	// Applies the events queued since the last frame, called once per frame after polling
+	static void Update() noexcept;
+	// Events applied by the last Update, oldest first
+	[[nodiscard]] static const std::vector<InputEvent>& GetEvents() noexcept;
+	// Time from the oldest event of the last Update to the Update applying it, in milliseconds
+	[[nodiscard]] static double GetEventLatency() noexcept;
+	[[nodiscard]] static std::size_t GetDroppedEvents() noexcept;
+
+	// Writes every applied event and the frame it was applied on to a binary log
+	static bool StartRecording(const std::filesystem::path& path) noexcept;
+	static void StopRecording() noexcept;
+	[[nodiscard]] static bool IsRecording() noexcept;
+	// Applies the events of a log on the frames they were recorded on, live events are ignored meanwhile
+	static bool StartReplay(const std::filesystem::path& path) noexcept;
+	static void StopReplay() noexcept;
+	[[nodiscard]] static bool IsReplaying() noexcept;
+
 	static const glm::vec3& GetNormalizedMousePos() noexcept;
 	static glm::ivec2 GetMouseMovingDirection(MouseButton button) noexcept;
 	static Modifier GetModifier() noexcept;
@@ -51,8 +107,29 @@ public:
 
 	static glm::ivec2 s_m_windowSize;
 private:
+	static void Push(const InputEvent& event) noexcept;
+	static void Apply(const InputEvent& event) noexcept;
+	static void ResetState() noexcept;
+
+	// Log entry of one event
+	struct Record
+	{
+		std::uint32_t frame = 0;
+		InputEvent event;
+	};
+
+	static InputQueue s_m_queue;
+	static std::vector<InputEvent> s_m_events;
+	static double s_m_latency;
+	static std::ofstream s_m_log;
+	static std::vector<Record> s_m_replay;
+	static std::size_t s_m_replayNext;
+	static std::uint32_t s_m_logFrame;
+	static std::uint64_t s_m_logBegin;
+	static bool s_m_isRecording, s_m_isReplaying;
+
 	static bool s_m_isMouseDown[3];
-	static int s_m_scroll;
+	static float s_m_scroll;
 	static Modifier s_m_modifier;
 	static glm::ivec2 s_m_cursorDir;
 	static glm::ivec2 s_m_cursor;
@@ -0,0 +1,259 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: MeshSimplifier.cpp
+ *	Desc		: Quadric error metric simplification for mesh LODs
+ */
+#include "MeshSimplifier.h"
+
+#include <cstdint>			// std::uint64_t
+#include <cstring>			// std::memcmp
+#include <functional>		// std::greater
+#include <queue>			// std::priority_queue
+#include <unordered_map>	// std::unordered_map
+
+namespace
+{
+	// Symmetric 4x4 matrix summing squared distances to planes
+	struct Quadric
+	{
+		void AddPlane(const glm::dvec3& n, double d) noexcept
+		{
+			a00 += n.x * n.x; a01 += n.x * n.y; a02 += n.x * n.z; a03 += n.x * d;
+			a11 += n.y * n.y; a12 += n.y * n.z; a13 += n.y * d;
+			a22 += n.z * n.z; a23 += n.z * d;
+			a33 += d * d;
+		}
+
+		Quadric& operator+=(const Quadric& q) noexcept
+		{
+			a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+			a11 += q.a11; a12 += q.a12; a13 += q.a13;
+			a22 += q.a22; a23 += q.a23;
+			a33 += q.a33;
+			return *this;
+		}
+
+		[[nodiscard]] double Evaluate(const glm::dvec3& p) const noexcept
+		{
+			return a00 * p.x * p.x + 2 * a01 * p.x * p.y + 2 * a02 * p.x * p.z + 2 * a03 * p.x
+				+ a11 * p.y * p.y + 2 * a12 * p.y * p.z + 2 * a13 * p.y
+				+ a22 * p.z * p.z + 2 * a23 * p.z
+				+ a33;
+		}
+
+		double a00 = 0, a01 = 0, a02 = 0, a03 = 0, a11 = 0, a12 = 0, a13 = 0, a22 = 0, a23 = 0, a33 = 0;
+	};
+
+	struct Collapse
+	{
+		bool operator>(const Collapse& other) const noexcept { return cost > other.cost; }
+
+		double cost = 0;
+		unsigned from = 0, to = 0;
+		unsigned fromStamp = 0, toStamp = 0;
+	};
+
+	// What the shaders read from a vertex, face normals are per face and would split every edge
+	struct AttributeKey
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 uv;
+	};
+
+	struct AttributeHash
+	{
+		std::size_t operator()(const AttributeKey& key) const noexcept
+		{
+			const auto* bytes = reinterpret_cast<const unsigned char*>(&key);
+			std::size_t hash = 14695981039346656037ull;
+			for (std::size_t i = 0; i < sizeof(AttributeKey); ++i)
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+			return hash;
+		}
+	};
+
+	struct AttributeEqual
+	{
+		bool operator()(const AttributeKey& a, const AttributeKey& b) const noexcept
+		{
+			return std::memcmp(&a, &b, sizeof(AttributeKey)) == 0;
+		}
+	};
+
+	std::uint64_t EdgeKey(unsigned a, unsigned b) noexcept
+	{
+		if (a > b)
+			std::swap(a, b);
+		return (static_cast<std::uint64_t>(a) << 32) | b;
+	}
+}
+
+std::vector<unsigned> MeshSimplifier::Simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned>& indices, std::size_t target_index_count, float& error) noexcept
+{
+	error = 0.f;
+	const std::size_t vertex_count = vertices.size();
+
+	// Vertices that look the same share one id
+	std::vector<unsigned> canonical(vertex_count);
+	{
+		std::unordered_map<AttributeKey, unsigned, AttributeHash, AttributeEqual> lookup;
+		lookup.reserve(vertex_count);
+		for (std::size_t i = 0; i < vertex_count; ++i)
+		{
+			const Vertex& v = vertices[i];
+			const AttributeKey key{ glm::vec3{ v.position }, glm::vec3{ v.vertex_normal }, v.texture_coordinate };
+			canonical[i] = lookup.try_emplace(key, static_cast<unsigned>(i)).first->second;
+		}
+	}
+
+	std::vector<glm::uvec3> triangles;
+	triangles.reserve(indices.size() / 3);
+	for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		const glm::uvec3 t{ canonical[indices[i]], canonical[indices[i + 1]], canonical[indices[i + 2]] };
+		if (t.x != t.y && t.y != t.z && t.z != t.x)
+			triangles.push_back(t);
+	}
+
+	// Quadric of every vertex from the planes of its triangles
+	std::vector<Quadric> quadrics(vertex_count);
+	std::vector<std::vector<unsigned>> vertex_triangles(vertex_count);
+	std::unordered_map<std::uint64_t, unsigned> edge_uses;
+	edge_uses.reserve(triangles.size() * 3);
+	for (std::size_t t = 0; t < triangles.size(); ++t)
+	{
+		const glm::uvec3& tri = triangles[t];
+		const glm::dvec3 p0{ vertices[tri.x].position }, p1{ vertices[tri.y].position }, p2{ vertices[tri.z].position };
+		glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+		const double length = glm::length(n);
+		if (length > 0)
+		{
+			n /= length;
+			const double d = -glm::dot(n, p0);
+			for (int c = 0; c < 3; ++c)
+				quadrics[tri[c]].AddPlane(n, d);
+		}
+		for (int c = 0; c < 3; ++c)
+		{
+			vertex_triangles[tri[c]].push_back(static_cast<unsigned>(t));
+			edge_uses[EdgeKey(tri[c], tri[(c + 1) % 3])]++;
+		}
+	}
+
+	// Borders and attribute seams are open edges, moving them would tear the surface
+	std::vector<bool> locked(vertex_count, false);
+	for (const auto& [key, uses] : edge_uses)
+	{
+		if (uses != 2)
+		{
+			locked[static_cast<unsigned>(key >> 32)] = true;
+			locked[static_cast<unsigned>(key & 0xFFFFFFFF)] = true;
+		}
+	}
+
+	std::vector<unsigned> stamps(vertex_count, 0);
+	std::vector<bool> removed(vertex_count, false), alive(triangles.size(), true);
+	std::size_t alive_count = triangles.size();
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> heap;
+
+	const auto push_edge = [&](unsigned a, unsigned b)
+	{
+		const Quadric q = [&] { Quadric sum = quadrics[a]; sum += quadrics[b]; return sum; }();
+		Collapse best{ std::numeric_limits<double>::max(), 0, 0, 0, 0 };
+		if (locked[a] == false)
+			best = Collapse{ q.Evaluate(glm::dvec3{ vertices[b].position }), a, b, stamps[a], stamps[b] };
+		if (locked[b] == false)
+		{
+			const double cost = q.Evaluate(glm::dvec3{ vertices[a].position });
+			if (cost < best.cost)
+				best = Collapse{ cost, b, a, stamps[b], stamps[a] };
+		}
+		if (best.cost < std::numeric_limits<double>::max())
+			heap.push(best);
+	};
+
+	for (const auto& tri : triangles)
+	{
+		push_edge(tri.x, tri.y);
+		push_edge(tri.y, tri.z);
+		push_edge(tri.z, tri.x);
+	}
+
+	double max_cost = 0;
+	while (alive_count * 3 > target_index_count && heap.empty() == false)
+	{
+		const Collapse c = heap.top();
+		heap.pop();
+		if (removed[c.from] || removed[c.to] || stamps[c.from] != c.fromStamp || stamps[c.to] != c.toStamp)
+			continue;
+
+		// Reject collapses that turn a remaining triangle over
+		bool is_flipping = false;
+		const glm::dvec3 target{ vertices[c.to].position };
+		for (const unsigned t : vertex_triangles[c.from])
+		{
+			const glm::uvec3& tri = triangles[t];
+			if (alive[t] == false || tri.x == c.to || tri.y == c.to || tri.z == c.to)
+				continue;
+			glm::dvec3 p[3]{ glm::dvec3{ vertices[tri.x].position }, glm::dvec3{ vertices[tri.y].position }, glm::dvec3{ vertices[tri.z].position } };
+			const glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+			for (int k = 0; k < 3; ++k)
+				if (tri[k] == c.from)
+					p[k] = target;
+			const glm::dvec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+			if (glm::dot(before, after) <= 0.25 * glm::length(before) * glm::length(after))
+			{
+				is_flipping = true;
+				break;
+			}
+		}
+		if (is_flipping)
+			continue;
+
+		for (const unsigned t : vertex_triangles[c.from])
+		{
+			if (alive[t] == false)
+				continue;
+			glm::uvec3& tri = triangles[t];
+			if (tri.x == c.to || tri.y == c.to || tri.z == c.to)
+			{
+				alive[t] = false;
+				--alive_count;
+				continue;
+			}
+			for (int k = 0; k < 3; ++k)
+				if (tri[k] == c.from)
+					tri[k] = c.to;
+			vertex_triangles[c.to].push_back(t);
+		}
+		quadrics[c.to] += quadrics[c.from];
+		removed[c.from] = true;
+		stamps[c.to]++;
+		max_cost = std::max(max_cost, c.cost);
+
+		for (const unsigned t : vertex_triangles[c.to])
+		{
+			if (alive[t] == false)
+				continue;
+			const glm::uvec3& tri = triangles[t];
+			for (int k = 0; k < 3; ++k)
+				if (tri[k] != c.to)
+					push_edge(c.to, tri[k]);
+		}
+	}
+
+	std::vector<unsigned> result;
+	result.reserve(alive_count * 3);
+	for (std::size_t t = 0; t < triangles.size(); ++t)
+	{
+		if (alive[t] == false)
+			continue;
+		result.push_back(triangles[t].x);
+		result.push_back(triangles[t].y);
+		result.push_back(triangles[t].z);
+	}
+	error = static_cast<float>(std::sqrt(std::max(max_cost, 0.0)));
+	return result;
+}
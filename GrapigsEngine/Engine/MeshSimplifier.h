@@ -0,0 +1,19 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: MeshSimplifier.h
+ *	Desc		: Quadric error metric simplification for mesh LODs
+ */
+#pragma once
+#include <vector>	// std::vector
+
+#include "FBXImporter.h"	// Vertex
+
+class MeshSimplifier
+{
+public:
+	// Collapses the cheapest edges until at most target_index_count indices are left.
+	// Vertices are only moved onto existing vertices, so the result indexes the same vertex buffer.
+	// error receives the largest collapse error, in the units of the vertex positions.
+	static std::vector<unsigned> Simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned>& indices, std::size_t target_index_count, float& error) noexcept;
+};
@@ -0,0 +1,159 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: MeshletBuilder.cpp
+ *	Desc		: Split meshes into small clusters with bounds and normal cones
+ */
+#include "MeshletBuilder.h"
+
+#include <algorithm>		// std::max, std::min
+#include <cmath>			// std::sqrt
+#include <cstring>			// std::memcmp
+#include <limits>			// std::numeric_limits
+#include <deque>			// std::deque
+#include <unordered_map>	// std::unordered_map
+
+namespace
+{
+	struct PositionHash
+	{
+		std::size_t operator()(const glm::vec3& p) const noexcept
+		{
+			const auto* bytes = reinterpret_cast<const unsigned char*>(&p);
+			std::size_t hash = 14695981039346656037ull;
+			for (std::size_t i = 0; i < sizeof(glm::vec3); ++i)
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+			return hash;
+		}
+	};
+
+	struct PositionEqual
+	{
+		bool operator()(const glm::vec3& a, const glm::vec3& b) const noexcept
+		{
+			return std::memcmp(&a, &b, sizeof(glm::vec3)) == 0;
+		}
+	};
+}
+
+std::vector<Meshlet> MeshletBuilder::Build(const std::vector<Vertex>& vertices, std::vector<unsigned>& indices) noexcept
+{
+	std::vector<Meshlet> meshlets;
+	const std::size_t triangle_count = indices.size() / 3;
+	if (triangle_count == 0)
+		return meshlets;
+
+	// Triangles are neighbours when they touch the same position, vertices are split per face
+	std::vector<unsigned> position_ids(vertices.size());
+	{
+		std::unordered_map<glm::vec3, unsigned, PositionHash, PositionEqual> lookup;
+		lookup.reserve(vertices.size());
+		for (std::size_t i = 0; i < vertices.size(); ++i)
+			position_ids[i] = lookup.try_emplace(glm::vec3{ vertices[i].position }, static_cast<unsigned>(lookup.size())).first->second;
+	}
+	std::vector<std::vector<unsigned>> position_triangles(vertices.size());
+	for (std::size_t t = 0; t < triangle_count; ++t)
+		for (std::size_t c = 0; c < 3; ++c)
+			position_triangles[position_ids[indices[t * 3 + c]]].push_back(static_cast<unsigned>(t));
+
+	std::vector<unsigned> reordered;
+	reordered.reserve(indices.size());
+	std::vector<bool> is_used(triangle_count, false);
+	// Meshlet that last referenced a vertex, counts unique vertices without clearing a set
+	std::vector<unsigned> vertex_meshlet(vertices.size(), std::numeric_limits<unsigned>::max());
+	std::deque<unsigned> frontier;
+
+	for (std::size_t seed = 0; seed < triangle_count; ++seed)
+	{
+		if (is_used[seed])
+			continue;
+
+		const unsigned meshlet_id = static_cast<unsigned>(meshlets.size());
+		Meshlet meshlet;
+		meshlet.firstIndex = static_cast<unsigned>(reordered.size());
+		std::size_t vertex_count = 0, triangles = 0;
+		frontier.clear();
+		frontier.push_back(static_cast<unsigned>(seed));
+
+		while (frontier.empty() == false && triangles < s_maxTriangles)
+		{
+			const unsigned t = frontier.front();
+			frontier.pop_front();
+			if (is_used[t])
+				continue;
+
+			std::size_t new_vertices = 0;
+			for (std::size_t c = 0; c < 3; ++c)
+				if (vertex_meshlet[indices[t * 3 + c]] != meshlet_id)
+					++new_vertices;
+			if (vertex_count + new_vertices > s_maxVertices)
+				break;
+
+			is_used[t] = true;
+			++triangles;
+			for (std::size_t c = 0; c < 3; ++c)
+			{
+				const unsigned v = indices[t * 3 + c];
+				if (vertex_meshlet[v] != meshlet_id)
+				{
+					vertex_meshlet[v] = meshlet_id;
+					++vertex_count;
+				}
+				reordered.push_back(v);
+				for (const unsigned neighbour : position_triangles[position_ids[v]])
+					if (is_used[neighbour] == false)
+						frontier.push_back(neighbour);
+			}
+		}
+
+		meshlet.indexCount = static_cast<unsigned>(reordered.size()) - meshlet.firstIndex;
+		ComputeBounds(vertices, reordered.data() + meshlet.firstIndex, meshlet);
+		meshlets.push_back(meshlet);
+	}
+
+	indices = std::move(reordered);
+	return meshlets;
+}
+
+void MeshletBuilder::ComputeBounds(const std::vector<Vertex>& vertices, const unsigned* indices, Meshlet& meshlet) noexcept
+{
+	Bounds bounds;
+	glm::vec3 normal_sum{ 0 };
+	for (unsigned i = 0; i < meshlet.indexCount; i += 3)
+	{
+		const glm::vec3 p0{ vertices[indices[i]].position }, p1{ vertices[indices[i + 1]].position }, p2{ vertices[indices[i + 2]].position };
+		bounds.Expand(p0);
+		bounds.Expand(p1);
+		bounds.Expand(p2);
+		// Area weighted, degenerate triangles do not count
+		normal_sum += glm::cross(p1 - p0, p2 - p0);
+	}
+
+	const glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+	float radius_sq = 0.f;
+	for (unsigned i = 0; i < meshlet.indexCount; ++i)
+	{
+		const glm::vec3 d = glm::vec3{ vertices[indices[i]].position } - center;
+		radius_sq = std::max(radius_sq, glm::dot(d, d));
+	}
+	meshlet.sphere = glm::vec4{ center, std::sqrt(radius_sq) };
+
+	// Normal cone, the widest angle between the average normal and a face normal
+	meshlet.cone = glm::vec4{ 0, 0, 0, 2 };
+	const float length = glm::length(normal_sum);
+	if (length <= 0.f)
+		return;
+	const glm::vec3 axis = normal_sum / length;
+	float min_cos = 1.f;
+	for (unsigned i = 0; i < meshlet.indexCount; i += 3)
+	{
+		const glm::vec3 p0{ vertices[indices[i]].position }, p1{ vertices[indices[i + 1]].position }, p2{ vertices[indices[i + 2]].position };
+		const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+		const float n_length = glm::length(n);
+		if (n_length > 0.f)
+			min_cos = std::min(min_cos, glm::dot(n / n_length, axis));
+	}
+	// Spread of 90 degrees or more can always face the camera
+	if (min_cos > 0.f)
+		meshlet.cone = glm::vec4{ axis, std::sqrt(std::max(0.f, 1.f - min_cos * min_cos)) };
+}
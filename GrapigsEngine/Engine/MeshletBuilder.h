@@ -0,0 +1,22 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: MeshletBuilder.h
+ *	Desc		: Split meshes into small clusters with bounds and normal cones
+ */
+#pragma once
+#include <vector>	// std::vector
+
+#include "FBXImporter.h"	// Vertex, Meshlet
+
+class MeshletBuilder
+{
+public:
+	static constexpr std::size_t s_maxVertices = 64;
+	static constexpr std::size_t s_maxTriangles = 124;
+
+	// Grows clusters over neighbouring triangles and reorders indices so every cluster is one contiguous range
+	static std::vector<Meshlet> Build(const std::vector<Vertex>& vertices, std::vector<unsigned>& indices) noexcept;
+private:
+	static void ComputeBounds(const std::vector<Vertex>& vertices, const unsigned* indices, Meshlet& meshlet) noexcept;
+};
@@ -0,0 +1,155 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: RenderQueue.cpp
+ *	Desc		: Draw packets sorted by state and a cache of the bound state
+ */
+#include "RenderQueue.h"
+
+#include <algorithm>	// std::clamp, std::find_if
+#include <gl/glew.h>	// gl functions
+
+#include "FBXImporter.h"	// Material
+#include "GLState.h"	// GLState
+#include "Shader.h"	// ShaderProgram
+
+/* RenderQueue - start --------------------------------------------------------------------------*/
+
+std::uint64_t RenderQueue::MakeKey(RenderPass pass, unsigned program, unsigned variant, unsigned material, unsigned vao, float depth) noexcept
+{
+	constexpr auto field = [](std::uint64_t value, unsigned bits)
+	{
+		return value & ((std::uint64_t{ 1 } << bits) - 1);
+	};
+	const float depth_max = static_cast<float>((1u << s_depthBits) - 1);
+	const auto quantized = static_cast<std::uint64_t>(std::clamp(depth, 0.f, 1.f) * depth_max);
+
+	std::uint64_t key = field(static_cast<unsigned>(pass), s_passBits);
+	key = (key << s_programBits) | field(program, s_programBits);
+	key = (key << s_variantBits) | field(variant, s_variantBits);
+	key = (key << s_materialBits) | field(material, s_materialBits);
+	key = (key << s_vaoBits) | field(vao, s_vaoBits);
+	key = (key << s_depthBits) | field(quantized, s_depthBits);
+	return key;
+}
+
+void RenderQueue::Clear() noexcept
+{
+	m_packets.clear();
+	m_materials.clear();
+}
+
+void RenderQueue::Push(const DrawPacket& packet) noexcept
+{
+	m_packets.push_back(packet);
+}
+
+void RenderQueue::Sort() noexcept
+{
+	if (m_packets.size() < 2)
+		return;
+
+	// Least significant byte first, every pass is stable
+	m_scratch.resize(m_packets.size());
+	for (unsigned shift = 0; shift < 64; shift += 8)
+	{
+		std::size_t counts[256]{};
+		for (const auto& packet : m_packets)
+			++counts[(packet.key >> shift) & 0xFF];
+		if (counts[(m_packets.front().key >> shift) & 0xFF] == m_packets.size())
+			continue;
+
+		std::size_t offset = 0;
+		for (auto& count : counts)
+		{
+			const std::size_t bucket = count;
+			count = offset;
+			offset += bucket;
+		}
+		for (const auto& packet : m_packets)
+			m_scratch[counts[(packet.key >> shift) & 0xFF]++] = packet;
+		m_packets.swap(m_scratch);
+	}
+}
+
+unsigned RenderQueue::GetMaterialId(const Material& material) noexcept
+{
+	const auto it = std::find_if(m_materials.begin(), m_materials.end(), [&material](const Material* p_other)
+		{
+			return p_other->HasSameTextures(material);
+		});
+	if (it != m_materials.end())
+		return static_cast<unsigned>(it - m_materials.begin());
+	m_materials.push_back(&material);
+	return static_cast<unsigned>(m_materials.size() - 1);
+}
+
+const std::vector<DrawPacket>& RenderQueue::GetPackets() const noexcept
+{
+	return m_packets;
+}
+
+/* RenderQueue - end ----------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
+/* StateCache - start ---------------------------------------------------------------------------*/
+
+void StateCache::BeginFrame() noexcept
+{
+	m_stats = StateCacheStats{};
+}
+
+bool StateCache::UseProgram(ShaderProgram* program) noexcept
+{
+	if (program == m_p_program)
+	{
+		++m_stats.skipped;
+		return false;
+	}
+	program->Use();
+	m_p_program = program;
+	// Material uniforms belong to the program, the new one may hold any material
+	m_p_material = nullptr;
+	++m_stats.programs;
+	return true;
+}
+
+void StateCache::BindVertexArray(unsigned vao) noexcept
+{
+	if (vao == m_vao)
+	{
+		++m_stats.skipped;
+		return;
+	}
+	GLState::BindVertexArray(vao);
+	m_vao = vao;
+	++m_stats.vertexArrays;
+}
+
+void StateCache::SendMaterial(const Material& material) noexcept
+{
+	if (m_p_program == nullptr)
+		return;
+	if (m_p_material && m_p_material->HasSameTextures(material))
+	{
+		++m_stats.skipped;
+		return;
+	}
+	material.SendTextures(m_p_program);
+	m_p_material = &material;
+	++m_stats.materials;
+}
+
+void StateCache::Reset() noexcept
+{
+	// The bindings stay, GLState skips them if the next pass binds the same ones
+	m_vao = 0;
+	m_p_program = nullptr;
+	m_p_material = nullptr;
+}
+
+const StateCacheStats& StateCache::GetStats() const noexcept
+{
+	return m_stats;
+}
+
+/* StateCache - end -----------------------------------------------------------------------------*/
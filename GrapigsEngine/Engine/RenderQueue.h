@@ -0,0 +1,74 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: RenderQueue.h
+ *	Desc		: Draw packets sorted by state and a cache of the bound state
+ */
+#pragma once
+#include <cstddef>	// std::size_t
+#include <cstdint>	// std::uint64_t
+#include <vector>	// std::vector
+
+class ShaderProgram;
+struct Material;
+
+enum class RenderPass
+{
+	Shadow, Depth, Opaque
+};
+
+// One draw group of a batch
+struct DrawPacket
+{
+	std::uint64_t key = 0;
+	unsigned batch = 0;
+	unsigned group = 0;
+};
+
+class RenderQueue
+{
+public:
+	// Fields of the sort key from the most significant bits: pass, program, variant, material, VAO, depth.
+	// The variant is the program's ShaderFeature bits, draws of one variant are submitted together.
+	static constexpr unsigned s_passBits = 4, s_programBits = 12, s_variantBits = 4, s_materialBits = 12, s_vaoBits = 12, s_depthBits = 20;
+
+	// depth in [0, 1], smaller values are drawn first
+	[[nodiscard]] static std::uint64_t MakeKey(RenderPass pass, unsigned program, unsigned variant, unsigned material, unsigned vao, float depth) noexcept;
+
+	void Clear() noexcept;
+	void Push(const DrawPacket& packet) noexcept;
+	// Radix sort on the key bytes, bytes shared by every key are skipped
+	void Sort() noexcept;
+	// Same id for materials sharing their textures, valid until Clear
+	[[nodiscard]] unsigned GetMaterialId(const Material& material) noexcept;
+	[[nodiscard]] const std::vector<DrawPacket>& GetPackets() const noexcept;
+private:
+	std::vector<DrawPacket> m_packets, m_scratch;
+	std::vector<const Material*> m_materials;
+};
+
+struct StateCacheStats
+{
+	std::size_t programs = 0, vertexArrays = 0, materials = 0;
+	std::size_t skipped = 0;
+};
+
+// Skips program, VAO and material changes to what is already bound
+class StateCache
+{
+public:
+	void BeginFrame() noexcept;
+	// Returns true when the program changed, its per-program inputs have to be sent
+	bool UseProgram(ShaderProgram* program) noexcept;
+	void BindVertexArray(unsigned vao) noexcept;
+	// Samplers of the material, sent to the bound program
+	void SendMaterial(const Material& material) noexcept;
+	// Forgets the cached state, the next calls bind again
+	void Reset() noexcept;
+	[[nodiscard]] const StateCacheStats& GetStats() const noexcept;
+private:
+	ShaderProgram* m_p_program = nullptr;
+	unsigned m_vao = 0;
+	const Material* m_p_material = nullptr;
+	StateCacheStats m_stats;
+};
@@ -6,58 +6,151 @@
  */
 #include "ResourceManager.h"
 
+#include <algorithm>    // std::max
+#include <cmath>    // std::sqrt
 #include <iostream>
+#include <limits>   // std::numeric_limits
 #include <ranges>   // std::views::
 
 #include "Camera.h"
+#include "CPUProfiler.h"     // PROFILE_FUNCTION
+#include "FrameCapture.h"    // FrameCapture
+#include "GLState.h"        // GLState
+#include "GPUCulling.h"
+#include "GPUProfiler.h"     // GPUProfileScope
+#include "GPUTimer.h"      // GPUTimer
 #include "Input.h"
+#include "ShadowMaps.h"     // ShadowMaps
+#include "UniformRing.h"    // UniformRing
+#include "World.h"
 
  /* Light - start --------------------------------------------------------------------------------*/
 
+namespace
+{
+    // LightInformation of test.frag and lightcluster.comp (std140)
+    struct LightInformationBlock
+    {
+        unsigned lightNum;
+        float padding[3];
+    };
+
+    constexpr unsigned s_clusterGroupSize = 128;  // local_size_x of lightcluster.comp
+}
+
 Lights::Lights() noexcept
 {
-    GLsizeiptr size = 128 * 16 + 16;// 16 * (sizeof(unsigned) + 5 * sizeof(glm::vec3) + 3 * sizeof(float)) + sizeof(unsigned)+3 * sizeof(float) + 3 * sizeof(glm::vec3);
-    glGenBuffers(1, &m_ubo);
-    glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
-    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
-    glBindBufferRange(GL_UNIFORM_BUFFER, 1, m_ubo, 0, size);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    const std::vector<std::pair<ShaderType, std::filesystem::path>> files = {
+        std::make_pair(ShaderType::Compute, "shader/lightcluster.comp")
+    };
+    m_cluster = new ShaderProgram(files);
+    m_cluster->m_name = "lightcluster";
+
+    constexpr GLsizeiptr cluster_count = Lights::s_clusterX * Lights::s_clusterY * Lights::s_clusterZ;
+    glCreateBuffers(1, &m_lightBuffer);
+    glCreateBuffers(1, &m_gridBuffer);
+    glCreateBuffers(1, &m_indexBuffer);
+    glNamedBufferStorage(m_gridBuffer, cluster_count * static_cast<GLsizeiptr>(sizeof(unsigned)), nullptr, 0);
+    glNamedBufferStorage(m_indexBuffer, cluster_count * s_maxLightsPerCluster * static_cast<GLsizeiptr>(sizeof(unsigned)), nullptr, 0);
 }
 
 Lights::~Lights() noexcept
 {
-    glDeleteBuffers(1, &m_ubo);
+    delete m_cluster;
+    m_cluster = nullptr;
+    GLState::DeleteBuffers(1, &m_lightBuffer);
+    GLState::DeleteBuffers(1, &m_gridBuffer);
+    GLState::DeleteBuffers(1, &m_indexBuffer);
+    m_lightBuffer = m_gridBuffer = m_indexBuffer = 0;
 }
 
 void Lights::Update()
 {
-    glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
-    auto lightnumber = static_cast<unsigned>(lights.size());
-    GLsizeiptr lightstride = 128;// (sizeof(unsigned) + 5 * sizeof(glm::vec3) + 3 * sizeof(float));
-    int iter = 0;
-
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(unsigned), &lightnumber);
-
-    for (auto light : lights)
+    PROFILE_FUNCTION();
+    const GPUProfileScope profile("Lights");
+    // Every light is written with one call, whatever the count
+    m_data.resize(lights.size());
+    bool has_directional_shadow = false;
+    unsigned spot_shadows = 0;
+    for (std::size_t i = 0; i < lights.size(); ++i)
     {
-        glBufferSubData(GL_UNIFORM_BUFFER, 16 + iter * lightstride, sizeof(unsigned), &(light.m_type));
-        glBufferSubData(GL_UNIFORM_BUFFER, 16 + iter * lightstride + 16, sizeof(glm::vec3), &light.m_direction[0]);
-        glBufferSubData(GL_UNIFORM_BUFFER, 16 + iter * lightstride + 32, sizeof(glm::vec3), &light.m_transform.GetPosition()[0]);
-        glBufferSubData(GL_UNIFORM_BUFFER, 16 + iter * lightstride + 48, sizeof(glm::vec3), &light.m_ambient);
-        glBufferSubData(GL_UNIFORM_BUFFER, 16 + iter * lightstride + 64, sizeof(glm::vec3), &light.m_diffuse);
-        glBufferSubData(GL_UNIFORM_BUFFER, 16 + iter * lightstride + 80, sizeof(glm::vec3), &light.m_specular);
-        glBufferSubData(GL_UNIFORM_BUFFER, 16 + iter * lightstride + 96, sizeof(glm::vec3), &light.m_attenuation[0]);
-        glBufferSubData(GL_UNIFORM_BUFFER, 16 + iter * lightstride + 108, sizeof(float), &light.m_inner_angle);
-        glBufferSubData(GL_UNIFORM_BUFFER, 16 + iter * lightstride + 112, sizeof(float), &light.m_outer_angle);
-        glBufferSubData(GL_UNIFORM_BUFFER, 16 + iter * lightstride + 116, sizeof(float), &light.m_falloff);
-        iter++;
+        const Light& light = lights[i];
+        LightData& data = m_data[i];
+        data.type = static_cast<unsigned>(light.m_type);
+        data.shadow = -1;
+        if (light.m_type == LightType::DIRECTIONAL && has_directional_shadow == false)
+        {
+            data.shadow = 0;
+            has_directional_shadow = true;
+        }
+        else if (light.m_type == LightType::SPOT && spot_shadows < s_maxSpotShadows)
+            data.shadow = static_cast<int>(spot_shadows++);
+        data.direction = glm::vec4{ light.m_direction, 0 };
+        data.position = glm::vec4{ light.m_transform.GetPosition(), Range(light) };
+        data.ambient = glm::vec4{ light.m_ambient, 0 };
+        data.diffuse = glm::vec4{ light.m_diffuse, 0 };
+        data.specular = glm::vec4{ light.m_specular, 0 };
+        data.attenuation = light.m_attenuation;
+        data.innerAngle = light.m_inner_angle;
+        data.outerAngle = light.m_outer_angle;
+        data.falloff = light.m_falloff;
     }
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    if (m_data.size() > m_lightCapacity)
+    {
+        m_lightCapacity = std::max(m_data.size(), m_lightCapacity * 2);
+        glNamedBufferData(m_lightBuffer, static_cast<GLsizeiptr>(sizeof(LightData) * m_lightCapacity), nullptr, GL_DYNAMIC_DRAW);
+    }
+    if (m_data.empty() == false)
+        glNamedBufferSubData(m_lightBuffer, 0, static_cast<GLsizeiptr>(sizeof(LightData) * m_data.size()), m_data.data());
+
+    const LightInformationBlock block{ static_cast<unsigned>(m_data.size()), {} };
+    UniformRing::Bind(1, &block, sizeof(block));
+    // An empty light buffer cannot be bound
+    if (m_lightCapacity > 0)
+        GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, m_lightBuffer);
+    GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 12, m_gridBuffer);
+    GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, m_indexBuffer);
+
+    // Froxels follow the camera bound for this frame
+    const Camera* camera = CameraBuffer::GetMainCamera();
+    m_cluster->Use();
+    m_cluster->SendUniform("u_NDCToCamera", glm::inverse(camera->GetCameraToNDCMatrix()));
+    constexpr unsigned cluster_count = s_clusterX * s_clusterY * s_clusterZ;
+    glDispatchCompute((cluster_count + s_clusterGroupSize - 1) / s_clusterGroupSize, 1, 1);
+    m_cluster->UnUse();
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 }
 
 void Lights::AddLight(Light light)
 {
-    lights.push_back(light);
+    lights.push_back(std::move(light));
+}
+
+std::size_t Lights::Size() const noexcept
+{
+    return lights.size();
+}
+
+const std::vector<LightData>& Lights::GetData() const noexcept
+{
+    return m_data;
+}
+
+float Lights::Range(const Light& light) noexcept
+{
+    if (light.m_type == LightType::DIRECTIONAL)
+        return std::numeric_limits<float>::max();
+
+    // Solve c0 + c1 * d + c2 * d^2 = 256 * brightest channel
+    const glm::vec3& c = light.m_attenuation;
+    const float target = 256.f * std::max(light.m_diffuse.x, std::max(light.m_diffuse.y, light.m_diffuse.z)) - c.x;
+    if (target <= 0.f)
+        return 0.f;
+    if (c.z > 0.f)
+        return (-c.y + std::sqrt(c.y * c.y + 4.f * c.z * target)) / (2.f * c.z);
+    if (c.y > 0.f)
+        return target / c.y;
+    return std::numeric_limits<float>::max();
 }
 
 /* Light - end ----------------------------------------------------------------------------------*/
@@ -89,31 +182,27 @@ Grid::Grid(float size, std::size_t divide) noexcept
     glCreateBuffers(1, &m_vbo);
     glNamedBufferStorage(m_vbo, static_cast<GLsizeiptr>(sizeof(glm::vec3) * m_position.size()), m_position.data(), GL_DYNAMIC_STORAGE_BIT);
     glCreateVertexArrays(1, &m_vao);
-    glBindVertexArray(m_vao);
 
     // Vertex Position
     glEnableVertexArrayAttrib(m_vao, 0);
     glVertexArrayVertexBuffer(m_vao, 0, m_vbo, 0, sizeof(glm::vec3));
     glVertexArrayAttribFormat(m_vao, 0, 3, GL_FLOAT, GL_FALSE, 0);
     glVertexArrayAttribBinding(m_vao, 0, 0);
-
-    glBindVertexArray(0);
 }
 
 Grid::~Grid() noexcept
 {
     delete m_program;
-    glDeleteVertexArrays(1, &m_vao);
-    glDeleteBuffers(1, &m_vbo);
+    GLState::DeleteVertexArrays(1, &m_vao);
+    GLState::DeleteBuffers(1, &m_vbo);
 }
 
 void Grid::Draw() const noexcept
 {
     m_program->Use();
-    glBindVertexArray(m_vao);
+    GLState::BindVertexArray(m_vao);
     m_program->SendUniform("u_color", m_color);
     glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(m_position.size()));
-    glBindVertexArray(0);
     m_program->UnUse();
 }
 
@@ -145,15 +234,24 @@ void Object::Draw(Primitive primitive, const std::map<TextureType, unsigned>& te
 
 FrameBufferObject* ResourceManager::m_fbo = new FrameBufferObject();
 FrameBufferObject_PreFilterMap* ResourceManager::m_fbo_prefiltermap = new FrameBufferObject_PreFilterMap();
+std::map<std::filesystem::path, std::future<ImageData>> ResourceManager::s_m_prefetched;
 ResourceManager::ResourceManager() :
     m_grid(new Grid(3, 10)),
-    m_object(nullptr),
+    m_world(new World()),
+    m_instances(new InstanceBuffer()),
+    m_gpuCulling(new GPUCulling()),
+    m_shadows(new ShadowMaps()),
+    m_sceneTimers{ new GPUTimer(), new GPUTimer() },
+    m_queue(new RenderQueue()),
+    m_capture(new FrameCapture()),
+    m_stateCache(new StateCache()),
     m_skybox(nullptr),
     m_cube(nullptr),
     m_brdf("texture/brdf.png"),
     m_hdr("texture/skybox/BasketballCourt_3k.hdr", false, true),
     m_environment("texture/skybox/BasketballCourt_8k.jpg"),
-    m_irradiance("texture/skybox/BasketballCourt_Env.hdr", false, true)
+    m_irradiance("texture/skybox/BasketballCourt_Env.hdr", false, true),
+    m_selected()
 {
     const glm::ivec2& size = Input::s_m_windowSize;
     m_fbo->Init(size.x, size.y);
@@ -165,7 +263,7 @@ ResourceManager::ResourceManager() :
     m_texUnit[TextureType::BRDF] = m_brdf.Unit();
     m_texUnit[TextureType::Environment] = m_environment.Unit();
 
-    glDepthFunc(GL_LEQUAL);
+    GLState::DepthFunc(GL_LEQUAL);
     CreateSkyBox();
 
     m_cube = new Object();
@@ -245,8 +343,28 @@ void ResourceManager::Clear() noexcept
     for (auto& t : m_textures)
         delete t.second;
     m_textures.clear();
-    delete m_object;
-    m_object = nullptr;
+    delete m_world;
+    m_world = nullptr;
+    delete m_instances;
+    m_instances = nullptr;
+    delete m_gpuCulling;
+    m_gpuCulling = nullptr;
+    delete m_shadows;
+    m_shadows = nullptr;
+    if (m_skyVao > 0)
+        GLState::DeleteVertexArrays(1, &m_skyVao);
+    m_skyVao = 0;
+    for (auto& timer : m_sceneTimers)
+    {
+        delete timer;
+        timer = nullptr;
+    }
+    delete m_capture;
+    m_capture = nullptr;
+    delete m_queue;
+    m_queue = nullptr;
+    delete m_stateCache;
+    m_stateCache = nullptr;
     m_fbo->Clear();
     delete m_fbo;
     m_fbo = nullptr;
@@ -283,6 +401,14 @@ unsigned ResourceManager::LoadTexture(const char* path) noexcept
     if (texture)
         return texture->m_tag;
 
+    // Pixels decoded by PrefetchTextures are only uploaded
+    if (const auto prefetched = s_m_prefetched.find(file_path); prefetched != s_m_prefetched.end())
+    {
+        const ImageData image = prefetched->second.get();
+        s_m_prefetched.erase(prefetched);
+        return LoadTexture(file_path, image);
+    }
+
     // Load texture
     texture = new Texture(path);
     if(texture->m_initialized)
@@ -296,6 +422,32 @@ unsigned ResourceManager::LoadTexture(const char* path) noexcept
     return ERROR_INDEX;
 }
 
+unsigned ResourceManager::LoadTexture(const std::filesystem::path& path, const ImageData& image) noexcept
+{
+    if (const Texture* texture = GetTexture(path))
+        return texture->m_tag;
+
+    auto* texture = new Texture(path, image);
+    if (texture->m_initialized)
+    {
+        const auto tag = static_cast<unsigned>(m_textures.size());
+        const_cast<unsigned&>(texture->m_tag) = tag;
+        m_textures[tag] = texture;
+        return tag;
+    }
+    delete texture;
+    return ERROR_INDEX;
+}
+
+void ResourceManager::PrefetchTextures(const std::vector<std::filesystem::path>& paths) noexcept
+{
+    for (const std::filesystem::path& path : paths)
+    {
+        if (s_m_prefetched.contains(path) == false)
+            s_m_prefetched.emplace(path, std::async(std::launch::async, [path] { return Texture::Decode(path); }));
+    }
+}
+
 unsigned ResourceManager::LoadShaders(const std::vector<std::pair<ShaderType, std::filesystem::path>>& paths) noexcept
 {
     auto* program = new ShaderProgram(paths);
@@ -326,6 +478,12 @@ Texture* ResourceManager::GetTexture(const std::filesystem::path& path) const no
     return nullptr;
 }
 
+Model* ResourceManager::GetModel(unsigned tag) const noexcept
+{
+    const auto found = m_models.find(tag);
+    return found != m_models.end() ? found->second : nullptr;
+}
+
 Texture* ResourceManager::GetTexture(const unsigned tag) noexcept
 {
     if (tag != ERROR_INDEX && m_textures.contains(tag))
@@ -335,43 +493,84 @@ Texture* ResourceManager::GetTexture(const unsigned tag) noexcept
 
 Object* ResourceManager::CreateObject(unsigned mesh, unsigned shader, unsigned t_albedo, unsigned t_metallic, unsigned t_roughness) noexcept
 {
-    delete m_object;
-    m_object = new Object();
+    const ObjectHandle handle = m_world->Create();
+    Object* object = m_world->Get(handle);
     if(m_models.contains(mesh))
-	    m_object->m_p_model = m_models[mesh];
+	    object->m_p_model = m_models[mesh];
     if(m_shaders.contains(shader))
-	    m_object->m_p_shader = m_shaders[shader];
-    if (m_textures.contains(t_albedo))
+	    object->m_p_shader = m_shaders[shader];
+    if (object->m_p_model)
     {
-        auto& meshes = m_object->m_p_model->m_meshes;
-        for (std::size_t i = 1; i < meshes.size(); ++i)
-            meshes[i].material.t_albedo = m_textures[t_albedo];
+        ApplyTextures(object->m_p_model, t_albedo, t_metallic, t_roughness);
+        object->m_name = object->m_p_model->m_name;
     }
-    if (m_textures.contains(t_metallic))
+
+    m_selected = handle;
+    return object;
+}
+
+void ResourceManager::ApplyTextures(Model* p_model, unsigned t_albedo, unsigned t_metallic, unsigned t_roughness) noexcept
+{
+    if (p_model == nullptr)
+        return;
+    auto& meshes = p_model->m_meshes;
+    for (std::size_t i = 1; i < meshes.size(); ++i)
     {
-        auto& meshes = m_object->m_p_model->m_meshes;
-        for (std::size_t i = 1; i < meshes.size(); ++i)
+        if (m_textures.contains(t_albedo))
+            meshes[i].material.t_albedo = m_textures[t_albedo];
+        if (m_textures.contains(t_metallic))
             meshes[i].material.t_metallic = m_textures[t_metallic];
-    }
-    if (m_textures.contains(t_roughness))
-    {
-        auto& meshes = m_object->m_p_model->m_meshes;
-        for (std::size_t i = 1; i < meshes.size(); ++i)
+        if (m_textures.contains(t_roughness))
             meshes[i].material.t_roughness = m_textures[t_roughness];
     }
-
-    return  m_object;
 }
 
 Object* ResourceManager::CreateObject(const char* path) noexcept
 {
-    auto tag = LoadFbx(path);
+    const auto tag = LoadFbx(path);
     if(tag != ERROR_INDEX)
     {
-        auto shader = m_object->m_p_shader->m_tag;
-        CreateObject(tag, shader, ERROR_INDEX);
+        // New object uses the program of the selected one
+        const Object* selected = GetSelectedObject();
+        const unsigned shader = (selected && selected->m_p_shader) ? selected->m_p_shader->m_tag : 0;
+        return CreateObject(tag, shader, ERROR_INDEX);
     }
-    return m_object;
+    return GetSelectedObject();
+}
+
+void ResourceManager::SelectObject(const Object* p_object) noexcept
+{
+    if (p_object == nullptr)
+    {
+        m_selected = ObjectHandle{};
+        return;
+    }
+    m_selected = m_world->GetHandle(static_cast<std::size_t>(p_object - m_world->Objects().data()));
+}
+
+Object* ResourceManager::GetSelectedObject() const noexcept
+{
+    return m_world->Get(m_selected);
+}
+
+World* ResourceManager::GetWorld() const noexcept
+{
+    return m_world;
+}
+
+void ResourceManager::SetLights(Lights* p_lights) noexcept
+{
+    m_p_lights = p_lights;
+}
+
+ShadowMaps* ResourceManager::GetShadowMaps() const noexcept
+{
+    return m_shadows;
+}
+
+FrameCapture* ResourceManager::GetFrameCapture() const noexcept
+{
+    return m_capture;
 }
 
 void ResourceManager::CreateSkyBox() noexcept
@@ -384,31 +583,264 @@ void ResourceManager::CreateSkyBox() noexcept
             std::make_pair(ShaderType::Fragment, "shader/skybox.frag")
     };
     m_skybox->m_p_shader = m_shaders[LoadShaders(shader_files)];
-  
+
+    const std::vector<std::pair<ShaderType, std::filesystem::path>> sky_files = {
+            std::make_pair(ShaderType::Vertex, "shader/sky.vert"),
+            std::make_pair(ShaderType::Fragment, "shader/skybox.frag")
+    };
+    m_sky = m_shaders[LoadShaders(sky_files)];
+    if (m_skyVao == 0)
+        glCreateVertexArrays(1, &m_skyVao);
 }
 
 void ResourceManager::DrawSkyBox() const noexcept
 {
-    m_skybox->Draw(Primitive::Triangles, m_texUnit);
+    // Both skies are at the far plane (z = w), drawn after the opaque geometry with GL_LEQUAL
+    // only the pixels nothing covered run skybox.frag
+    GLState::DepthMask(false);
+    if (m_isFullscreenSky)
+    {
+        m_sky->Use();
+        m_sky->SendUniform("t_environment", m_texUnit.find(TextureType::Environment)->second);
+        GLState::BindVertexArray(m_skyVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        m_sky->UnUse();
+    }
+    else
+        m_skybox->Draw(Primitive::Triangles, m_texUnit);
+    GLState::DepthMask(true);
 }
 
 
 void ResourceManager::DrawLines() const noexcept
 {
+    PrepareWorld();
+    const Camera* camera = CameraBuffer::GetMainCamera();
+    CullWorld(camera ? camera->GetFrustum() : Frustum{}, false);
+
     m_grid->Draw();
-    m_object->Draw(Primitive::LineLoop, m_texUnit);
+    QueueBatches(RenderPass::Opaque);
+    SubmitQueue(RenderPass::Opaque, Primitive::LineLoop);
 }
 
 void ResourceManager::DrawTriangles() const noexcept
 {
+    PROFILE_FUNCTION();
+    {
+        const GPUProfileScope profile("Prepare");
+        PrepareWorld();
+    }
+    DrawShadows();
+    // Zero planes of a default frustum accept everything
+    const Camera* camera = CameraBuffer::GetMainCamera();
+    {
+        const GPUProfileScope profile("Culling");
+        CullWorld(camera ? camera->GetFrustum() : Frustum{}, false);
+    }
+
     m_fbo->Bind();
-    glDepthMask(GL_FALSE);
-    DrawSkyBox();
-    glDepthMask(GL_TRUE);
+    // The sky is drawn last and only covers pixels no geometry covered, the clear keeps the previous frame out of them
+    glClear(GL_COLOR_BUFFER_BIT);
+    const bool is_prepass = m_isDepthPrepass;
+    GPUTimer* timer = m_sceneTimers[is_prepass ? 1 : 0];
+    GPUProfiler::Begin("Scene");
+    timer->Begin();
+    if (is_prepass)
+    {
+        // Positions only, the shading pass below reuses the same culling results
+        const GPUProfileScope profile("Depth Prepass");
+        QueueBatches(RenderPass::Depth);
+        SubmitQueue(RenderPass::Depth, Primitive::Triangles);
+    }
 
-    m_grid->Draw();
-    m_object->Draw(Primitive::Triangles, m_texUnit);
+    {
+        const GPUProfileScope profile("Grid");
+        if (m_isGridVisible)
+            m_grid->Draw();
+    }
+    if (is_prepass)
+    {
+        // test.vert and shadow.vert compute an invariant position, so the visible fragment matches exactly
+        GLState::DepthFunc(GL_EQUAL);
+        GLState::DepthMask(false);
+    }
+    {
+        const GPUProfileScope profile("Opaque");
+        QueueBatches(RenderPass::Opaque);
+        SubmitQueue(RenderPass::Opaque, Primitive::Triangles);
+    }
+    if (is_prepass)
+    {
+        GLState::DepthFunc(GL_LEQUAL);
+        GLState::DepthMask(true);
+    }
+    {
+        const GPUProfileScope profile("Sky");
+        DrawSkyBox();
+    }
+    timer->End();
+    GPUProfiler::End();
     m_fbo->UnBind();
+
+    if (m_world->m_isGPUCulling && m_world->m_isOcclusionCulling && camera)
+    {
+        const GPUProfileScope profile("Depth Pyramid");
+        m_gpuCulling->BuildDepthPyramid(*m_fbo, camera->GetWorldToNDCMatrix());
+    }
+    m_capture->Update(*m_fbo);
+}
+
+double ResourceManager::GetScenePassTime(bool is_depth_prepass) const noexcept
+{
+    const GPUTimer* timer = m_sceneTimers[is_depth_prepass ? 1 : 0];
+    return timer ? timer->Milliseconds() : 0.0;
+}
+
+const StateCacheStats& ResourceManager::GetStateCacheStats() const noexcept
+{
+    return m_stateCache->GetStats();
+}
+
+void ResourceManager::PrepareWorld() const noexcept
+{
+    PROFILE_FUNCTION();
+    m_stateCache->BeginFrame();
+    m_world->BuildRenderList();
+    m_instances->Upload(m_world->GetRenderList(), m_world->GetMeshDraws());
+}
+
+void ResourceManager::CullWorld(const Frustum& frustum, bool is_shadow) const noexcept
+{
+    PROFILE_FUNCTION();
+    // LOD errors are projected to the height of the scene texture, shadows pick the same LODs as the camera
+    const Camera* camera = CameraBuffer::GetMainCamera();
+    LodSelection lod_selection;
+    if (camera)
+    {
+        lod_selection.eye = camera->Eye();
+        lod_selection.pixelsPerUnit = static_cast<float>(m_fbo->Height()) / (2.f * std::tan(glm::radians(camera->FOV()) * 0.5f));
+    }
+
+    if (m_world->m_isGPUCulling)
+    {
+        m_gpuCulling->Cull(*m_world, *m_instances, lod_selection, is_shadow);
+        return;
+    }
+
+    m_world->Cull(frustum, lod_selection);
+    m_instances->UploadVisible(m_world->GetVisibleInstances());
+}
+
+void ResourceManager::DrawShadows() const noexcept
+{
+    PROFILE_FUNCTION();
+    const Camera* camera = CameraBuffer::GetMainCamera();
+    if (camera == nullptr)
+        return;
+
+    const GPUProfileScope profile("Shadows");
+    // The shadow block is bound even without lights, test.frag always reads it
+    static const std::vector<LightData> no_lights;
+    m_shadows->Update(m_p_lights ? m_p_lights->GetData() : no_lights, *camera);
+
+    // Every view culls and draws the same packets with a depth-only program
+    QueueBatches(RenderPass::Shadow);
+    for (std::size_t i = 0; i < m_shadows->ViewCount(); ++i)
+    {
+        CullWorld(m_shadows->BeginView(i), true);
+        SubmitQueue(RenderPass::Shadow, Primitive::Triangles);
+    }
+    m_shadows->End();
+}
+
+void ResourceManager::QueueBatches(RenderPass pass) const noexcept
+{
+    PROFILE_FUNCTION();
+    m_queue->Clear();
+    const bool is_depth_only = pass != RenderPass::Opaque;
+    const VertexStream stream = is_depth_only ? VertexStream::Position : VertexStream::Full;
+
+    // Shadow views only sort by state, the other passes also draw front to back from the camera
+    const Camera* camera = CameraBuffer::GetMainCamera();
+    const bool is_depth_sorted = camera && pass != RenderPass::Shadow;
+    const glm::vec3 eye = camera ? camera->Eye() : glm::vec3{ 0 };
+    const float far_plane = camera ? std::max(camera->Plane().second, 1e-3f) : 1.f;
+
+    const RenderList& render_list = m_world->GetRenderList();
+    const auto& batches = m_world->GetBatches();
+    const auto& groups = m_world->GetDrawGroups();
+    for (std::size_t b = 0; b < batches.size(); ++b)
+    {
+        const RenderBatch& batch = batches[b];
+        float depth = 0.f;
+        if (is_depth_sorted)
+        {
+            float nearest = far_plane;
+            for (unsigned i = batch.firstInstance; i < batch.firstInstance + batch.instanceCount; ++i)
+                nearest = std::min(nearest, glm::distance(eye, glm::vec3{ render_list[i].modelToWorld[3] }));
+            depth = nearest / far_plane;
+        }
+
+        ShaderProgram* program = is_depth_only ? m_shadows->GetProgram() : batch.p_shader;
+        const unsigned vao = batch.p_model->GetVao(stream);
+        for (unsigned g = batch.firstGroup; g < batch.firstGroup + batch.groupCount; ++g)
+        {
+            const Material& material = *groups[g].p_material;
+            // New variants start compiling here, before the first of them is used
+            unsigned variant = 0;
+            if (is_depth_only == false)
+            {
+                variant = program->GetVariantFeatures(material.GetFeatures());
+                (void)program->GetVariant(variant);
+            }
+            const unsigned material_id = is_depth_only ? 0 : m_queue->GetMaterialId(material);
+            m_queue->Push(DrawPacket{ RenderQueue::MakeKey(pass, program->m_tag, variant, material_id, vao, depth), static_cast<unsigned>(b), g });
+        }
+    }
+    m_queue->Sort();
+}
+
+void ResourceManager::SubmitQueue(RenderPass pass, Primitive primitive) const noexcept
+{
+    PROFILE_FUNCTION();
+    const bool is_depth_only = pass != RenderPass::Opaque;
+    const VertexStream stream = is_depth_only ? VertexStream::Position : VertexStream::Full;
+    const auto& batches = m_world->GetBatches();
+    const auto& groups = m_world->GetDrawGroups();
+
+    if (m_world->m_isGPUCulling)
+        m_gpuCulling->BeginDraw();
+    for (const auto& packet : m_queue->GetPackets())
+    {
+        const RenderBatch& batch = batches[packet.batch];
+        const Material& material = *groups[packet.group].p_material;
+        // Each variant is a program of its own and gets the scene inputs when it is bound
+        ShaderProgram* program = is_depth_only ? m_shadows->GetProgram() : batch.p_shader->GetVariant(material.GetFeatures());
+        if (m_stateCache->UseProgram(program) && is_depth_only == false)
+            SendSceneInputs(program);
+        m_stateCache->BindVertexArray(batch.p_model->GetVao(stream));
+        if (is_depth_only == false)
+            m_stateCache->SendMaterial(material);
+
+        // Transform and color of each visible object come from the instance buffer
+        if (m_world->m_isGPUCulling)
+            m_gpuCulling->DrawGroup(*m_world, batch, packet.group, primitive);
+        else
+            batch.p_model->DrawMeshes(primitive, m_world->GetInstanceRanges(batch), material);
+    }
+    if (m_world->m_isGPUCulling)
+        m_gpuCulling->EndDraw();
+    m_stateCache->Reset();
+}
+
+void ResourceManager::SendSceneInputs(ShaderProgram* program) const noexcept
+{
+    program->SendUniform("t_ibl", m_texUnit.find(TextureType::IBL)->second);
+    program->SendUniform("t_irradiance", m_texUnit.find(TextureType::Irradiance)->second);
+    program->SendUniform("t_brdflut", m_texUnit.find(TextureType::BRDF)->second);
+    program->SendUniform("t_environment", m_texUnit.find(TextureType::Environment)->second);
+    program->SendUniform("t_prefiltermap", m_texUnit.find(TextureType::PrefilterMap)->second);
+    m_shadows->Bind(program);
 }
 
 /* ResourceManager - end ------------------------------------------------------------------------*/
\ No newline at end of file
@@ -7,13 +7,24 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <future>     // std::future
 #include <gl/glew.h>
 
 #include "Transform.h"
 #include "FBXImporter.h"
+#include "RenderQueue.h"  // RenderPass, RenderQueue, StateCache
 
 #define ERROR_INDEX 9999
 
+class World;
+class InstanceBuffer;
+class GPUCulling;
+class ShadowMaps;
+class GPUTimer;
+class FrameCapture;
+struct Frustum;
+struct RenderBatch;
+
 enum class LightType
 {
     POINT,
@@ -31,16 +42,51 @@ struct Light
     glm::vec3 m_attenuation = glm::vec3(0.0001f, 0.00005f, 0.000025f);
 };
 
+// Per-light data read by lightcluster.comp and test.frag, matches Light in both (std430)
+struct LightData
+{
+    unsigned type = 0;
+    int shadow = -1;    // cascades for a directional light, atlas tile for a spot light
+    float padding0[2]{};
+    glm::vec4 direction{ 0 };
+    glm::vec4 position{ 0 };    // w: range past which the light is ignored
+    glm::vec4 ambient{ 0 };
+    glm::vec4 diffuse{ 0 };
+    glm::vec4 specular{ 0 };
+    glm::vec3 attenuation{ 0 };
+    float innerAngle = 0.f;
+    float outerAngle = 0.f;
+    float falloff = 0.f;
+    float padding1[2]{};
+};
+
+// Clustered forward lighting: lights are assigned to froxels of the view frustum every frame,
+// fragments only loop over the lights of their own froxel
 class Lights
 {
 public:
+    // Froxel grid, matches lightcluster.comp and test.frag
+    static constexpr unsigned s_clusterX = 16, s_clusterY = 9, s_clusterZ = 24;
+    static constexpr unsigned s_maxLightsPerCluster = 256;
+    // The first directional light casts cascaded shadows, spot lights take atlas tiles in order
+    static constexpr unsigned s_maxSpotShadows = 16;
+
     Lights() noexcept;
     ~Lights() noexcept;
     void Update();
     void AddLight(Light light);
+    [[nodiscard]] std::size_t Size() const noexcept;
+    [[nodiscard]] const std::vector<LightData>& GetData() const noexcept;
 private:
+    // Distance where the attenuation drops below 1/256 of the light's colour
+    [[nodiscard]] static float Range(const Light& light) noexcept;
+
     std::vector<Light> lights;
-    GLuint m_ubo = 0;
+    std::vector<LightData> m_data;
+    ShaderProgram* m_cluster = nullptr;
+    // Lights, light count of each froxel, light indices of each froxel
+    GLuint m_lightBuffer = 0, m_gridBuffer = 0, m_indexBuffer = 0;
+    std::size_t m_lightCapacity = 0;
 };
 
 class Grid
@@ -57,6 +103,17 @@ private:
     std::vector<glm::vec3> m_position;
 };
 
+// Handle of the object in the world.
+// It stays valid until the object is destroyed, even if the storage of the world is reordered.
+struct ObjectHandle
+{
+    static constexpr unsigned s_invalid = 0xFFFFFFFF;
+    unsigned index = s_invalid;
+    unsigned generation = 0;
+
+    [[nodiscard]] bool operator==(const ObjectHandle& rhs) const noexcept = default;
+};
+
 class Object
 {
 public:
@@ -82,30 +139,83 @@ public:
 
     unsigned LoadFbx(const char* path) noexcept;
     unsigned LoadTexture(const char* path) noexcept;
+    // Uploads pixels decoded off the GL thread by Texture::Decode
+    unsigned LoadTexture(const std::filesystem::path& path, const ImageData& image) noexcept;
     unsigned LoadShaders(const std::vector<std::pair<ShaderType, std::filesystem::path>>& paths) noexcept;
+    // Decodes the textures on worker threads, a later LoadTexture of the same path only uploads.
+    // Called before the resource manager is made, decoding overlaps its shader compilation.
+    static void PrefetchTextures(const std::vector<std::filesystem::path>& paths) noexcept;
 
     void AddTexture(Texture* texture) noexcept;
     Texture* GetTexture(const std::filesystem::path& path) const noexcept;
     Texture* GetTexture(const unsigned tag) noexcept;
+    [[nodiscard]] Model* GetModel(unsigned tag) const noexcept;
 
     Object* CreateObject(unsigned mesh, unsigned shader, unsigned t_albedo = ERROR_INDEX, unsigned t_metallic = ERROR_INDEX, unsigned t_roughness = ERROR_INDEX) noexcept;
     Object* CreateObject(const char* path) noexcept;
+    // Every mesh of the model takes the textures whose tags are loaded, the others keep their own
+    void ApplyTextures(Model* p_model, unsigned t_albedo, unsigned t_metallic, unsigned t_roughness) noexcept;
+    void SelectObject(const Object* p_object) noexcept;
+    [[nodiscard]] Object* GetSelectedObject() const noexcept;
+    [[nodiscard]] World* GetWorld() const noexcept;
     
     void CreateSkyBox() noexcept;
 
+    // Lights whose shadows are drawn before the scene
+    void SetLights(Lights* p_lights) noexcept;
+    [[nodiscard]] ShadowMaps* GetShadowMaps() const noexcept;
+    // Screenshots and sequences of the scene FBO, read back a few frames after they are drawn
+    [[nodiscard]] FrameCapture* GetFrameCapture() const noexcept;
+
     void DrawSkyBox() const noexcept;
     void DrawLines() const noexcept;
     void DrawTriangles() const noexcept;
+    // Smoothed GPU time of the scene pass, kept for both modes so they can be compared
+    [[nodiscard]] double GetScenePassTime(bool is_depth_prepass) const noexcept;
+    // State changes made and skipped by the draws of the last frame
+    [[nodiscard]] const StateCacheStats& GetStateCacheStats() const noexcept;
+
+    // Lays down the depth of the batches first so the shading pass runs once per visible fragment
+    bool m_isDepthPrepass = false;
+    // Sky drawn by one full-screen triangle instead of the skycube mesh
+    bool m_isFullscreenSky = true;
+    bool m_isGridVisible = true;
 
     static FrameBufferObject* m_fbo;
     static FrameBufferObject_PreFilterMap* m_fbo_prefiltermap;
 private:
+    void PrepareWorld() const noexcept;
+    // Fills the visible instances of the view bound to the camera block
+    void CullWorld(const Frustum& frustum, bool is_shadow) const noexcept;
+    void DrawShadows() const noexcept;
+    // One packet per draw group of every batch, sorted by state then front to back
+    void QueueBatches(RenderPass pass) const noexcept;
+    // Depth-only passes draw every packet with the depth program and the position stream
+    void SubmitQueue(RenderPass pass, Primitive primitive) const noexcept;
+    // Environment and shadow samplers, sent once per program change
+    void SendSceneInputs(ShaderProgram* program) const noexcept;
+
     Grid* m_grid;
-    Object* m_object, *m_skybox, *m_cube;
+    World* m_world;
+    InstanceBuffer* m_instances;
+    GPUCulling* m_gpuCulling;
+    ShadowMaps* m_shadows;
+    // Scene pass without and with the depth prepass
+    GPUTimer* m_sceneTimers[2];
+    RenderQueue* m_queue;
+    FrameCapture* m_capture;
+    StateCache* m_stateCache;
+    Lights* m_p_lights = nullptr;
+    Object* m_skybox, *m_cube;
+    ShaderProgram* m_sky = nullptr;
+    // Empty, the full-screen triangle is generated from gl_VertexID
+    unsigned m_skyVao = 0;
     std::map<unsigned, Texture*> m_textures;
     std::map<unsigned, Model*> m_models;
     std::map<unsigned, ShaderProgram*> m_shaders;
     Texture m_brdf, m_hdr, m_environment,m_irradiance;
     std::map<TextureType, unsigned> m_texUnit;
+    ObjectHandle m_selected;
+    static std::map<std::filesystem::path, std::future<ImageData>> s_m_prefetched;
 public:
 };
\ No newline at end of file
@@ -7,6 +7,8 @@
  */
 #include "Shader.h"
 
+#include <algorithm>	// std::count
+#include <chrono>	// std::chrono
 #include <iostream>	// std::cout
 #include <fstream>	// std::ifstream
 #include <gl/glew.h>	// gl functions
@@ -14,6 +16,10 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>	// load png
 
+#include "GLState.h"	// GLState
+#include "ShaderCache.h"	// ShaderCache
+#include "ShaderWatcher.h"	// ShaderWatcher
+
 namespace
 {
 	constexpr GLenum ToGLenum(const ShaderType type)
@@ -26,16 +32,36 @@ namespace
 		case ShaderType::Geometry: return GL_GEOMETRY_SHADER;
 		case ShaderType::Tessellation_Control: return GL_TESS_CONTROL_SHADER;
 		case ShaderType::Tessellation_Evaluation: return GL_TESS_EVALUATION_SHADER;
+		case ShaderType::Compute: return GL_COMPUTE_SHADER;
 		}
 		return GL_NONE;
 	}
-	
+
+	struct FeatureMacro
+	{
+		ShaderFeature feature;
+		const char* p_name;
+	};
+	constexpr FeatureMacro s_featureMacros[] = {
+		{ ShaderFeature::AlbedoMap, "HAS_ALBEDO_MAP" },
+		{ ShaderFeature::MetallicMap, "HAS_METALLIC_MAP" },
+		{ ShaderFeature::RoughnessMap, "HAS_ROUGHNESS_MAP" },
+		{ ShaderFeature::AOMap, "HAS_AO_MAP" }
+	};
+
+	std::string ReadSource(const std::filesystem::path& path) noexcept
+	{
+		std::ifstream ifs(path, std::ios::in);
+		std::stringstream buffer;
+		buffer << ifs.rdbuf();
+		return buffer.str();
+	}
 }
 
 /* Shader - start -------------------------------------------------------------------------------*/
 
-Shader::Shader(ShaderType type, const std::filesystem::path& file_path) noexcept
-	: m_type(type), m_filePath(file_path)
+Shader::Shader(ShaderType type, const std::filesystem::path& file_path, const std::string& defines) noexcept
+	: m_type(type), m_filePath(file_path), m_defines(defines)
 {
 	Compile();
 }
@@ -47,7 +73,10 @@ Shader::~Shader() noexcept
 
 void Shader::Compile() noexcept
 {
-	if (m_isCompiled)
+	if (m_isCompiled || m_isSubmitted)
+		return;
+	// SPIR-V is compiled from the plain source, variants always compile their GLSL
+	if (m_defines.empty() && ShaderCache::s_m_isSpirvEnabled && ShaderCache::IsSpirvSupported() && CompileSpirv())
 		return;
 
 	std::ifstream ifs(m_filePath, std::ios::in);
@@ -72,11 +101,37 @@ void Shader::Compile() noexcept
 		}
 	}
 
-	// compile shader
-	const std::string& contents = buffer.str();
+	std::string contents = buffer.str();
+	if (m_defines.empty() == false)
+	{
+		// #version has to stay first, #line keeps the line numbers of compile errors those of the file
+		std::size_t insert = 0;
+		if (const std::size_t version = contents.find("#version"); version != std::string::npos)
+		{
+			insert = contents.find('\n', version);
+			if (insert == std::string::npos)
+			{
+				contents += '\n';
+				insert = contents.size() - 1;
+			}
+			++insert;
+		}
+		const auto line = std::count(contents.begin(), contents.begin() + static_cast<std::ptrdiff_t>(insert), '\n') + 1;
+		contents.insert(insert, m_defines + "#line " + std::to_string(line) + "\n");
+	}
+
+	// compile shader, the status is read by CheckStatus so the driver can work in the background
 	GLchar const* source[]{ contents.c_str() };
 	glShaderSource(m_handle, 1, source, nullptr);
 	glCompileShader(m_handle);
+	m_isSubmitted = true;
+}
+
+bool Shader::CheckStatus() noexcept
+{
+	if (m_isCompiled || m_isSubmitted == false)
+		return m_isCompiled;
+	m_isSubmitted = false;
 
 	// check compilation status
 	GLint compiled = 0;
@@ -90,9 +145,36 @@ void Shader::Compile() noexcept
 		Clear();
 		std::cout << "[Shader]: <" << m_filePath << "> :Compile Failure" << std::endl;
 		std::cout << std::string(error_log.begin(), error_log.end()) << std::endl;
-		return;
+		return false;
+	}
+	m_isCompiled = true;
+	return true;
+}
+
+bool Shader::CompileSpirv() noexcept
+{
+	std::ifstream ifs(ShaderCache::GetSpirvPath(m_filePath), std::ios::binary);
+	if (!ifs.is_open())
+		return false;
+	const std::vector<char> binary{ std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>() };
+	if (m_handle <= 0)
+		m_handle = glCreateShader(ToGLenum(m_type));
+	if (m_handle == 0 || binary.empty())
+		return false;
+
+	glShaderBinary(1, &m_handle, GL_SHADER_BINARY_FORMAT_SPIR_V, binary.data(), static_cast<GLsizei>(binary.size()));
+	glSpecializeShader(m_handle, "main", 0, nullptr, nullptr);
+	GLint compiled = 0;
+	glGetShaderiv(m_handle, GL_COMPILE_STATUS, &compiled);
+	if (compiled == GL_FALSE)
+	{
+		// A shader given a binary cannot take a source anymore, the GLSL path starts from a new one
+		std::cout << "[Shader]: <" << m_filePath << "> :SPIR-V Failure, compiling the source" << std::endl;
+		Clear();
+		return false;
 	}
-	m_isCompiled = compiled;
+	m_isCompiled = true;
+	return true;
 }
 
 void Shader::Clear() noexcept
@@ -102,6 +184,7 @@ void Shader::Clear() noexcept
 		glDeleteShader(m_handle);
 		m_handle = 0;
 		m_isCompiled = false;
+		m_isSubmitted = false;
 	}
 }
 
@@ -119,31 +202,69 @@ bool Shader::IsCompiled() const noexcept
 /*-----------------------------------------------------------------------------------------------*/
 /* ShaderProgram - start ------------------------------------------------------------------------*/
 
-ShaderProgram::ShaderProgram(const std::vector<std::pair<ShaderType, std::filesystem::path>>& shader_files) noexcept
+bool ShaderProgram::s_m_isParallel = false;
+std::size_t ShaderProgram::s_m_variantCount = 0;
+
+ShaderProgram::ShaderProgram(const std::vector<std::pair<ShaderType, std::filesystem::path>>& shader_files, bool is_watched, const std::string& defines) noexcept
+	: m_isWatched(is_watched), m_files(shader_files), m_defines(defines)
 {
-	for(const auto& shader : shader_files)
+	const auto begin = std::chrono::steady_clock::now();
+	// A warm start links from the cached binary and never compiles
+	m_key = ShaderCache::Key(m_files, m_defines);
+	m_handle = glCreateProgram();
+	if (m_handle != 0 && ShaderCache::Load(m_handle, m_key))
+		m_isLinked = true;
+	else
 	{
-		m_shader.push_back(new Shader(shader.first, shader.second));
+		for (const auto& shader : m_files)
+		{
+			m_shader.push_back(new Shader(shader.first, shader.second, m_defines));
+		}
+		Link();
 	}
-	LinkAndValidate();
+	if (m_isWatched)
+		ShaderWatcher::Watch(this);
+	ShaderCache::AddTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
 }
 
 ShaderProgram::~ShaderProgram() noexcept
 {
+	for (const auto& variant : m_variants)
+		delete variant.second;
+	s_m_variantCount -= m_variants.size();
+	m_variants.clear();
+	if (m_isWatched)
+		ShaderWatcher::Unwatch(this);
 	Clear();
 	for (const auto& shader : m_shader)
 		delete shader;
 	m_shader.clear();
 }
 
+void ShaderProgram::EnableParallelCompile() noexcept
+{
+	// 0xFFFFFFFF leaves the thread count to the driver
+	if (GLEW_KHR_parallel_shader_compile)
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	else if (GLEW_ARB_parallel_shader_compile)
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+	s_m_isParallel = GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+}
+
+bool ShaderProgram::IsParallelCompile() noexcept
+{
+	return s_m_isParallel;
+}
+
 void ShaderProgram::Use() const noexcept
 {
-	glUseProgram(m_handle);
+	Resolve();
+	GLState::UseProgram(m_handle);
 }
 
 void ShaderProgram::UnUse() const noexcept
 {
-	glUseProgram(0);
+	GLState::UseProgram(0);
 }
 
 void ShaderProgram::SendUniform(const std::string& uniform_name, bool value) const noexcept
@@ -190,17 +311,30 @@ void ShaderProgram::Clear() noexcept
 {
 	if (m_handle > 0)
 	{
-		glDeleteProgram(m_handle);
+		GLState::DeleteProgram(m_handle);
 		m_handle = 0;
 		m_isLinked = false;
+		m_isPending = false;
 	}
 	uniforms.clear();
 }
 
+bool ShaderProgram::HasUniform(const std::string& uniform_name) const noexcept
+{
+	if (const auto find = uniforms.find(uniform_name); find != uniforms.end())
+		return find->second >= 0;
+	Resolve();
+
+	const int location = glGetUniformLocation(m_handle, uniform_name.c_str());
+	uniforms[uniform_name] = location < 0 ? -1 : location;
+	return location >= 0;
+}
+
 int ShaderProgram::GetUniformLocation(const std::string& uniform_name) const noexcept
 {
 	if (const auto find = uniforms.find(uniform_name); find != uniforms.end())
 		return find->second;
+	Resolve();
 
 	int location = glGetUniformLocation(m_handle, uniform_name.c_str());
 	if (location < 0)
@@ -212,9 +346,9 @@ int ShaderProgram::GetUniformLocation(const std::string& uniform_name) const noe
 	return location;
 }
 
-void ShaderProgram::LinkAndValidate() noexcept
+void ShaderProgram::Link() noexcept
 {
-	if (m_isLinked)
+	if (m_isLinked || m_isPending)
 		return;
 
 	if (m_handle <= 0)
@@ -227,9 +361,10 @@ void ShaderProgram::LinkAndValidate() noexcept
 		}
 	}
 
+	// Stages still compiling are attached as they are, the link waits for them on the driver's side
 	for (const auto& shader : m_shader)
 	{
-		if (shader->IsCompiled() == false)
+		if (shader->GetHandle() == 0)
 		{
 			std::cout << "[ShaderProgram]: <name=" << m_name << "> shader isn't compiled" << std::endl;
 			return;
@@ -237,21 +372,138 @@ void ShaderProgram::LinkAndValidate() noexcept
  		glAttachShader(m_handle, shader->GetHandle());
 	}
 
-	// verify link status
+	if (ShaderCache::s_m_isEnabled)
+		glProgramParameteri(m_handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glLinkProgram(m_handle);
+	m_isPending = true;
+}
+
+bool ShaderProgram::IsReady() const noexcept
+{
+	if (m_isPending == false)
+		return true;
+	// Without the extension the completion cannot be polled, resolving waits instead
+	if (s_m_isParallel == false)
+		return true;
+	GLint is_complete = GL_FALSE;
+	glGetProgramiv(m_handle, GL_COMPLETION_STATUS_KHR, &is_complete);
+	return is_complete == GL_TRUE;
+}
+
+void ShaderProgram::Resolve() const noexcept
+{
+	// The link state is filled in lazily, the program itself does not change
+	if (m_isPending)
+		const_cast<ShaderProgram*>(this)->Finish();
+}
+
+bool ShaderProgram::IsLinked() const noexcept
+{
+	Resolve();
+	return m_isLinked;
+}
+
+void ShaderProgram::Swap(ShaderProgram& other) noexcept
+{
+	std::swap(m_isLinked, other.m_isLinked);
+	std::swap(m_isPending, other.m_isPending);
+	std::swap(m_handle, other.m_handle);
+	std::swap(m_key, other.m_key);
+	std::swap(m_shader, other.m_shader);
+	std::swap(uniforms, other.uniforms);
+	// The new sources may test other features, the variants themselves are rebuilt on their own
+	m_isFeatureFound = other.m_isFeatureFound = false;
+}
+
+const std::vector<std::pair<ShaderType, std::filesystem::path>>& ShaderProgram::GetFiles() const noexcept
+{
+	return m_files;
+}
+
+const std::string& ShaderProgram::GetDefines() const noexcept
+{
+	return m_defines;
+}
+
+ShaderProgram* ShaderProgram::GetVariant(unsigned features) noexcept
+{
+	features = GetVariantFeatures(features);
+	if (features == 0)
+		return this;
+	if (const auto find = m_variants.find(features); find != m_variants.end())
+		return find->second;
+
+	// Only linked here, the link is waited for at the first use so variants asked for together compile together
+	std::string defines = m_defines;
+	for (const auto& [feature, p_name] : s_featureMacros)
+	{
+		if (features & static_cast<unsigned>(feature))
+			defines += std::string("#define ") + p_name + "\n";
+	}
+	auto* p_variant = new ShaderProgram(m_files, m_isWatched, defines);
+	p_variant->m_name = m_name + "#" + std::to_string(features);
+	m_variants.emplace(features, p_variant);
+	++s_m_variantCount;
+	return p_variant;
+}
+
+unsigned ShaderProgram::GetVariantFeatures(unsigned features) noexcept
+{
+	if (m_isFeatureFound == false)
+		FindFeatures();
+	return features & m_features;
+}
+
+std::size_t ShaderProgram::GetVariantCount() noexcept
+{
+	return s_m_variantCount;
+}
+
+void ShaderProgram::FindFeatures() noexcept
+{
+	m_isFeatureFound = true;
+	m_features = 0;
+	for (const auto& file : m_files)
+	{
+		const std::string source = ReadSource(file.second);
+		for (const auto& [feature, p_name] : s_featureMacros)
+		{
+			if (source.find(p_name) != std::string::npos)
+				m_features |= static_cast<unsigned>(feature);
+		}
+	}
+}
+
+void ShaderProgram::Finish() noexcept
+{
+	const auto begin = std::chrono::steady_clock::now();
+	m_isPending = false;
+
+	// verify link status
 	GLint linked = 0;
 	glGetProgramiv(m_handle, GL_LINK_STATUS, &linked);
 	if (linked == GL_FALSE)
 	{
-		GLint log_length = 0;
-		glGetProgramiv(m_handle, GL_INFO_LOG_LENGTH, &log_length);
-		std::vector<char> error_log(log_length);
-		glGetProgramInfoLog(m_handle, log_length, nullptr, error_log.data());
+		// A stage that failed explains the link failure better than the link log
+		bool is_compiled = true;
+		for (const auto& shader : m_shader)
+			is_compiled = shader->CheckStatus() && is_compiled;
+		if (is_compiled)
+		{
+			GLint log_length = 0;
+			glGetProgramiv(m_handle, GL_INFO_LOG_LENGTH, &log_length);
+			std::vector<char> error_log(log_length);
+			glGetProgramInfoLog(m_handle, log_length, nullptr, error_log.data());
+			std::cout << "[ShaderProgram]: <name=" << m_name << "> Link Failure\n" + std::string(error_log.begin(), error_log.end()) << std::endl;
+		}
 		Clear();
-		std::cout << "[ShaderProgram]: <name=" << m_name << "> Link Failure\n" + std::string(error_log.begin(), error_log.end()) << std::endl;
 		return;
 	}
-	// Check validate
+	for (const auto& shader : m_shader)
+		shader->CheckStatus();
+#ifdef SHADER_VALIDATE_PROGRAM
+	// Validation checks the program against the GL state bound right now, not the state of its draws,
+	// so it only helps when debugging a draw and stays out of normal builds
 	glValidateProgram(m_handle);
 	GLint is_validate = 0;
 	glGetProgramiv(m_handle, GL_VALIDATE_STATUS, &is_validate);
@@ -265,11 +517,15 @@ void ShaderProgram::LinkAndValidate() noexcept
 		std::cout << "[ShaderProgram]: <name=" << m_name << "> Validate Failure\n" + std::string(error_log.begin(), error_log.end()) << std::endl;
 		return;
 	}
+#endif
 	m_isLinked = true;
+	ShaderCache::Store(m_handle, m_key);
+	ShaderCache::AddTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
 }
 
 void ShaderProgram::PrintActiveAttributes() const noexcept
 {
+	Resolve();
 	GLint max_length = 0, number = 0;
 	glGetProgramiv(m_handle, GL_ACTIVE_ATTRIBUTES, &number);
 	if (number <= 0)
@@ -291,6 +547,7 @@ void ShaderProgram::PrintActiveAttributes() const noexcept
 
 void ShaderProgram::PrintActiveUniforms() const noexcept
 {
+	Resolve();
 	GLint max_length = 0, number = 0;
 	glGetProgramiv(m_handle, GL_ACTIVE_UNIFORMS, &number);
 	if (number <= 0)
@@ -321,38 +578,13 @@ Texture::Texture(const char* file_path, bool is_2d_texture, bool is_hdr) noexcep
 {
 	if(is_2d_texture)
 	{
-		stbi_set_flip_vertically_on_load(true);
-		int width, height, channels;
-		unsigned char* data = stbi_load(m_path.string().c_str(), &width, &height, &channels, 0);
-
-		if (data == nullptr)
+		const ImageData image = Decode(m_path);
+		if (image.IsValid() == false)
 		{
 			std::cout << "[Texture] Error: Unable to load " << m_path << std::endl;
 			return;
 		}
-
-		const GLenum sized_internal_format = (channels == 4) ? GL_RGBA8 : GL_RGB8;
-		const GLenum base_internal_format = (channels == 4) ? GL_RGBA : GL_RGB;
-		if(channels == 1)
-		{
-			stbi_image_free(data);
-			data = stbi_load(m_path.string().c_str(), &width, &height, &channels, STBI_rgb);
-		}
-
-		if (!m_handle)
-			glCreateTextures(GL_TEXTURE_2D, 1, &m_handle);
-		glTextureStorage2D(m_handle, 1, sized_internal_format, width, height);
-		glTextureSubImage2D(m_handle, 0, 0, 0, width, height, base_internal_format, GL_UNSIGNED_BYTE, data);
-		stbi_image_free(data);
-
-		glTextureParameteri(m_handle, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTextureParameteri(m_handle, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTextureParameteri(m_handle, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTextureParameteri(m_handle, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-		m_unit = s_textureCount++;
-		glBindTextureUnit(m_unit, m_handle);
-		const_cast<bool&>(m_initialized) = true;
+		Upload(image);
 	}
 	if(is_hdr)
 	{
@@ -366,7 +598,7 @@ Texture::Texture(const char* file_path, bool is_2d_texture, bool is_hdr) noexcep
 		}
 
 		glGenTextures(1, &m_handle);
-		glBindTexture(GL_TEXTURE_2D, m_handle);
+		GLState::BindTexture(GL_TEXTURE_2D, m_handle);
 		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -380,14 +612,69 @@ Texture::Texture(const char* file_path, bool is_2d_texture, bool is_hdr) noexcep
 
 
 		m_unit = s_textureCount++;
-		glBindTextureUnit(m_unit, m_handle);
+		GLState::BindTextureUnit(m_unit, m_handle);
 		const_cast<bool&>(m_initialized) = true;
 	}
 }
 
+Texture::Texture(const std::filesystem::path& file_path, const ImageData& image) noexcept
+	: m_initialized(false), m_name(file_path.filename().string()), m_path(file_path)
+{
+	if (image.IsValid() == false)
+	{
+		std::cout << "[Texture] Error: Unable to load " << m_path << std::endl;
+		return;
+	}
+	Upload(image);
+}
+
+ImageData Texture::Decode(const std::filesystem::path& file_path) noexcept
+{
+	ImageData image;
+	const std::string path = file_path.string();
+	if (stbi_info(path.c_str(), &image.width, &image.height, &image.channels) == 0)
+		return image;
+	// Textures are RGB or RGBA, grey images are expanded
+	const int desired = image.channels == 4 ? STBI_rgb_alpha : STBI_rgb;
+	stbi_set_flip_vertically_on_load_thread(true);
+	unsigned char* data = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, desired);
+	if (data == nullptr)
+		return ImageData{};
+	image.channels = desired;
+	image.pixels.assign(data, data + static_cast<std::size_t>(image.width) * static_cast<std::size_t>(image.height) * static_cast<std::size_t>(desired));
+	stbi_image_free(data);
+	return image;
+}
+
+void Texture::Upload(const ImageData& image) noexcept
+{
+	const GLenum sized_internal_format = (image.channels == 4) ? GL_RGBA8 : GL_RGB8;
+	const GLenum base_internal_format = (image.channels == 4) ? GL_RGBA : GL_RGB;
+	if (!m_handle)
+		glCreateTextures(GL_TEXTURE_2D, 1, &m_handle);
+	glTextureStorage2D(m_handle, 1, sized_internal_format, image.width, image.height);
+	// RGB rows of odd widths are not 4-byte aligned
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTextureSubImage2D(m_handle, 0, 0, 0, image.width, image.height, base_internal_format, GL_UNSIGNED_BYTE, image.pixels.data());
+
+	glTextureParameteri(m_handle, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTextureParameteri(m_handle, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTextureParameteri(m_handle, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTextureParameteri(m_handle, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	m_unit = s_textureCount++;
+	GLState::BindTextureUnit(m_unit, m_handle);
+	const_cast<bool&>(m_initialized) = true;
+}
+
+bool ImageData::IsValid() const noexcept
+{
+	return width > 0 && height > 0 && channels > 0 && pixels.empty() == false;
+}
+
 Texture::~Texture() noexcept
 {
-	glDeleteTextures(1, &m_handle);
+	GLState::DeleteTextures(1, &m_handle);
 	m_handle = 0;
 	m_unit = 0;
 	if (m_unit + 1 == s_textureCount)
@@ -409,7 +696,7 @@ CubeMapTexture::CubeMapTexture(std::vector<std::filesystem::path> file_path) noe
 	: Texture("cube-map", false)
 {
 	glGenTextures(1, &m_handle);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, m_handle);
+	GLState::BindTexture(GL_TEXTURE_CUBE_MAP, m_handle);
 	int width, height, nrChannels;
 	for (unsigned int i = 0; i < file_path.size(); i++)
 	{
@@ -427,14 +714,14 @@ CubeMapTexture::CubeMapTexture(std::vector<std::filesystem::path> file_path) noe
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
 	m_unit = s_textureCount++;
-	glBindTextureUnit(m_unit, m_handle);
+	GLState::BindTextureUnit(m_unit, m_handle);
 	const_cast<bool&>(m_initialized) = true;
 }
 
 CubeMapTexture::CubeMapTexture() noexcept : Texture("cube-map", false)
 {
 	glGenTextures(1, &m_handle);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, m_handle);
+	GLState::BindTexture(GL_TEXTURE_CUBE_MAP, m_handle);
 	for (unsigned int i = 0; i < 6; ++i)
 	{
 		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 512, 512, 0,
@@ -447,7 +734,7 @@ CubeMapTexture::CubeMapTexture() noexcept : Texture("cube-map", false)
 
 
 	m_unit = s_textureCount++;
-	glBindTextureUnit(m_unit, m_handle);
+	GLState::BindTextureUnit(m_unit, m_handle);
 	const_cast<bool&>(m_initialized) = true;
 }
 
@@ -465,51 +752,60 @@ void FrameBufferObject::Init(int width, int height) noexcept
 {
 	if (!m_fboHandle)
 		glGenFramebuffers(1, &m_fboHandle);
-	glBindFramebuffer(GL_FRAMEBUFFER, m_fboHandle);
+	GLState::BindFramebuffer(m_fboHandle);
 
 
 	if (!m_texture)
 		glCreateTextures(GL_TEXTURE_2D, 1, &m_texture);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
+	GLState::BindTexture(GL_TEXTURE_2D, m_texture);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, 0);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glBindTextureUnit(m_unit, m_texture);
-
-	if (!m_rboHandle)
-		glGenRenderbuffers(1, &m_rboHandle);
-	glBindRenderbuffer(GL_RENDERBUFFER, m_rboHandle);
+	GLState::BindTextureUnit(m_unit, m_texture);
+
+	// Depth is a texture so that it can be sampled after the scene pass
+	if (m_depthTexture)
+		GLState::DeleteTextures(1, &m_depthTexture);
+	glCreateTextures(GL_TEXTURE_2D, 1, &m_depthTexture);
+	glTextureStorage2D(m_depthTexture, 1, GL_DEPTH_COMPONENT32F, width, height);
+	glTextureParameteri(m_depthTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTextureParameteri(m_depthTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTextureParameteri(m_depthTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(m_depthTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+	m_width = width;
+	m_height = height;
 
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_rboHandle);
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 	{
 		std::cout << "[Frame Buffer Object]: Frame Buffer isn't complete" << std::endl;
 	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::BindFramebuffer(0);
 
 }
 
 void FrameBufferObject::Clear() noexcept
 {
-	glDeleteTextures(1, &m_texture);
-	glDeleteFramebuffers(1, &m_fboHandle);
+	GLState::DeleteTextures(1, &m_texture);
+	GLState::DeleteTextures(1, &m_depthTexture);
+	GLState::DeleteFramebuffers(1, &m_fboHandle);
 	glDeleteRenderbuffers(1, &m_rboHandle);
-	m_texture = m_fboHandle = m_rboHandle = 0;
+	m_texture = m_depthTexture = m_fboHandle = m_rboHandle = 0;
+	m_width = m_height = 0;
 }
 
 void FrameBufferObject::Bind() const noexcept
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, m_fboHandle);
+	GLState::BindFramebuffer(m_fboHandle);
 	glNamedFramebufferTexture(m_fboHandle, GL_COLOR_ATTACHMENT0, m_texture, 0);
 	glClear(GL_DEPTH_BUFFER_BIT);
 }
 
 void FrameBufferObject::UnBind() const noexcept
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::BindFramebuffer(0);
 }
 
 
@@ -518,11 +814,26 @@ unsigned FrameBufferObject::GetTexture() const noexcept
 	return m_texture;
 }
 
+unsigned FrameBufferObject::GetDepthTexture() const noexcept
+{
+	return m_depthTexture;
+}
+
 unsigned FrameBufferObject::Unit() const noexcept
 {
 	return m_unit;
 }
 
+int FrameBufferObject::Width() const noexcept
+{
+	return m_width;
+}
+
+int FrameBufferObject::Height() const noexcept
+{
+	return m_height;
+}
+
 FrameBufferObject_PreFilterMap::FrameBufferObject_PreFilterMap()
 {
 }
@@ -535,10 +846,10 @@ void FrameBufferObject_PreFilterMap::Init(int width, int height) noexcept
 {
 	if (!m_fboHandle)
 		glGenFramebuffers(1, &m_fboHandle);
-	glBindFramebuffer(GL_FRAMEBUFFER, m_fboHandle);
+	GLState::BindFramebuffer(m_fboHandle);
 
 	glGenTextures(1, &m_texture);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, m_texture);
+	GLState::BindTexture(GL_TEXTURE_CUBE_MAP, m_texture);
 	for (unsigned int i = 0; i < 6; ++i)
 	{
 		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 512, 512, 0, GL_RGB, GL_FLOAT, nullptr);
@@ -550,7 +861,7 @@ void FrameBufferObject_PreFilterMap::Init(int width, int height) noexcept
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
-	glBindTextureUnit(m_unit, m_texture);
+	GLState::BindTextureUnit(m_unit, m_texture);
 
 	if (!m_rboHandle)
 		glGenRenderbuffers(1, &m_rboHandle);
@@ -562,7 +873,7 @@ void FrameBufferObject_PreFilterMap::Init(int width, int height) noexcept
 	{
 		std::cout << "[Frame Buffer Object]: Frame Buffer isn't complete" << std::endl;
 	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::BindFramebuffer(0);
 }
 
 void FrameBufferObject_PreFilterMap::Clear() noexcept
@@ -571,12 +882,12 @@ void FrameBufferObject_PreFilterMap::Clear() noexcept
 
 void FrameBufferObject_PreFilterMap::Bind() const noexcept
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, m_fboHandle);
+	GLState::BindFramebuffer(m_fboHandle);
 }
 
 void FrameBufferObject_PreFilterMap::UnBind() const noexcept
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::BindFramebuffer(0);
 }
 
 
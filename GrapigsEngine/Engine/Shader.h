@@ -7,38 +7,65 @@
  */
 #pragma once
 
+#include <cstdint>		// std::uint64_t
 #include <filesystem>	// std::filesystem::path
 #include <map>			// std::map
+#include <string>		// std::string
+#include <vector>		// std::vector
 #include <glm/glm.hpp>	// glm
 	
 
 enum class ShaderType
 {
-	None, Vertex, Fragment, Geometry, Tessellation_Control, Tessellation_Evaluation
+	None, Vertex, Fragment, Geometry, Tessellation_Control, Tessellation_Evaluation, Compute
+};
+
+// Material inputs a program variant is compiled for, each bit defines one macro in every stage
+enum class ShaderFeature : unsigned
+{
+	AlbedoMap = 1u << 0,	// HAS_ALBEDO_MAP
+	MetallicMap = 1u << 1,	// HAS_METALLIC_MAP
+	RoughnessMap = 1u << 2,	// HAS_ROUGHNESS_MAP
+	AOMap = 1u << 3			// HAS_AO_MAP
 };
 
 class Shader
 {
 public:
-	Shader(ShaderType type, const std::filesystem::path& file_path) noexcept;
+	// The source is handed to the driver, which may compile it on its own threads.
+	// The defines are inserted after the #version line.
+	Shader(ShaderType type, const std::filesystem::path& file_path, const std::string& defines = {}) noexcept;
 	~Shader() noexcept;
 	void Compile() noexcept;
+	// Waits for the compile and reports its errors
+	bool CheckStatus() noexcept;
 	void Clear() noexcept;
 	[[nodiscard]] unsigned GetHandle() const noexcept;
 	[[nodiscard]] bool IsCompiled() const noexcept;
 private:
+	[[nodiscard]] bool CompileSpirv() noexcept;
+
 	bool m_isCompiled = false;
+	bool m_isSubmitted = false;
 	ShaderType m_type = ShaderType::None;
 	unsigned m_handle = 0;
-	const std::filesystem::path& m_filePath;
+	std::filesystem::path m_filePath;
+	std::string m_defines;
 };
 
+// Programs are linked without waiting, the link is checked when the program is first used.
+// With GL_KHR_parallel_shader_compile the driver compiles on its own threads meanwhile and IsReady polls it.
 class ShaderProgram
 {
 public:
-	ShaderProgram(const std::vector<std::pair<ShaderType, std::filesystem::path>>& shader_files) noexcept;
+	// A watched program is rebuilt by ShaderWatcher when one of its files changes
+	ShaderProgram(const std::vector<std::pair<ShaderType, std::filesystem::path>>& shader_files, bool is_watched = true, const std::string& defines = {}) noexcept;
 	~ShaderProgram() noexcept;
 
+	// Lets the driver use as many compiler threads as it likes, called once the context is current
+	static void EnableParallelCompile() noexcept;
+	[[nodiscard]] static bool IsParallelCompile() noexcept;
+
 	void Use() const noexcept;
 	void UnUse() const noexcept;
 
@@ -50,6 +77,25 @@ public:
 	void SendUniform(const std::string& uniform_name, const glm::vec3& value) const noexcept;
 	void SendUniform(const std::string& uniform_name, const glm::vec4& value) const noexcept;
 	void SendUniform(const std::string& uniform_name, const glm::mat4& value) const noexcept;
+	// Looks the uniform up without reporting a missing one
+	[[nodiscard]] bool HasUniform(const std::string& uniform_name) const noexcept;
+
+	// True once the link finished, never waits
+	[[nodiscard]] bool IsReady() const noexcept;
+	// Waits for the link and checks it, done by the first use otherwise
+	void Resolve() const noexcept;
+	[[nodiscard]] bool IsLinked() const noexcept;
+	// Exchanges the GL programs, pointers to either object stay valid
+	void Swap(ShaderProgram& other) noexcept;
+	[[nodiscard]] const std::vector<std::pair<ShaderType, std::filesystem::path>>& GetFiles() const noexcept;
+	[[nodiscard]] const std::string& GetDefines() const noexcept;
+
+	// Program compiled with the macros of the features its sources test, created on first use and kept.
+	// Features the sources never mention are dropped, so a program without any gives itself back.
+	[[nodiscard]] ShaderProgram* GetVariant(unsigned features) noexcept;
+	// Features of GetVariant after dropping the unused ones, the variant's place in the sort key
+	[[nodiscard]] unsigned GetVariantFeatures(unsigned features) noexcept;
+	[[nodiscard]] static std::size_t GetVariantCount() noexcept;
 
 	void PrintActiveAttributes() const noexcept;
 	void PrintActiveUniforms() const noexcept;
@@ -59,12 +105,27 @@ public:
 private:
 	void Clear() noexcept;
 	[[nodiscard]] int GetUniformLocation(const std::string& uniform_name) const noexcept;
-	void LinkAndValidate() noexcept;
+	void Link() noexcept;
+	void Finish() noexcept;
+	void FindFeatures() noexcept;
+
+	static bool s_m_isParallel;
+	static std::size_t s_m_variantCount;
 
 	bool m_isLinked = false;
+	bool m_isPending = false;
+	bool m_isWatched = false;
 	unsigned m_handle = 0;
+	std::uint64_t m_key = 0;
+	std::vector<std::pair<ShaderType, std::filesystem::path>> m_files;
+	std::string m_defines;
+	// Empty when the program was loaded from the binary cache
 	std::vector<Shader*> m_shader;
 	mutable std::map<std::string, int> uniforms;
+	// Features tested by the sources, found when the first variant is asked for
+	bool m_isFeatureFound = false;
+	unsigned m_features = 0;
+	std::map<unsigned, ShaderProgram*> m_variants;
 };
 
 enum class TextureType
@@ -72,13 +133,27 @@ enum class TextureType
 	Default = 0, IBL, BRDF, Irradiance, Environment,PrefilterMap
 };
 
+// 8-bit pixels decoded from an image file, bottom row first
+struct ImageData
+{
+	[[nodiscard]] bool IsValid() const noexcept;
+
+	int width = 0, height = 0, channels = 0;
+	std::vector<unsigned char> pixels;
+};
+
 class Texture
 {
 public:
 	static unsigned s_textureCount;
 	Texture(const char* file_path, bool is_2d_texture = true, bool is_hdr = false) noexcept;
+	// Uploads pixels decoded beforehand, possibly on another thread
+	Texture(const std::filesystem::path& file_path, const ImageData& image) noexcept;
 	~Texture() noexcept;
 
+	// Touches no GL state, safe to call from any thread
+	[[nodiscard]] static ImageData Decode(const std::filesystem::path& file_path) noexcept;
+
 	[[nodiscard]] unsigned Unit() const noexcept;
 	[[nodiscard]] unsigned Handle() const noexcept;
 
@@ -87,6 +162,8 @@ public:
 	const std::string m_name;
 	const std::filesystem::path m_path;
 protected:
+	void Upload(const ImageData& image) noexcept;
+
 	unsigned m_handle = 0;
 	unsigned m_unit = 0;
 };
@@ -112,10 +189,16 @@ public:
 	void UnBind() const noexcept;
 
 	[[nodiscard]] unsigned GetTexture() const noexcept;
+	[[nodiscard]] unsigned GetDepthTexture() const noexcept;
 	[[nodiscard]] unsigned Unit() const noexcept;
+	[[nodiscard]] int Width() const noexcept;
+	[[nodiscard]] int Height() const noexcept;
 protected:
 	const unsigned m_unit;
 	unsigned m_fboHandle, m_rboHandle, m_texture;
+	// Sampled by the depth pyramid build
+	unsigned m_depthTexture = 0;
+	int m_width = 0, m_height = 0;
 };
 
 
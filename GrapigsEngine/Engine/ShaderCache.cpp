@@ -0,0 +1,229 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: ShaderCache.cpp
+ *	Desc		: Linked program binaries kept on disk between runs
+ */
+#include "ShaderCache.h"
+
+#include <cstdio>		// std::snprintf
+#include <cstring>		// std::memcpy
+#include <fstream>		// std::ifstream, std::ofstream
+#include <gl/glew.h>	// gl functions
+#include <iostream>		// std::cout
+
+std::filesystem::path ShaderCache::s_m_folder = "shadercache";
+bool ShaderCache::s_m_isEnabled = true;
+bool ShaderCache::s_m_isSpirvEnabled = false;
+ShaderCacheStats ShaderCache::s_m_stats;
+
+namespace
+{
+	// Entry layout: "GPBC", version, source key, driver length, driver, binary format, binary length, binary
+	constexpr char s_magic[4] = { 'G', 'P', 'B', 'C' };
+	constexpr std::uint32_t s_version = 1;
+
+	// FNV-1a
+	constexpr std::uint64_t s_fnvBasis = 14695981039346656037ull;
+	std::uint64_t Hash(const void* p_data, std::size_t size, std::uint64_t hash = s_fnvBasis) noexcept
+	{
+		const auto* p_bytes = static_cast<const unsigned char*>(p_data);
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			hash ^= p_bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	std::vector<char> ReadFile(const std::filesystem::path& path) noexcept
+	{
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<char>{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	}
+
+	template <typename T>
+	void Append(std::vector<char>& data, const T& value) noexcept
+	{
+		const std::size_t offset = data.size();
+		data.resize(offset + sizeof(T));
+		std::memcpy(data.data() + offset, &value, sizeof(T));
+	}
+
+	template <typename T>
+	bool Take(const std::vector<char>& data, std::size_t& offset, T& value) noexcept
+	{
+		if (offset + sizeof(T) > data.size())
+			return false;
+		std::memcpy(&value, data.data() + offset, sizeof(T));
+		offset += sizeof(T);
+		return true;
+	}
+}
+
+std::uint64_t ShaderCache::Key(const std::vector<std::pair<ShaderType, std::filesystem::path>>& files, const std::string& defines) noexcept
+{
+	// No defines hash to the plain program's key
+	std::uint64_t key = Hash(defines.data(), defines.size());
+	for (const auto& [type, path] : files)
+	{
+		// A stage built from SPIR-V depends on the .spv file rather than on its source
+		const std::filesystem::path spirv = GetSpirvPath(path);
+		std::error_code error;
+		const bool is_spirv = defines.empty() && s_m_isSpirvEnabled && IsSpirvSupported() && std::filesystem::exists(spirv, error);
+		const std::vector<char> source = ReadFile(is_spirv ? spirv : path);
+		key = Hash(&type, sizeof(type), key);
+		key = Hash(&is_spirv, sizeof(is_spirv), key);
+		key = Hash(source.data(), source.size(), key);
+	}
+	const std::string& driver = GetDriver();
+	return Hash(driver.data(), driver.size(), key);
+}
+
+bool ShaderCache::Load(unsigned program, std::uint64_t key) noexcept
+{
+	if (s_m_isEnabled == false)
+		return false;
+	const std::filesystem::path path = GetEntryPath(key);
+	std::error_code error;
+	if (std::filesystem::exists(path, error) == false)
+	{
+		++s_m_stats.misses;
+		return false;
+	}
+
+	const std::vector<char> data = ReadFile(path);
+	std::size_t offset = 0;
+	char magic[4]{};
+	std::uint32_t version = 0, driver_length = 0, length = 0;
+	std::uint64_t stored_key = 0;
+	GLenum format = 0;
+	bool is_valid = Take(data, offset, magic) && Take(data, offset, version) && Take(data, offset, stored_key) && Take(data, offset, driver_length);
+	const std::string& driver = GetDriver();
+	is_valid = is_valid && std::memcmp(magic, s_magic, sizeof(magic)) == 0 && version == s_version && stored_key == key
+		&& driver_length == driver.size() && offset + driver_length <= data.size() && driver.compare(0, driver.size(), data.data() + offset, driver_length) == 0;
+	if (is_valid)
+	{
+		offset += driver_length;
+		is_valid = Take(data, offset, format) && Take(data, offset, length) && offset + length <= data.size();
+	}
+
+	GLint linked = GL_FALSE;
+	if (is_valid)
+	{
+		glProgramBinary(program, format, data.data() + offset, static_cast<GLsizei>(length));
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	}
+	if (linked == GL_FALSE)
+	{
+		// The program is compiled again and a new entry replaces this one
+		std::cout << "[ShaderCache]: " << path.string() << " was rejected" << std::endl;
+		std::filesystem::remove(path, error);
+		++s_m_stats.rejected;
+		return false;
+	}
+	++s_m_stats.hits;
+	return true;
+}
+
+void ShaderCache::Store(unsigned program, std::uint64_t key) noexcept
+{
+	if (s_m_isEnabled == false)
+		return;
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	std::vector<char> data;
+	const std::string& driver = GetDriver();
+	data.reserve(static_cast<std::size_t>(length) + driver.size() + 32);
+	Append(data, s_magic);
+	Append(data, s_version);
+	Append(data, key);
+	Append(data, static_cast<std::uint32_t>(driver.size()));
+	data.insert(data.end(), driver.begin(), driver.end());
+	const std::size_t format_offset = data.size();
+	Append(data, GLenum{ 0 });
+	Append(data, static_cast<std::uint32_t>(length));
+	const std::size_t binary_offset = data.size();
+	data.resize(binary_offset + static_cast<std::size_t>(length));
+
+	GLenum format = 0;
+	GLsizei written = 0;
+	glGetProgramBinary(program, length, &written, &format, data.data() + binary_offset);
+	if (written != length)
+		return;
+	std::memcpy(data.data() + format_offset, &format, sizeof(format));
+
+	std::error_code error;
+	std::filesystem::create_directories(s_m_folder, error);
+	// Written beside the entry and renamed, so a run stopped halfway never leaves a truncated entry
+	const std::filesystem::path path = GetEntryPath(key);
+	std::filesystem::path temporary = path;
+	temporary += ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		if (file.is_open() == false || !file.write(data.data(), static_cast<std::streamsize>(data.size())))
+		{
+			std::cout << "[ShaderCache]: Cannot write " << temporary.string() << std::endl;
+			return;
+		}
+	}
+	std::filesystem::rename(temporary, path, error);
+	if (error)
+		std::filesystem::remove(temporary, error);
+}
+
+std::filesystem::path ShaderCache::GetSpirvPath(const std::filesystem::path& source) noexcept
+{
+	std::filesystem::path spirv = source;
+	spirv += ".spv";
+	return spirv;
+}
+
+bool ShaderCache::IsSpirvSupported() noexcept
+{
+	return GLEW_VERSION_4_6 || GLEW_ARB_gl_spirv;
+}
+
+void ShaderCache::AddTime(double milliseconds) noexcept
+{
+	s_m_stats.milliseconds += milliseconds;
+}
+
+const ShaderCacheStats& ShaderCache::GetStats() noexcept
+{
+	return s_m_stats;
+}
+
+const std::string& ShaderCache::GetDriver() noexcept
+{
+	static const std::string driver = []
+	{
+		std::string name;
+		for (const GLenum string : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+		{
+			const auto* p_string = reinterpret_cast<const char*>(glGetString(string));
+			name += p_string ? p_string : "";
+			name += '|';
+		}
+		// Drivers exposing no binary format cannot load what they would give back
+		GLint format_count = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+		if (format_count <= 0)
+		{
+			std::cout << "[ShaderCache]: The driver has no program binary format" << std::endl;
+			s_m_isEnabled = false;
+		}
+		return name;
+	}();
+	return driver;
+}
+
+std::filesystem::path ShaderCache::GetEntryPath(std::uint64_t key) noexcept
+{
+	char name[24];
+	std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+	return s_m_folder / name;
+}
@@ -0,0 +1,53 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: ShaderCache.h
+ *	Desc		: Linked program binaries kept on disk between runs
+ */
+#pragma once
+#include <cstdint>		// std::uint64_t
+#include <filesystem>	// std::filesystem::path
+#include <string>		// std::string
+#include <utility>		// std::pair
+#include <vector>		// std::vector
+
+#include "Shader.h"	// ShaderType
+
+struct ShaderCacheStats
+{
+	std::size_t hits = 0, misses = 0;
+	// Binaries the driver refused, such as after a driver update with the same version string
+	std::size_t rejected = 0;
+	// Time spent creating programs, from the cache or from source
+	double milliseconds = 0.0;
+};
+
+// An entry is named by a hash of the stage sources and the driver, and holds what glGetProgramBinary returned.
+// Entries of another driver or of edited sources are never found, a binary the driver refuses is deleted
+// and the program is compiled from source again.
+class ShaderCache
+{
+public:
+	// Stage sources, the variant's defines, the renderer and the driver version, read with the program's context current
+	[[nodiscard]] static std::uint64_t Key(const std::vector<std::pair<ShaderType, std::filesystem::path>>& files, const std::string& defines) noexcept;
+	// Links the program from its cached binary, false on a miss
+	static bool Load(unsigned program, std::uint64_t key) noexcept;
+	static void Store(unsigned program, std::uint64_t key) noexcept;
+	// Compiled SPIR-V of a stage, next to its source with .spv appended
+	[[nodiscard]] static std::filesystem::path GetSpirvPath(const std::filesystem::path& source) noexcept;
+	[[nodiscard]] static bool IsSpirvSupported() noexcept;
+
+	static void AddTime(double milliseconds) noexcept;
+	[[nodiscard]] static const ShaderCacheStats& GetStats() noexcept;
+
+	static std::filesystem::path s_m_folder;
+	static bool s_m_isEnabled;
+	// Stages with a .spv file are specialized from it instead of compiled.
+	// Uniforms of a SPIR-V program have no names, so only programs set through explicit locations may use it.
+	static bool s_m_isSpirvEnabled;
+private:
+	[[nodiscard]] static const std::string& GetDriver() noexcept;
+	[[nodiscard]] static std::filesystem::path GetEntryPath(std::uint64_t key) noexcept;
+
+	static ShaderCacheStats s_m_stats;
+};
@@ -0,0 +1,214 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: ShaderWatcher.cpp
+ *	Desc		: Rebuilds shader programs whose files changed on disk
+ */
+#include "ShaderWatcher.h"
+
+#include <algorithm>	// std::sort, std::any_of
+#include <chrono>		// std::chrono
+#include <iostream>		// std::cout
+#include <map>			// std::map
+#if defined(__linux__)
+#include <poll.h>		// poll
+#include <sys/inotify.h>	// inotify
+#include <unistd.h>		// read, close
+#define SHADER_WATCHER_INOTIFY
+#endif
+
+#include "Shader.h"	// ShaderProgram
+
+bool ShaderWatcher::s_m_isEnabled = true;
+std::vector<ShaderProgram*> ShaderWatcher::s_m_programs;
+std::vector<ShaderWatcher::Rebuild> ShaderWatcher::s_m_rebuilds;
+std::size_t ShaderWatcher::s_m_reloadCount = 0;
+std::mutex ShaderWatcher::s_m_mutex;
+std::set<std::filesystem::path> ShaderWatcher::s_m_files;
+std::vector<std::filesystem::path> ShaderWatcher::s_m_changed;
+std::thread ShaderWatcher::s_m_thread;
+std::atomic<bool> ShaderWatcher::s_m_isRunning{ false };
+
+void ShaderWatcher::Watch(ShaderProgram* p_program) noexcept
+{
+	if (s_m_isEnabled == false)
+		return;
+	s_m_programs.push_back(p_program);
+	{
+		std::lock_guard lock(s_m_mutex);
+		for (const auto& file : p_program->GetFiles())
+			s_m_files.insert(file.second.lexically_normal());
+	}
+	if (s_m_isRunning.exchange(true) == false)
+		s_m_thread = std::thread(Run);
+}
+
+void ShaderWatcher::Unwatch(const ShaderProgram* p_program) noexcept
+{
+	std::erase(s_m_programs, p_program);
+	CancelRebuild(p_program);
+}
+
+void ShaderWatcher::CancelRebuild(const ShaderProgram* p_program) noexcept
+{
+	std::erase_if(s_m_rebuilds, [p_program](const Rebuild& rebuild)
+	{
+		if (rebuild.p_target != p_program)
+			return false;
+		delete rebuild.p_pending;
+		return true;
+	});
+}
+
+void ShaderWatcher::Update() noexcept
+{
+	std::vector<std::filesystem::path> changed;
+	{
+		std::lock_guard lock(s_m_mutex);
+		changed.swap(s_m_changed);
+	}
+	if (changed.empty() == false)
+	{
+		// One save can report the same file several times
+		std::sort(changed.begin(), changed.end());
+		changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+		for (ShaderProgram* p_program : s_m_programs)
+		{
+			const auto& files = p_program->GetFiles();
+			const bool is_changed = std::any_of(files.begin(), files.end(), [&changed](const auto& file)
+			{
+				return std::binary_search(changed.begin(), changed.end(), file.second.lexically_normal());
+			});
+			if (is_changed == false)
+				continue;
+			// A newer edit replaces a rebuild still in progress
+			CancelRebuild(p_program);
+			auto* p_pending = new ShaderProgram(files, false, p_program->GetDefines());
+			p_pending->m_name = p_program->m_name;
+			s_m_rebuilds.push_back(Rebuild{ p_program, p_pending });
+		}
+	}
+
+	// Rebuilds are swapped in only once linked, so the frame never waits for the compiler
+	for (auto rebuild = s_m_rebuilds.begin(); rebuild != s_m_rebuilds.end();)
+	{
+		if (rebuild->p_pending->IsReady() == false)
+		{
+			++rebuild;
+			continue;
+		}
+		if (rebuild->p_pending->IsLinked())
+		{
+			rebuild->p_target->Swap(*rebuild->p_pending);
+			++s_m_reloadCount;
+			std::cout << "[ShaderWatcher]: <name=" << rebuild->p_target->m_name << "> Reloaded" << std::endl;
+		}
+		else
+			std::cout << "[ShaderWatcher]: <name=" << rebuild->p_target->m_name << "> Keeps the previous program" << std::endl;
+		// The pending object holds the previous GL program after a swap
+		delete rebuild->p_pending;
+		rebuild = s_m_rebuilds.erase(rebuild);
+	}
+}
+
+void ShaderWatcher::Clear() noexcept
+{
+	if (s_m_isRunning.exchange(false) && s_m_thread.joinable())
+		s_m_thread.join();
+	for (const Rebuild& rebuild : s_m_rebuilds)
+		delete rebuild.p_pending;
+	s_m_rebuilds.clear();
+	s_m_programs.clear();
+	std::lock_guard lock(s_m_mutex);
+	s_m_files.clear();
+	s_m_changed.clear();
+}
+
+std::size_t ShaderWatcher::GetReloadCount() noexcept
+{
+	return s_m_reloadCount;
+}
+
+void ShaderWatcher::Run() noexcept
+{
+#ifdef SHADER_WATCHER_INOTIFY
+	if (const int descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC); descriptor >= 0)
+	{
+		RunInotify(descriptor);
+		close(descriptor);
+		return;
+	}
+	std::cout << "[ShaderWatcher]: inotify is not available, polling modification times" << std::endl;
+#endif
+	RunPolling();
+}
+
+#ifdef SHADER_WATCHER_INOTIFY
+void ShaderWatcher::RunInotify(int descriptor) noexcept
+{
+	// Folders are watched rather than files, editors often save by replacing the file
+	std::map<int, std::filesystem::path> folders;
+	std::set<std::filesystem::path> watched;
+	alignas(inotify_event) char buffer[4096];
+	while (s_m_isRunning.load())
+	{
+		{
+			std::lock_guard lock(s_m_mutex);
+			for (const std::filesystem::path& file : s_m_files)
+			{
+				const std::filesystem::path folder = file.has_parent_path() ? file.parent_path() : std::filesystem::path{ "." };
+				if (watched.insert(folder).second == false)
+					continue;
+				if (const int watch = inotify_add_watch(descriptor, folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO); watch >= 0)
+					folders[watch] = folder;
+				else
+					std::cout << "[ShaderWatcher]: Cannot watch " << folder.string() << std::endl;
+			}
+		}
+
+		pollfd request{ descriptor, POLLIN, 0 };
+		if (poll(&request, 1, s_pollMilliseconds) <= 0)
+			continue;
+		const ssize_t length = read(descriptor, buffer, sizeof(buffer));
+		std::lock_guard lock(s_m_mutex);
+		for (ssize_t offset = 0; offset < length;)
+		{
+			const auto* p_event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			if (const auto folder = folders.find(p_event->wd); p_event->len > 0 && folder != folders.end())
+			{
+				const std::filesystem::path file = (folder->second / p_event->name).lexically_normal();
+				if (s_m_files.contains(file))
+					s_m_changed.push_back(file);
+			}
+			offset += static_cast<ssize_t>(sizeof(inotify_event) + p_event->len);
+		}
+	}
+}
+#endif
+
+void ShaderWatcher::RunPolling() noexcept
+{
+	std::map<std::filesystem::path, std::filesystem::file_time_type> times;
+	std::vector<std::filesystem::path> files;
+	while (s_m_isRunning.load())
+	{
+		{
+			std::lock_guard lock(s_m_mutex);
+			files.assign(s_m_files.begin(), s_m_files.end());
+		}
+		for (const std::filesystem::path& file : files)
+		{
+			std::error_code error;
+			const auto time = std::filesystem::last_write_time(file, error);
+			if (error)
+				continue;
+			if (const auto [entry, is_new] = times.emplace(file, time); is_new == false && entry->second != time)
+			{
+				entry->second = time;
+				std::lock_guard lock(s_m_mutex);
+				s_m_changed.push_back(file);
+			}
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(s_pollMilliseconds));
+	}
+}
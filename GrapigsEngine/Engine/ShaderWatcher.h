@@ -0,0 +1,57 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: ShaderWatcher.h
+ *	Desc		: Rebuilds shader programs whose files changed on disk
+ */
+#pragma once
+#include <atomic>		// std::atomic
+#include <filesystem>	// std::filesystem::path
+#include <mutex>		// std::mutex
+#include <set>			// std::set
+#include <thread>		// std::thread
+#include <vector>		// std::vector
+
+class ShaderProgram;
+
+// A thread waits for file changes with inotify, or compares modification times where inotify is missing.
+// Update starts a new program for each changed one and swaps it in once its link finished,
+// a program that fails to build leaves the previous one in place.
+class ShaderWatcher
+{
+public:
+	static constexpr int s_pollMilliseconds = 250;
+
+	static void Watch(ShaderProgram* p_program) noexcept;
+	static void Unwatch(const ShaderProgram* p_program) noexcept;
+	// Called once per frame with the context current
+	static void Update() noexcept;
+	// Stops the thread and drops the rebuilds in progress
+	static void Clear() noexcept;
+	[[nodiscard]] static std::size_t GetReloadCount() noexcept;
+
+	// Headless runs never edit their shaders
+	static bool s_m_isEnabled;
+private:
+	static void CancelRebuild(const ShaderProgram* p_program) noexcept;
+	static void Run() noexcept;
+	static void RunInotify(int descriptor) noexcept;
+	static void RunPolling() noexcept;
+
+	struct Rebuild
+	{
+		ShaderProgram* p_target = nullptr;
+		ShaderProgram* p_pending = nullptr;
+	};
+
+	static std::vector<ShaderProgram*> s_m_programs;
+	static std::vector<Rebuild> s_m_rebuilds;
+	static std::size_t s_m_reloadCount;
+
+	// Shared with the thread
+	static std::mutex s_m_mutex;
+	static std::set<std::filesystem::path> s_m_files;
+	static std::vector<std::filesystem::path> s_m_changed;
+	static std::thread s_m_thread;
+	static std::atomic<bool> s_m_isRunning;
+};
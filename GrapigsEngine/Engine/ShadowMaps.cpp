@@ -0,0 +1,274 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: ShadowMaps.cpp
+ *	Desc		: Cascaded shadow maps of the directional light and a shadow atlas of spot lights
+ */
+#include "ShadowMaps.h"
+
+#include <algorithm>	// std::clamp, std::min
+#include <cmath>		// std::pow, std::tan
+#include <gl/glew.h>	// gl functions
+#include <glm/gtc/matrix_transform.hpp>	// glm::lookAt, glm::ortho, glm::perspective
+
+#include "GLState.h"			// GLState
+#include "ResourceManager.h"	// LightData, LightType, Lights
+#include "UniformRing.h"		// UniformRing
+
+namespace
+{
+	// ShadowInformation of test.frag (std140)
+	struct ShadowBlock
+	{
+		glm::mat4 cascadeWorldToShadow[ShadowMaps::s_maxCascades];
+		glm::mat4 spotWorldToShadow[Lights::s_maxSpotShadows];
+		glm::vec4 cascadeSplits;	// far view depth of each cascade
+		glm::vec4 cascadeTexels;	// world size of a texel of each cascade
+		glm::vec4 spotTexels[Lights::s_maxSpotShadows / 4];	// size of a texel at distance one of each spot light
+		glm::ivec4 params;			// x: cascade count, y: filter radius, z: spot shadows
+		glm::vec4 bias;				// x: normal bias in texels
+	};
+
+	constexpr float s_spotNear = 0.05f;
+
+	// NDC to [0, 1] texture coordinates and depth
+	const glm::mat4 s_ndcToTexture{ 0.5f, 0, 0, 0, 0, 0.5f, 0, 0, 0, 0, 0.5f, 0, 0.5f, 0.5f, 0.5f, 1 };
+
+	glm::vec3 UpVector(const glm::vec3& direction) noexcept
+	{
+		return std::abs(direction.y) > 0.99f ? glm::vec3{ 1, 0, 0 } : glm::vec3{ 0, 1, 0 };
+	}
+
+	unsigned CreateDepthTexture(GLenum target, int size, int layers) noexcept
+	{
+		unsigned texture = 0;
+		glCreateTextures(target, 1, &texture);
+		if (target == GL_TEXTURE_2D_ARRAY)
+			glTextureStorage3D(texture, 1, GL_DEPTH_COMPONENT32F, size, size, layers);
+		else
+			glTextureStorage2D(texture, 1, GL_DEPTH_COMPONENT32F, size, size);
+		// Hardware compare gives 2x2 filtering for free
+		glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(texture, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTextureParameteri(texture, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		return texture;
+	}
+}
+
+ShadowMaps::ShadowMaps() noexcept
+	: m_cascadeUnit(Texture::s_textureCount++), m_atlasUnit(Texture::s_textureCount++)
+{
+	const std::vector<std::pair<ShaderType, std::filesystem::path>> files = {
+		std::make_pair(ShaderType::Vertex, "shader/shadow.vert"),
+		std::make_pair(ShaderType::Fragment, "shader/shadow.frag")
+	};
+	m_program = new ShaderProgram(files);
+	m_program->m_name = "shadow";
+
+	glCreateFramebuffers(1, &m_fbo);
+	glNamedFramebufferDrawBuffer(m_fbo, GL_NONE);
+	glNamedFramebufferReadBuffer(m_fbo, GL_NONE);
+	Resize();
+}
+
+ShadowMaps::~ShadowMaps() noexcept
+{
+	delete m_program;
+	m_program = nullptr;
+	GLState::DeleteFramebuffers(1, &m_fbo);
+	GLState::DeleteTextures(1, &m_cascades);
+	GLState::DeleteTextures(1, &m_atlas);
+	m_fbo = m_cascades = m_atlas = 0;
+}
+
+void ShadowMaps::Resize() noexcept
+{
+	m_settings.resolution = std::clamp(m_settings.resolution, 256, 8192);
+	m_settings.spotResolution = std::clamp(m_settings.spotResolution, 128, 4096);
+	if (m_settings.resolution != m_cascadeResolution)
+	{
+		GLState::DeleteTextures(1, &m_cascades);
+		m_cascadeResolution = m_settings.resolution;
+		m_cascades = CreateDepthTexture(GL_TEXTURE_2D_ARRAY, m_cascadeResolution, s_maxCascades);
+	}
+	if (m_settings.spotResolution * static_cast<int>(s_atlasTiles) != m_atlasResolution)
+	{
+		GLState::DeleteTextures(1, &m_atlas);
+		m_atlasResolution = m_settings.spotResolution * static_cast<int>(s_atlasTiles);
+		m_atlas = CreateDepthTexture(GL_TEXTURE_2D, m_atlasResolution, 1);
+	}
+}
+
+void ShadowMaps::Update(const std::vector<LightData>& lights, const Camera& camera) noexcept
+{
+	Resize();
+	m_views.clear();
+	ShadowBlock block{};
+	block.params = glm::ivec4{ 0, std::clamp(m_settings.filterRadius, 0, 3), 0, 0 };
+	block.bias = glm::vec4{ m_settings.normalBias, 0, 0, 0 };
+
+	const LightData* directional = nullptr;
+	for (const auto& light : lights)
+		if (light.type == static_cast<unsigned>(LightType::DIRECTIONAL) && light.shadow >= 0)
+			directional = &light;
+
+	if (m_settings.isEnabled && directional)
+	{
+		const int count = std::clamp(m_settings.cascadeCount, 1, static_cast<int>(s_maxCascades));
+		const auto [near_plane, camera_far] = camera.Plane();
+		const float far_plane = std::max(std::min(camera_far, m_settings.maxDistance), near_plane * 2.f);
+		const float tan_half = std::tan(glm::radians(camera.FOV()) * 0.5f);
+		const float aspect = CameraBuffer::s_m_aspectRatio;
+		const glm::mat4 camera_to_world = glm::inverse(camera.GetWorldToCameraMatrix());
+		const glm::vec3 direction = glm::normalize(glm::vec3{ directional->direction });
+		const glm::mat4 rotation = glm::lookAt(glm::vec3{ 0 }, direction, UpVector(direction));
+
+		float split_near = near_plane;
+		for (int c = 0; c < count; ++c)
+		{
+			// Blend of uniform and logarithmic splits
+			const float t = static_cast<float>(c + 1) / static_cast<float>(count);
+			const float uniform = near_plane + (far_plane - near_plane) * t;
+			const float logarithmic = near_plane * std::pow(far_plane / near_plane, t);
+			const float split_far = uniform + (logarithmic - uniform) * m_settings.splitLambda;
+
+			// Sphere around the slice of the camera frustum, its size does not change when the camera turns
+			glm::vec3 corners[8];
+			glm::vec3 center{ 0 };
+			for (int i = 0; i < 8; ++i)
+			{
+				const float depth = (i & 4) ? split_far : split_near;
+				const glm::vec4 point{ ((i & 1) ? 1.f : -1.f) * depth * tan_half * aspect, ((i & 2) ? 1.f : -1.f) * depth * tan_half, -depth, 1 };
+				corners[i] = glm::vec3{ camera_to_world * point };
+				center += corners[i] / 8.f;
+			}
+			float radius = 0.f;
+			for (const auto& corner : corners)
+				radius = std::max(radius, glm::length(corner - center));
+			radius = std::ceil(radius * 16.f) / 16.f;
+
+			// Snapping the center to whole texels keeps edges from crawling while the camera moves
+			const float texel = 2.f * radius / static_cast<float>(m_cascadeResolution);
+			glm::vec3 light_center = glm::vec3{ rotation * glm::vec4{ center, 1 } };
+			light_center.x = std::floor(light_center.x / texel) * texel;
+			light_center.y = std::floor(light_center.y / texel) * texel;
+
+			// Casters up to maxDistance in front of the slice still land in the map
+			const float extension = m_settings.maxDistance;
+			View& view = m_views.emplace_back();
+			view.worldToLight = rotation;
+			view.nearPlane = -light_center.z - radius - extension;
+			view.farPlane = -light_center.z + radius;
+			view.lightToNDC = glm::ortho(light_center.x - radius, light_center.x + radius, light_center.y - radius, light_center.y + radius, view.nearPlane, view.farPlane);
+			// Far away so the cluster cone test sees nearly parallel rays
+			view.eye = glm::vec3{ glm::inverse(rotation) * glm::vec4{ light_center.x, light_center.y, -view.nearPlane + 1000.f * radius, 1 } };
+			view.frustum.Extract(view.lightToNDC * view.worldToLight);
+			view.layer = c;
+			view.viewport = glm::ivec4{ 0, 0, m_cascadeResolution, m_cascadeResolution };
+
+			block.cascadeWorldToShadow[c] = s_ndcToTexture * view.lightToNDC * view.worldToLight;
+			block.cascadeSplits[c] = split_far;
+			block.cascadeTexels[c] = texel;
+			split_near = split_far;
+		}
+		block.params.x = count;
+	}
+
+	if (m_settings.isEnabled)
+	{
+		const float tile_scale = 1.f / static_cast<float>(s_atlasTiles);
+		for (const auto& light : lights)
+		{
+			if (light.type != static_cast<unsigned>(LightType::SPOT) || light.shadow < 0)
+				continue;
+
+			const auto slot = static_cast<unsigned>(light.shadow);
+			const glm::vec3 position{ light.position };
+			const glm::vec3 direction = glm::normalize(glm::vec3{ light.direction });
+			const float half_angle = std::clamp(light.outerAngle, 0.01f, glm::radians(85.f));
+
+			View& view = m_views.emplace_back();
+			view.worldToLight = glm::lookAt(position, position + direction, UpVector(direction));
+			view.nearPlane = s_spotNear;
+			view.farPlane = std::max(std::min(light.position.w, m_settings.maxDistance), s_spotNear * 2.f);
+			view.lightToNDC = glm::perspective(2.f * half_angle, 1.f, view.nearPlane, view.farPlane);
+			view.eye = position;
+			view.frustum.Extract(view.lightToNDC * view.worldToLight);
+			view.viewport = glm::ivec4{ static_cast<int>(slot % s_atlasTiles) * m_settings.spotResolution,
+				static_cast<int>(slot / s_atlasTiles) * m_settings.spotResolution, m_settings.spotResolution, m_settings.spotResolution };
+
+			// Texture coordinates of the whole atlas, scaled into the light's tile
+			glm::mat4 tile{ 1 };
+			tile[0][0] = tile[1][1] = tile_scale;
+			tile[3] = glm::vec4{ static_cast<float>(slot % s_atlasTiles) * tile_scale, static_cast<float>(slot / s_atlasTiles) * tile_scale, 0, 1 };
+			block.spotWorldToShadow[slot] = tile * s_ndcToTexture * view.lightToNDC * view.worldToLight;
+			block.spotTexels[slot / 4][static_cast<int>(slot % 4)] = 2.f * std::tan(half_angle) / static_cast<float>(m_settings.spotResolution);
+			block.params.z = 1;
+		}
+	}
+
+	UniformRing::Bind(2, &block, sizeof(block));
+}
+
+std::size_t ShadowMaps::ViewCount() const noexcept
+{
+	return m_views.size();
+}
+
+const Frustum& ShadowMaps::BeginView(std::size_t index) noexcept
+{
+	const View& view = m_views[index];
+	if (index == 0)
+	{
+		glGetIntegerv(GL_VIEWPORT, m_viewport);
+		GLState::BindFramebuffer(m_fbo);
+		GLState::SetCapability(GL_POLYGON_OFFSET_FILL, true);
+		glPolygonOffset(m_settings.slopeBias, m_settings.constantBias);
+	}
+
+	// A cascade owns a whole layer, a spot light clears only its own tile
+	if (view.layer >= 0)
+	{
+		glNamedFramebufferTextureLayer(m_fbo, GL_DEPTH_ATTACHMENT, m_cascades, 0, view.layer);
+		glViewport(view.viewport.x, view.viewport.y, view.viewport.z, view.viewport.w);
+		glClear(GL_DEPTH_BUFFER_BIT);
+	}
+	else
+	{
+		glNamedFramebufferTexture(m_fbo, GL_DEPTH_ATTACHMENT, m_atlas, 0);
+		glViewport(view.viewport.x, view.viewport.y, view.viewport.z, view.viewport.w);
+		GLState::SetCapability(GL_SCISSOR_TEST, true);
+		glScissor(view.viewport.x, view.viewport.y, view.viewport.z, view.viewport.w);
+		glClear(GL_DEPTH_BUFFER_BIT);
+		GLState::SetCapability(GL_SCISSOR_TEST, false);
+	}
+
+	CameraBuffer::Bind(view.worldToLight, view.lightToNDC, view.eye, view.nearPlane, view.farPlane);
+	return view.frustum;
+}
+
+void ShadowMaps::End() const noexcept
+{
+	if (m_views.empty())
+		return;
+	GLState::SetCapability(GL_POLYGON_OFFSET_FILL, false);
+	GLState::BindFramebuffer(0);
+	glViewport(m_viewport[0], m_viewport[1], m_viewport[2], m_viewport[3]);
+	CameraBuffer::Bind();
+}
+
+void ShadowMaps::Bind(const ShaderProgram* program) const noexcept
+{
+	GLState::BindTextureUnit(m_cascadeUnit, m_cascades);
+	GLState::BindTextureUnit(m_atlasUnit, m_atlas);
+	program->SendUniform("t_cascades", static_cast<int>(m_cascadeUnit));
+	program->SendUniform("t_spotShadows", static_cast<int>(m_atlasUnit));
+}
+
+ShaderProgram* ShadowMaps::GetProgram() const noexcept
+{
+	return m_program;
+}
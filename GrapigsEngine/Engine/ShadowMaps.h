@@ -0,0 +1,71 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: ShadowMaps.h
+ *	Desc		: Cascaded shadow maps of the directional light and a shadow atlas of spot lights
+ */
+#pragma once
+#include <vector>	// std::vector
+#include <glm/glm.hpp>	// glm
+
+#include "Camera.h"	// Camera, Frustum
+#include "Shader.h"	// ShaderProgram
+
+struct LightData;
+
+// Quality against frame time, changes apply on the next frame
+struct ShadowSettings
+{
+	bool isEnabled = true;
+	int cascadeCount = 4;			// 1 to ShadowMaps::s_maxCascades
+	int resolution = 2048;			// of each cascade
+	int spotResolution = 1024;		// of each spot light tile in the atlas
+	int filterRadius = 1;			// PCF over (2r+1)^2 hardware compares, 0 is a single compare
+	float splitLambda = 0.75f;		// 0: uniform splits, 1: logarithmic splits
+	float maxDistance = 50.f;		// shadows end here or at the camera's far plane
+	float slopeBias = 2.f;			// polygon offset of the depth pass
+	float constantBias = 2.f;
+	float normalBias = 1.5f;		// receivers move along their normal by this many texels
+};
+
+class ShadowMaps
+{
+public:
+	static constexpr unsigned s_maxCascades = 4;
+	// Tiles per side of the atlas, Lights::s_maxSpotShadows in total
+	static constexpr unsigned s_atlasTiles = 4;
+
+	ShadowMaps() noexcept;
+	~ShadowMaps() noexcept;
+	// Fits the cascades to the camera and the spot views to their cones, then binds ShadowInformation
+	void Update(const std::vector<LightData>& lights, const Camera& camera) noexcept;
+	[[nodiscard]] std::size_t ViewCount() const noexcept;
+	// Binds the depth target and the light's transform block, returns the frustum of casters
+	[[nodiscard]] const Frustum& BeginView(std::size_t index) noexcept;
+	// Restores the viewport and the camera's transform block
+	void End() const noexcept;
+	// Sends the shadow samplers to a shading program
+	void Bind(const ShaderProgram* program) const noexcept;
+	[[nodiscard]] ShaderProgram* GetProgram() const noexcept;
+
+	ShadowSettings m_settings;
+private:
+	void Resize() noexcept;
+
+	struct View
+	{
+		glm::mat4 worldToLight{ 1 }, lightToNDC{ 1 };
+		glm::vec3 eye{ 0 };
+		float nearPlane = 0.f, farPlane = 1.f;
+		Frustum frustum;
+		int layer = -1;	// cascade layer, -1 renders into the atlas
+		glm::ivec4 viewport{ 0 };
+	};
+
+	std::vector<View> m_views;
+	ShaderProgram* m_program = nullptr;
+	const unsigned m_cascadeUnit, m_atlasUnit;
+	unsigned m_fbo = 0, m_cascades = 0, m_atlas = 0;
+	int m_cascadeResolution = 0, m_atlasResolution = 0;
+	int m_viewport[4]{};
+};
@@ -0,0 +1,97 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: UniformRing.cpp
+ *	Desc		: Persistently mapped ring of per-frame uniform blocks
+ */
+#include "UniformRing.h"
+
+#include <cstring>		// std::memcpy
+#include <gl/glew.h>	// gl functions
+#include <iostream>		// std::cout
+
+#include "GLState.h"	// GLState
+
+unsigned UniformRing::s_m_handle = 0;
+unsigned char* UniformRing::s_m_p_data = nullptr;
+std::size_t UniformRing::s_m_alignment = 256;
+std::size_t UniformRing::s_m_frame = 0;
+std::size_t UniformRing::s_m_head = 0;
+void* UniformRing::s_m_fences[UniformRing::s_frameCount]{};
+
+void UniformRing::Init() noexcept
+{
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	if (alignment > 0)
+		s_m_alignment = static_cast<std::size_t>(alignment);
+
+	constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	constexpr auto size = static_cast<GLsizeiptr>(s_frameSize * s_frameCount);
+	glCreateBuffers(1, &s_m_handle);
+	glNamedBufferStorage(s_m_handle, size, nullptr, flags);
+	s_m_p_data = static_cast<unsigned char*>(glMapNamedBufferRange(s_m_handle, 0, size, flags));
+	s_m_frame = s_m_head = 0;
+}
+
+void UniformRing::Clear() noexcept
+{
+	for (auto& fence : s_m_fences)
+	{
+		if (fence)
+			glDeleteSync(static_cast<GLsync>(fence));
+		fence = nullptr;
+	}
+	if (s_m_handle)
+	{
+		glUnmapNamedBuffer(s_m_handle);
+		GLState::DeleteBuffers(1, &s_m_handle);
+	}
+	s_m_handle = 0;
+	s_m_p_data = nullptr;
+}
+
+void UniformRing::Bind(unsigned binding, const void* p_data, std::size_t size) noexcept
+{
+	if (s_m_handle < 1)
+		Init();
+	if (s_m_p_data == nullptr || size > s_frameSize)
+		return;
+
+	std::size_t offset = (s_m_head + s_m_alignment - 1) / s_m_alignment * s_m_alignment;
+	if (offset + size > s_frameSize)
+	{
+		// Blocks of earlier draws in this frame are still pending, let them finish before reusing the region
+		static bool is_reported = false;
+		if (is_reported == false)
+			std::cout << "[UniformRing]: Frame region is full, waiting for the GPU" << std::endl;
+		is_reported = true;
+		glFinish();
+		offset = 0;
+	}
+
+	const std::size_t position = s_m_frame * s_frameSize + offset;
+	std::memcpy(s_m_p_data + position, p_data, size);
+	GLState::BindBufferRange(GL_UNIFORM_BUFFER, binding, s_m_handle, static_cast<GLintptr>(position), static_cast<GLsizeiptr>(size));
+	s_m_head = offset + size;
+}
+
+void UniformRing::EndFrame() noexcept
+{
+	if (s_m_handle < 1)
+		return;
+
+	s_m_fences[s_m_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	s_m_frame = (s_m_frame + 1) % s_frameCount;
+	s_m_head = 0;
+
+	// Usually signalled long ago, the GPU is rarely more than two frames behind
+	if (auto fence = static_cast<GLsync>(s_m_fences[s_m_frame]))
+	{
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		while (glClientWaitSync(fence, flags, 1000000) == GL_TIMEOUT_EXPIRED)
+			flags = 0;
+		glDeleteSync(fence);
+		s_m_fences[s_m_frame] = nullptr;
+	}
+}
@@ -0,0 +1,29 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: UniformRing.h
+ *	Desc		: Persistently mapped ring of per-frame uniform blocks
+ */
+#pragma once
+#include <cstddef>	// std::size_t
+
+// One region per frame in flight, a region is written again only once the GPU signalled its fence
+class UniformRing
+{
+public:
+	static constexpr std::size_t s_frameCount = 3;
+	static constexpr std::size_t s_frameSize = 64 * 1024;
+
+	static void Clear() noexcept;
+	// Copies the block into the current frame's region and binds that range to the uniform binding point
+	static void Bind(unsigned binding, const void* p_data, std::size_t size) noexcept;
+	// Fences the current region and waits until the next one is free
+	static void EndFrame() noexcept;
+private:
+	static void Init() noexcept;
+
+	static unsigned s_m_handle;
+	static unsigned char* s_m_p_data;
+	static std::size_t s_m_alignment, s_m_frame, s_m_head;
+	static void* s_m_fences[s_frameCount];
+};
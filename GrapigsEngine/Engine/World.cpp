@@ -0,0 +1,460 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: World.cpp
+ *	Desc		: Scene container of objects
+ */
+#include "World.h"
+
+#include <algorithm>	// std::sort, std::find
+#include <gl/glew.h>	// gl functions for instance buffer
+
+#include "Camera.h"	// Frustum
+#include "GLState.h"	// GLState
+
+/* InstanceBuffer - start -----------------------------------------------------------------------*/
+
+namespace
+{
+	// Grow the storage geometrically, otherwise orphan the previous contents
+	void Reserve(unsigned handle, std::size_t& capacity, std::size_t count, std::size_t stride) noexcept
+	{
+		count = std::max<std::size_t>(count, 1);
+		if (count > capacity)
+			capacity = std::max(count, capacity * 2);
+		glNamedBufferData(handle, static_cast<GLsizeiptr>(stride * capacity), nullptr, GL_STREAM_DRAW);
+	}
+
+	template <typename T>
+	void Upload(unsigned handle, std::size_t& capacity, const std::vector<T>& data) noexcept
+	{
+		Reserve(handle, capacity, data.size(), sizeof(T));
+		if (data.empty() == false)
+			glNamedBufferSubData(handle, 0, static_cast<GLsizeiptr>(sizeof(T) * data.size()), data.data());
+	}
+}
+
+InstanceBuffer::InstanceBuffer() noexcept
+{
+	glCreateBuffers(1, &m_handle);
+	glCreateBuffers(1, &m_visibleHandle);
+	glCreateBuffers(1, &m_meshDrawHandle);
+}
+
+InstanceBuffer::~InstanceBuffer() noexcept
+{
+	GLState::DeleteBuffers(1, &m_handle);
+	GLState::DeleteBuffers(1, &m_visibleHandle);
+	GLState::DeleteBuffers(1, &m_meshDrawHandle);
+	m_handle = m_visibleHandle = m_meshDrawHandle = 0;
+}
+
+void InstanceBuffer::Upload(const RenderList& render_list, const std::vector<MeshDraw>& mesh_draws) noexcept
+{
+	m_data.resize(render_list.size());
+	for (std::size_t i = 0; i < render_list.size(); ++i)
+		m_data[i] = InstanceData{ render_list[i].modelToWorld, render_list[i].color };
+
+	::Upload(m_handle, m_capacity, m_data);
+	::Upload(m_meshDrawHandle, m_meshDrawCapacity, mesh_draws);
+	Bind();
+}
+
+void InstanceBuffer::UploadVisible(const std::vector<glm::uvec2>& visible) noexcept
+{
+	// Entries that survived culling, indexed by gl_BaseInstance + gl_InstanceID
+	::Upload(m_visibleHandle, m_visibleCapacity, visible);
+}
+
+void InstanceBuffer::ReserveVisible(std::size_t count) noexcept
+{
+	Reserve(m_visibleHandle, m_visibleCapacity, count, sizeof(glm::uvec2));
+}
+
+void InstanceBuffer::Bind() const noexcept
+{
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_handle);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_visibleHandle);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_meshDrawHandle);
+}
+
+/* InstanceBuffer - end -------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------------------*/
+/* World - start --------------------------------------------------------------------------------*/
+
+World::World(std::size_t capacity) noexcept
+{
+	m_objects.reserve(capacity);
+	m_denseToSlot.reserve(capacity);
+	m_slots.reserve(capacity);
+	m_renderList.reserve(capacity);
+}
+
+ObjectHandle World::Create() noexcept
+{
+	return Create(Object{});
+}
+
+ObjectHandle World::Create(const Object& prototype) noexcept
+{
+	unsigned slot;
+	if (m_freeSlots.empty())
+	{
+		slot = static_cast<unsigned>(m_slots.size());
+		m_slots.emplace_back();
+	}
+	else
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+
+	m_slots[slot].dense = static_cast<unsigned>(m_objects.size());
+	m_objects.push_back(prototype);
+	m_objects.back().m_tag = slot;
+	m_denseToSlot.push_back(slot);
+	return ObjectHandle{ slot, m_slots[slot].generation };
+}
+
+void World::Destroy(ObjectHandle handle) noexcept
+{
+	if (IsValid(handle) == false)
+		return;
+
+	// Move the last object into the hole to keep the storage packed
+	Slot& slot = m_slots[handle.index];
+	const unsigned last = static_cast<unsigned>(m_objects.size()) - 1;
+	if (slot.dense != last)
+	{
+		m_objects[slot.dense] = std::move(m_objects[last]);
+		m_denseToSlot[slot.dense] = m_denseToSlot[last];
+		m_slots[m_denseToSlot[last]].dense = slot.dense;
+	}
+	m_objects.pop_back();
+	m_denseToSlot.pop_back();
+
+	slot.dense = ObjectHandle::s_invalid;
+	slot.generation++;
+	m_freeSlots.push_back(handle.index);
+}
+
+void World::Clear() noexcept
+{
+	for (std::size_t i = 0; i < m_slots.size(); ++i)
+	{
+		if (m_slots[i].dense != ObjectHandle::s_invalid)
+		{
+			m_slots[i].dense = ObjectHandle::s_invalid;
+			m_slots[i].generation++;
+			m_freeSlots.push_back(static_cast<unsigned>(i));
+		}
+	}
+	m_objects.clear();
+	m_denseToSlot.clear();
+	m_renderList.clear();
+	m_batches.clear();
+	m_meshDraws.clear();
+	m_groups.clear();
+	m_visible.clear();
+	m_ranges.clear();
+}
+
+bool World::IsValid(ObjectHandle handle) const noexcept
+{
+	return handle.index < m_slots.size()
+		&& m_slots[handle.index].generation == handle.generation
+		&& m_slots[handle.index].dense != ObjectHandle::s_invalid;
+}
+
+Object* World::Get(ObjectHandle handle) noexcept
+{
+	if (IsValid(handle) == false)
+		return nullptr;
+	return &m_objects[m_slots[handle.index].dense];
+}
+
+ObjectHandle World::GetHandle(std::size_t dense_index) const noexcept
+{
+	if (dense_index >= m_denseToSlot.size())
+		return ObjectHandle{};
+	const unsigned slot = m_denseToSlot[dense_index];
+	return ObjectHandle{ slot, m_slots[slot].generation };
+}
+
+std::size_t World::Size() const noexcept
+{
+	return m_objects.size();
+}
+
+std::vector<Object>& World::Objects() noexcept
+{
+	return m_objects;
+}
+
+const RenderList& World::BuildRenderList() noexcept
+{
+	m_renderList.clear();
+	for (const auto& object : m_objects)
+	{
+		if (object.m_p_model == nullptr || object.m_p_shader == nullptr)
+			continue;
+		m_renderList.push_back(RenderItem{ &object, object.m_p_model, object.m_p_shader,
+			object.m_transform.GetTransformMatrix(), object.m_color });
+	}
+
+	// Keep objects sharing a program and a model next to each other
+	std::sort(m_renderList.begin(), m_renderList.end(), [](const RenderItem& a, const RenderItem& b)
+		{
+			if (a.p_shader != b.p_shader)
+				return a.p_shader->m_tag < b.p_shader->m_tag;
+			return a.p_model->m_tag < b.p_model->m_tag;
+		});
+
+	// Split the sorted list into runs sharing a program and a model
+	m_batches.clear();
+	for (std::size_t i = 0; i < m_renderList.size(); ++i)
+	{
+		const RenderItem& item = m_renderList[i];
+		if (m_batches.empty() || m_batches.back().p_model != item.p_model || m_batches.back().p_shader != item.p_shader)
+			m_batches.push_back(RenderBatch{ item.p_model, item.p_shader, static_cast<unsigned>(i), 0 });
+		m_batches.back().instanceCount++;
+	}
+
+	// Meshlets only change with the set of models, upload them again only then
+	m_models.clear();
+	for (const auto& batch : m_batches)
+		if (std::find(m_models.begin(), m_models.end(), batch.p_model) == m_models.end())
+			m_models.push_back(batch.p_model);
+	if (m_models != m_meshletModels)
+	{
+		m_meshletModels = m_models;
+		m_meshlets.clear();
+		m_meshletModelFirst.clear();
+		for (const Model* model : m_meshletModels)
+		{
+			m_meshletModelFirst.push_back(static_cast<unsigned>(m_meshlets.size()));
+			for (const auto& mesh : model->m_meshes)
+				m_meshlets.insert(m_meshlets.end(), mesh.meshlets.begin(), mesh.meshlets.end());
+		}
+		++m_meshletVersion;
+	}
+
+	// Per-mesh data is rebuilt every frame so material edits show up immediately
+	m_meshDraws.clear();
+	m_groups.clear();
+	for (auto& batch : m_batches)
+	{
+		batch.firstMeshDraw = static_cast<unsigned>(m_meshDraws.size());
+		batch.firstGroup = static_cast<unsigned>(m_groups.size());
+		const auto model_it = std::find(m_meshletModels.begin(), m_meshletModels.end(), batch.p_model);
+		unsigned first_meshlet = m_meshletModelFirst[static_cast<std::size_t>(model_it - m_meshletModels.begin())];
+		for (const auto& mesh : batch.p_model->m_meshes)
+		{
+			MeshDraw& draw = m_meshDraws.emplace_back();
+			draw.meshlets = glm::uvec4{ first_meshlet, static_cast<unsigned>(mesh.meshlets.size()), 0, 0 };
+			first_meshlet += static_cast<unsigned>(mesh.meshlets.size());
+			draw.localToModel = mesh.transform;
+			draw.albedo = glm::vec4{ mesh.material.albedo, mesh.material.metallic };
+			draw.sphere = mesh.bounds.GetSphere(mesh.transform);
+			draw.roughness = mesh.material.roughness;
+			if (mesh.lods.empty())
+				continue;
+
+			const glm::mat4& t = mesh.transform;
+			const float scale = std::sqrt(std::max(glm::dot(glm::vec3{ t[0] }, glm::vec3{ t[0] }),
+				std::max(glm::dot(glm::vec3{ t[1] }, glm::vec3{ t[1] }), glm::dot(glm::vec3{ t[2] }, glm::vec3{ t[2] }))));
+			draw.lodCount = static_cast<unsigned>(mesh.lods.size());
+			for (unsigned lod = 0; lod < draw.lodCount; ++lod)
+				draw.lodErrors[static_cast<int>(lod)] = mesh.lods[lod].error * scale;
+
+			unsigned group = batch.firstGroup;
+			while (group < m_groups.size() && m_groups[group].p_material->HasSameTextures(mesh.material) == false)
+				++group;
+			if (group == m_groups.size())
+				m_groups.push_back(DrawGroup{ &mesh.material, 0, 0 });
+			draw.group = group;
+			m_groups[group].commandCount += draw.lodCount;
+			// Worst case of every instance keeping every meshlet
+			if (m_isGPUCulling && m_isClusterCulling)
+				m_groups[group].clusterCapacity += batch.instanceCount * draw.meshlets.y;
+		}
+		batch.groupCount = static_cast<unsigned>(m_groups.size()) - batch.firstGroup;
+	}
+
+	// Each group owns a region of the compacted command buffer large enough for all of its meshes
+	// Cluster regions share a fixed budget, the cluster pass draws meshes whole once their region is full
+	unsigned first_command = 0;
+	m_clusterCount = 0;
+	for (auto& group : m_groups)
+	{
+		group.firstCommand = first_command;
+		first_command += group.commandCount;
+		group.clusterFirst = m_clusterCount;
+		group.clusterCapacity = std::min(group.clusterCapacity, s_maxClusters - m_clusterCount);
+		m_clusterCount += group.clusterCapacity;
+	}
+	for (auto& draw : m_meshDraws)
+	{
+		if (draw.group == ObjectHandle::s_invalid)
+			continue;
+		draw.groupFirst = m_groups[draw.group].firstCommand;
+		draw.meshlets.z = m_groups[draw.group].clusterFirst;
+		draw.meshlets.w = m_groups[draw.group].clusterCapacity;
+	}
+	return m_renderList;
+}
+
+const RenderList& World::GetRenderList() const noexcept
+{
+	return m_renderList;
+}
+
+const std::vector<RenderBatch>& World::GetBatches() const noexcept
+{
+	return m_batches;
+}
+
+const std::vector<MeshDraw>& World::GetMeshDraws() const noexcept
+{
+	return m_meshDraws;
+}
+
+const std::vector<DrawGroup>& World::GetDrawGroups() const noexcept
+{
+	return m_groups;
+}
+
+const std::vector<Meshlet>& World::GetMeshlets() const noexcept
+{
+	return m_meshlets;
+}
+
+unsigned World::GetMeshletVersion() const noexcept
+{
+	return m_meshletVersion;
+}
+
+unsigned World::GetClusterCount() const noexcept
+{
+	return m_clusterCount;
+}
+
+void World::Cull(const Frustum& frustum, const LodSelection& lod_selection) noexcept
+{
+	m_visible.clear();
+	m_ranges.clear();
+	m_stats = CullingStats{};
+
+	for (auto& batch : m_batches)
+	{
+		const Model* model = batch.p_model;
+		const std::size_t mesh_count = model->m_meshes.size();
+		batch.firstRange = static_cast<unsigned>(m_ranges.size());
+		m_ranges.resize(m_ranges.size() + mesh_count * Mesh::s_maxLods);
+		InstanceRange* ranges = &m_ranges[batch.firstRange];
+
+		// Whole model first, meshes of rejected objects are never tested
+		m_candidates.clear();
+		if (m_isCulling)
+		{
+			m_spheres.resize(batch.instanceCount);
+			m_objectVisible.resize(batch.instanceCount);
+			for (unsigned i = 0; i < batch.instanceCount; ++i)
+				m_spheres[i] = model->m_bounds.GetSphere(m_renderList[batch.firstInstance + i].modelToWorld);
+			frustum.CullSpheres(m_spheres.data(), batch.instanceCount, m_objectVisible.data());
+			for (unsigned i = 0; i < batch.instanceCount; ++i)
+				if (m_objectVisible[i])
+					m_candidates.push_back(batch.firstInstance + i);
+		}
+		else
+		{
+			for (unsigned i = 0; i < batch.instanceCount; ++i)
+				m_candidates.push_back(batch.firstInstance + i);
+		}
+		m_stats.objectsTested += batch.instanceCount;
+		m_stats.objectsVisible += m_candidates.size();
+
+		for (std::size_t m = 0; m < mesh_count; ++m)
+		{
+			const Mesh& mesh = model->m_meshes[m];
+			const unsigned mesh_draw = batch.firstMeshDraw + static_cast<unsigned>(m);
+			InstanceRange* mesh_ranges = ranges + m * Mesh::s_maxLods;
+			if (mesh.lods.empty() || m_candidates.empty())
+				continue;
+
+			// The model space sphere of a mesh is shared by every instance
+			const glm::vec4& local = m_meshDraws[mesh_draw].sphere;
+			const std::size_t count = m_candidates.size();
+			m_spheres.resize(count);
+			m_scales.resize(count);
+			m_meshVisible.resize(count);
+			m_lods.resize(count);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const glm::mat4& to_world = m_renderList[m_candidates[i]].modelToWorld;
+				m_scales[i] = std::sqrt(std::max(glm::dot(glm::vec3{ to_world[0] }, glm::vec3{ to_world[0] }),
+					std::max(glm::dot(glm::vec3{ to_world[1] }, glm::vec3{ to_world[1] }), glm::dot(glm::vec3{ to_world[2] }, glm::vec3{ to_world[2] }))));
+				m_spheres[i] = glm::vec4{ glm::vec3{ to_world * glm::vec4{ glm::vec3{ local }, 1 } }, local.w * m_scales[i] };
+			}
+			m_stats.meshesTested += count;
+			if (m_isCulling)
+				frustum.CullSpheres(m_spheres.data(), count, m_meshVisible.data());
+			else
+				std::fill(m_meshVisible.begin(), m_meshVisible.end(), static_cast<unsigned char>(1));
+			for (std::size_t i = 0; i < count; ++i)
+				m_lods[i] = static_cast<unsigned char>(SelectLod(m_meshDraws[mesh_draw], m_spheres[i], m_scales[i], lod_selection));
+
+			// Visible instances grouped by LOD, one draw per LOD
+			for (std::size_t lod = 0; lod < mesh.lods.size(); ++lod)
+			{
+				InstanceRange& range = mesh_ranges[lod];
+				range.first = static_cast<unsigned>(m_visible.size());
+				for (std::size_t i = 0; i < count; ++i)
+					if (m_meshVisible[i] && m_lods[i] == lod)
+						m_visible.emplace_back(m_candidates[i], mesh_draw);
+				range.count = static_cast<unsigned>(m_visible.size()) - range.first;
+
+				m_stats.meshesVisible += range.count;
+				m_stats.lodMeshes[lod] += range.count;
+				m_stats.triangles += static_cast<std::size_t>(range.count) * (mesh.lods[lod].indexCount / 3);
+				if (range.count > 0)
+					m_stats.drawCalls++;
+			}
+		}
+	}
+}
+
+unsigned World::SelectLod(const MeshDraw& mesh_draw, const glm::vec4& sphere, float scale, const LodSelection& lod_selection) const noexcept
+{
+	if (m_isLod == false || lod_selection.pixelsPerUnit <= 0.f)
+		return 0;
+	const float distance = glm::length(glm::vec3{ sphere } - lod_selection.eye) - sphere.w;
+	if (distance <= 0.f)
+		return 0;
+
+	// Coarsest LOD whose error stays under the threshold on screen
+	const float to_pixels = lod_selection.pixelsPerUnit * scale / distance;
+	unsigned lod = 0;
+	while (lod + 1 < mesh_draw.lodCount && mesh_draw.lodErrors[static_cast<int>(lod) + 1] * to_pixels <= m_lodThreshold)
+		++lod;
+	return lod;
+}
+
+const std::vector<glm::uvec2>& World::GetVisibleInstances() const noexcept
+{
+	return m_visible;
+}
+
+const InstanceRange* World::GetInstanceRanges(const RenderBatch& batch) const noexcept
+{
+	if (batch.firstRange >= m_ranges.size())
+		return nullptr;
+	return &m_ranges[batch.firstRange];
+}
+
+const CullingStats& World::GetCullingStats() const noexcept
+{
+	return m_stats;
+}
+
+/* World - end ----------------------------------------------------------------------------------*/
@@ -0,0 +1,181 @@
+/*
+ *	Author		: Jina Hyun
+ *	Date		: 10/19/26
+ *	File Name	: World.h
+ *	Desc		: Scene container of objects
+ */
+#pragma once
+#include <vector>	// std::vector
+#include <glm/glm.hpp>	// glm
+
+#include "ResourceManager.h"	// Object, ObjectHandle
+
+struct Frustum;
+
+struct RenderItem
+{
+	const Object* p_object = nullptr;
+	Model* p_model = nullptr;
+	ShaderProgram* p_shader = nullptr;
+	glm::mat4 modelToWorld{ 1 };
+	glm::vec4 color{ 1 };
+};
+
+using RenderList = std::vector<RenderItem>;
+
+// Objects sharing a program and a model, drawn with one instanced draw per mesh
+struct RenderBatch
+{
+	Model* p_model = nullptr;
+	ShaderProgram* p_shader = nullptr;
+	unsigned firstInstance = 0;
+	unsigned instanceCount = 0;
+	// Offset of this batch's per-mesh instance ranges, filled by World::Cull
+	unsigned firstRange = 0;
+	// One mesh draw per mesh of the model
+	unsigned firstMeshDraw = 0;
+	// Meshes sharing textures are drawn by one multi-draw on the GPU path
+	unsigned firstGroup = 0;
+	unsigned groupCount = 0;
+};
+
+// Per-mesh data of a batch, matches MeshDraw in test.vert and cull.comp (std430)
+struct MeshDraw
+{
+	glm::mat4 localToModel{ 1 };
+	glm::vec4 albedo{ 1 };	// w: metallic
+	glm::vec4 sphere{ 0 };	// bounding sphere in model space
+	float roughness = 0.f;
+	unsigned group = ObjectHandle::s_invalid;
+	unsigned groupFirst = 0;	// first command of the group in the compacted command buffer
+	unsigned lodCount = 0;
+	glm::vec4 lodErrors{ 0 };	// error of each LOD in model space
+	// x: first meshlet, y: meshlet count, z: first cluster slot of the group, w: cluster slots of the group
+	glm::uvec4 meshlets{ 0 };
+};
+
+// Mesh draws of a batch sharing a texture set
+struct DrawGroup
+{
+	const Material* p_material = nullptr;
+	unsigned firstCommand = 0;
+	unsigned commandCount = 0;
+	// Region of per-meshlet commands written by the cluster pass
+	unsigned clusterFirst = 0;
+	unsigned clusterCapacity = 0;
+};
+
+struct CullingStats
+{
+	std::size_t objectsTested = 0, objectsVisible = 0;
+	std::size_t meshesTested = 0, meshesVisible = 0;
+	std::size_t drawCalls = 0;
+	std::size_t triangles = 0;
+	std::size_t lodMeshes[Mesh::s_maxLods]{};
+};
+
+// Camera values used to project LOD errors to pixels
+struct LodSelection
+{
+	glm::vec3 eye{ 0 };
+	float pixelsPerUnit = 0.f;	// pixels covered by one unit at distance one, 0 keeps the finest LOD
+};
+
+// Per-instance data read by the vertex shader, matches Instance in test.vert (std430)
+struct InstanceData
+{
+	glm::mat4 modelToWorld{ 1 };
+	glm::vec4 color{ 1 };
+};
+
+class InstanceBuffer
+{
+public:
+	InstanceBuffer() noexcept;
+	~InstanceBuffer() noexcept;
+	void Upload(const RenderList& render_list, const std::vector<MeshDraw>& mesh_draws) noexcept;
+	void UploadVisible(const std::vector<glm::uvec2>& visible) noexcept;
+	// Storage for visible entries written on the GPU
+	void ReserveVisible(std::size_t count) noexcept;
+	void Bind() const noexcept;
+private:
+	unsigned m_handle = 0, m_visibleHandle = 0, m_meshDrawHandle = 0;
+	std::size_t m_capacity = 0, m_visibleCapacity = 0, m_meshDrawCapacity = 0;
+	std::vector<InstanceData> m_data;
+};
+
+class World
+{
+public:
+	// Most per-meshlet commands written in one frame, meshes past it are drawn whole
+	static constexpr unsigned s_maxClusters = 1u << 18;
+
+	World(std::size_t capacity = 1024) noexcept;
+
+	ObjectHandle Create() noexcept;
+	ObjectHandle Create(const Object& prototype) noexcept;
+	void Destroy(ObjectHandle handle) noexcept;
+	void Clear() noexcept;
+
+	[[nodiscard]] bool IsValid(ObjectHandle handle) const noexcept;
+	[[nodiscard]] Object* Get(ObjectHandle handle) noexcept;
+	[[nodiscard]] ObjectHandle GetHandle(std::size_t dense_index) const noexcept;
+	[[nodiscard]] std::size_t Size() const noexcept;
+	[[nodiscard]] std::vector<Object>& Objects() noexcept;
+
+	const RenderList& BuildRenderList() noexcept;
+	[[nodiscard]] const RenderList& GetRenderList() const noexcept;
+	[[nodiscard]] const std::vector<RenderBatch>& GetBatches() const noexcept;
+	[[nodiscard]] const std::vector<MeshDraw>& GetMeshDraws() const noexcept;
+	[[nodiscard]] const std::vector<DrawGroup>& GetDrawGroups() const noexcept;
+	// Meshlets of every model in the render list, the version changes when they are rebuilt
+	[[nodiscard]] const std::vector<Meshlet>& GetMeshlets() const noexcept;
+	[[nodiscard]] unsigned GetMeshletVersion() const noexcept;
+	[[nodiscard]] unsigned GetClusterCount() const noexcept;
+
+	// Tests every mesh of every render item against the frustum and picks its LOD
+	void Cull(const Frustum& frustum, const LodSelection& lod_selection) noexcept;
+	[[nodiscard]] const std::vector<glm::uvec2>& GetVisibleInstances() const noexcept;
+	[[nodiscard]] const InstanceRange* GetInstanceRanges(const RenderBatch& batch) const noexcept;
+	[[nodiscard]] const CullingStats& GetCullingStats() const noexcept;
+
+	bool m_isCulling = true;
+	bool m_isGPUCulling = false;
+	bool m_isOcclusionCulling = false;
+	bool m_isClusterCulling = true;
+	bool m_isLod = true;
+	float m_lodThreshold = 1.f;	// largest error on screen in pixels
+private:
+	[[nodiscard]] unsigned SelectLod(const MeshDraw& mesh_draw, const glm::vec4& sphere, float scale, const LodSelection& lod_selection) const noexcept;
+
+	struct Slot
+	{
+		unsigned dense = ObjectHandle::s_invalid;
+		unsigned generation = 0;
+	};
+
+	// Objects are packed in m_objects, slots map a handle to the packed position
+	std::vector<Object> m_objects;
+	std::vector<unsigned> m_denseToSlot;
+	std::vector<Slot> m_slots;
+	std::vector<unsigned> m_freeSlots;
+	RenderList m_renderList;
+	std::vector<RenderBatch> m_batches;
+	std::vector<MeshDraw> m_meshDraws;
+	std::vector<DrawGroup> m_groups;
+	std::vector<const Model*> m_models, m_meshletModels;
+	std::vector<unsigned> m_meshletModelFirst;
+	std::vector<Meshlet> m_meshlets;
+	unsigned m_meshletVersion = 0;
+	unsigned m_clusterCount = 0;
+
+	// (render list index, mesh draw) of visible instances, grouped per (batch, mesh)
+	std::vector<glm::uvec2> m_visible;
+	std::vector<InstanceRange> m_ranges;
+	std::vector<glm::vec4> m_spheres;
+	std::vector<float> m_scales;
+	std::vector<unsigned char> m_lods;
+	std::vector<unsigned> m_candidates;
+	std::vector<unsigned char> m_objectVisible, m_meshVisible;
+	CullingStats m_stats;
+};